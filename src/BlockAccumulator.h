@@ -0,0 +1,155 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <utility>
+
+/**
+ * Re-blocks host audio into fixed-size blocks for hosts running tiny buffers.
+ *
+ * Host samples are collected until a full block is available, which is then
+ * processed in one go; the processed block is played back while the next one
+ * fills up. This adds exactly getBlockSize() samples of latency but runs the
+ * processor once per fixed block instead of once per host block.
+ *
+ * MIDI input is rescheduled to its position within the fixed block, and MIDI
+ * output is played back at the matching position in later host blocks.
+ *
+ * All storage is allocated in prepare(); process() doesn't allocate as long as
+ * the MIDI buffers stay within the capacity given there.
+ */
+template <typename FloatType>
+class BlockAccumulator
+{
+public:
+    BlockAccumulator() = default;
+
+    /** Allocate for the largest block size that will be used (message thread, audio stopped). */
+    void prepare(int numChannels, int maxBlockSize, int midiCapacityBytes)
+    {
+        input.setSize(numChannels, maxBlockSize);
+        output.setSize(numChannels, maxBlockSize);
+        midiInput.ensureSize(static_cast<size_t>(midiCapacityBytes));
+        midiOutput.ensureSize(static_cast<size_t>(midiCapacityBytes));
+        hostMidi.ensureSize(static_cast<size_t>(midiCapacityBytes));
+        maxSize = maxBlockSize;
+        setBlockSize(0);
+    }
+
+    /**
+     * Change the fixed block size; 0 passes host blocks straight through.
+     * Pending audio and MIDI are dropped. Audio thread.
+     */
+    void setBlockSize(int newBlockSize) noexcept
+    {
+        blockSize = juce::jlimit(0, maxSize, newBlockSize);
+        position = 0;
+
+        // Shrinking within the prepared size keeps the allocation
+        input.setSize(input.getNumChannels(), blockSize, false, false, true);
+        output.setSize(output.getNumChannels(), blockSize, false, false, true);
+        input.clear();
+        output.clear();
+        midiInput.clear();
+        midiOutput.clear();
+    }
+
+    /** Drop pending audio and MIDI, keeping the block size, e.g. after the audio stopped flowing. Audio thread. */
+    void reset() noexcept
+    {
+        setBlockSize(blockSize);
+    }
+
+    int getBlockSize() const noexcept
+    {
+        return blockSize;
+    }
+
+    /**
+     * Feed one host block through the accumulator. processFixedBlock(AudioBuffer<FloatType>&, MidiBuffer&)
+     * is called for every completed block and processes it in place, replacing the MIDI with its output.
+     * With a block size of 0 the host block is passed straight to processFixedBlock.
+     */
+    template <typename ProcessFn>
+    void process(juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages, ProcessFn&& processFixedBlock)
+    {
+        if (blockSize == 0)
+        {
+            processFixedBlock(buffer, midiMessages);
+            return;
+        }
+
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = juce::jmin(buffer.getNumChannels(), input.getNumChannels());
+
+        // Host MIDI is read from a copy, since the host buffer receives the output
+        hostMidi.swapWith(midiMessages);
+        midiMessages.clear();
+
+        int hostPosition = 0;
+        while (hostPosition < numSamples)
+        {
+            const int length = juce::jmin(numSamples - hostPosition, blockSize - position);
+
+            // Input first: the host buffer is processed in place
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                input.copyFrom(channel, position, buffer, channel, hostPosition, length);
+                buffer.copyFrom(channel, hostPosition, output, channel, position, length);
+            }
+
+            for (int channel = numChannels; channel < buffer.getNumChannels(); ++channel)
+                buffer.clear(channel, hostPosition, length);
+
+            // Host input is rescheduled into the block being collected
+            for (auto it = hostMidi.findNextSamplePosition(hostPosition); it != hostMidi.cend(); ++it)
+            {
+                const auto metadata = *it;
+                if (metadata.samplePosition >= hostPosition + length)
+                    break;
+
+                const int blockOffset = position + metadata.samplePosition - hostPosition;
+                midiInput.addEvent(metadata.data, metadata.numBytes, blockOffset);
+            }
+
+            // MIDI output of the previous block, at the matching position in this host block
+            for (auto it = midiOutput.findNextSamplePosition(position); it != midiOutput.cend(); ++it)
+            {
+                const auto metadata = *it;
+                if (metadata.samplePosition >= position + length)
+                    break;
+
+                const int hostOffset = hostPosition + metadata.samplePosition - position;
+                midiMessages.addEvent(metadata.data, metadata.numBytes, hostOffset);
+            }
+
+            position += length;
+            hostPosition += length;
+
+            if (position == blockSize)
+            {
+                processFixedBlock(input, midiInput);
+
+                // The processed block is played back while the next one is collected
+                std::swap(input, output);
+                midiOutput.swapWith(midiInput);
+                midiInput.clear();
+                position = 0;
+            }
+        }
+
+        hostMidi.clear();
+    }
+
+private:
+    juce::AudioBuffer<FloatType> input;  // Block being collected
+    juce::AudioBuffer<FloatType> output; // Processed block being played back
+    juce::MidiBuffer midiInput;
+    juce::MidiBuffer midiOutput;
+    juce::MidiBuffer hostMidi;
+    int blockSize = 0;
+    int maxSize = 0;
+    int position = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BlockAccumulator)
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "DeferredReclaimer.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+#include <memory>
+
+/**
+ * Delays bypassed audio by the reported latency, so bypassing keeps the timing.
+ *
+ * All channels share one ring buffer and write position, and every block is
+ * copied in and out as at most two contiguous runs per channel. The ring is
+ * sized to the latency actually reported plus one block, not to a worst case,
+ * and only grows when the latency outgrows it: the message thread allocates the
+ * larger ring in reserve() and the audio thread swaps it in at its next block,
+ * carrying the recent input over.
+ *
+ * Input is pushed on every block, bypassed or not, so the delayed signal is
+ * already in place when bypass is switched on.
+ */
+template <typename FloatType>
+class BypassDelay
+{
+public:
+    explicit BypassDelay(DeferredReclaimer& reclaimerToUse)
+        : reclaimer(reclaimerToUse)
+    {
+    }
+
+    ~BypassDelay()
+    {
+        delete pending.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+    /** Allocate for this latency and block size (message thread, audio stopped). Drops any delayed input. */
+    void prepare(int numChannels, int maxBlockSize, int latencySamples)
+    {
+        delete pending.exchange(nullptr, std::memory_order_acq_rel);
+
+        channels = numChannels;
+        blockSize = maxBlockSize;
+        delayed.setSize(numChannels, maxBlockSize);
+        ring.reset(numChannels > 0 ? createRing(latencySamples) : nullptr);
+        reservedCapacity = ring ? ring->samples.getNumSamples() : 0;
+    }
+
+    /** Message thread: make room for latencySamples. The audio thread picks up a larger ring at its next block. */
+    void reserve(int latencySamples)
+    {
+        if (channels == 0 || getCapacityFor(latencySamples) <= reservedCapacity)
+            return;
+
+        auto* grown = createRing(latencySamples);
+        reservedCapacity = grown->samples.getNumSamples();
+
+        // A ring the audio thread never picked up is still ours to free
+        reclaimer.retire(pending.exchange(grown, std::memory_order_acq_rel));
+    }
+
+    /** Audio thread: feed a host block. */
+    void push(const juce::AudioBuffer<FloatType>& input) noexcept
+    {
+        adoptPendingRing();
+
+        if (!ring)
+            return;
+
+        const int numSamples = juce::jmin(input.getNumSamples(), ring->samples.getNumSamples());
+        const int numChannels = juce::jmin(input.getNumChannels(), channels);
+        const int mask = ring->samples.getNumSamples() - 1;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            copyIntoRing(channel, ring->writePosition, input.getReadPointer(channel), numSamples);
+
+        ring->writePosition = (ring->writePosition + numSamples) & mask;
+    }
+
+    /** Audio thread: replace the block just pushed with the input from latencySamples earlier. */
+    void read(juce::AudioBuffer<FloatType>& buffer, int latencySamples) noexcept
+    {
+        readInto(buffer, buffer.getNumSamples(), latencySamples);
+    }
+
+    /** Audio thread: the last numSamples pushed, delayed by latencySamples, in a buffer owned by this object. */
+    const juce::AudioBuffer<FloatType>& readDelayed(int numSamples, int latencySamples) noexcept
+    {
+        jassert(numSamples <= blockSize);
+        delayed.setSize(channels, juce::jmin(numSamples, blockSize), false, false, true);
+        readInto(delayed, delayed.getNumSamples(), latencySamples);
+        return delayed;
+    }
+
+private:
+    struct Ring
+    {
+        juce::AudioBuffer<FloatType> samples; // Power-of-two length, so positions wrap with a mask
+        int writePosition = 0;
+    };
+
+    int getCapacityFor(int latencySamples) const noexcept
+    {
+        return juce::nextPowerOfTwo(juce::jmax(1, latencySamples + blockSize));
+    }
+
+    Ring* createRing(int latencySamples) const
+    {
+        auto* newRing = new Ring();
+        newRing->samples.setSize(channels, getCapacityFor(latencySamples));
+        newRing->samples.clear();
+        return newRing;
+    }
+
+    void adoptPendingRing() noexcept
+    {
+        if (pending.load(std::memory_order_relaxed) == nullptr)
+            return;
+
+        // The outgoing ring goes back first; if the retire queue is full, try again next block
+        if (ring
+            && !reclaimer.retireFromAudioThread(ring.get(), [](void* retired) { delete static_cast<Ring*>(retired); }))
+            return;
+
+        auto* outgoing = ring.release();
+        ring.reset(pending.exchange(nullptr, std::memory_order_acq_rel));
+
+        // Carry the recent input over, ending at the new ring's write position
+        if (outgoing)
+        {
+            const int outgoingSize = outgoing->samples.getNumSamples();
+            const int history = juce::jmin(outgoingSize, ring->samples.getNumSamples());
+            const int historyStart = (outgoing->writePosition - history) & (outgoingSize - 1);
+            const int firstRun = juce::jmin(history, outgoingSize - historyStart);
+
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                copyIntoRing(channel, 0, outgoing->samples.getReadPointer(channel, historyStart), firstRun);
+                copyIntoRing(channel, firstRun, outgoing->samples.getReadPointer(channel), history - firstRun);
+            }
+
+            ring->writePosition = history & (ring->samples.getNumSamples() - 1);
+        }
+    }
+
+    void copyIntoRing(int channel, int position, const FloatType* source, int numSamples) noexcept
+    {
+        const int size = ring->samples.getNumSamples();
+        const int firstRun = juce::jmin(numSamples, size - position);
+        FloatType* destination = ring->samples.getWritePointer(channel);
+
+        juce::FloatVectorOperations::copy(destination + position, source, firstRun);
+        juce::FloatVectorOperations::copy(destination, source + firstRun, numSamples - firstRun);
+    }
+
+    void readInto(juce::AudioBuffer<FloatType>& destination, int numSamples, int latencySamples) noexcept
+    {
+        if (!ring)
+            return;
+
+        const int size = ring->samples.getNumSamples();
+        numSamples = juce::jmin(numSamples, size);
+
+        // Until a grown ring arrives, a latency that doesn't fit yet is shortened to what the ring holds
+        const int delay = juce::jlimit(0, size - numSamples, latencySamples);
+        const int start = (ring->writePosition - numSamples - delay) & (size - 1);
+        const int firstRun = juce::jmin(numSamples, size - start);
+
+        for (int channel = 0; channel < juce::jmin(destination.getNumChannels(), channels); ++channel)
+        {
+            const FloatType* source = ring->samples.getReadPointer(channel);
+            FloatType* output = destination.getWritePointer(channel);
+            juce::FloatVectorOperations::copy(output, source + start, firstRun);
+            juce::FloatVectorOperations::copy(output + firstRun, source, numSamples - firstRun);
+        }
+    }
+
+    DeferredReclaimer& reclaimer;
+    std::unique_ptr<Ring> ring; // Audio thread once prepared
+    std::atomic<Ring*> pending{nullptr};
+    juce::AudioBuffer<FloatType> delayed; // readDelayed() output
+    int channels = 0;
+    int blockSize = 0;
+    int reservedCapacity = 0; // Message thread: capacity of the largest ring handed over
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BypassDelay)
+};
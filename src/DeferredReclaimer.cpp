@@ -0,0 +1,135 @@
+#include "DeferredReclaimer.h"
+
+#include <algorithm>
+
+//==============================================================================
+DeferredReclaimer::CollectorThread::CollectorThread()
+    : juce::Thread("Deferred Reclaimer")
+{
+    startThread(juce::Thread::Priority::low);
+}
+
+DeferredReclaimer::CollectorThread::~CollectorThread()
+{
+    stopThread(2000);
+}
+
+void DeferredReclaimer::CollectorThread::add(DeferredReclaimer* reclaimer)
+{
+    const juce::ScopedLock sl(lock);
+    reclaimers.addIfNotAlreadyThere(reclaimer);
+}
+
+void DeferredReclaimer::CollectorThread::remove(DeferredReclaimer* reclaimer)
+{
+    // Taking the lock also waits for a collect() that is running on this reclaimer
+    const juce::ScopedLock sl(lock);
+    reclaimers.removeFirstMatchingValue(reclaimer);
+}
+
+void DeferredReclaimer::CollectorThread::run()
+{
+    while (!threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            for (auto* reclaimer : reclaimers)
+                reclaimer->collect();
+        }
+
+        // Woken early by retire(); otherwise poll for audio-thread retirements and new quiescent points
+        wait(50);
+    }
+}
+
+//==============================================================================
+DeferredReclaimer::DeferredReclaimer()
+{
+    collector->add(this);
+}
+
+DeferredReclaimer::~DeferredReclaimer()
+{
+    collector->remove(this);
+
+    // No audio thread any more, so everything is safe to reclaim
+    goOffline();
+    collect();
+
+    jassert(retired.empty());
+}
+
+void DeferredReclaimer::quiescentPoint() noexcept
+{
+    // Release: every access from earlier blocks happens-before a reclaim that observes this value
+    observedEpoch.store(globalEpoch.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void DeferredReclaimer::goOffline() noexcept
+{
+    observedEpoch.store(offlineEpoch, std::memory_order_release);
+}
+
+void DeferredReclaimer::retire(std::function<void()> reclaim)
+{
+    if (!reclaim)
+        return;
+
+    {
+        const juce::ScopedLock sl(retiredLock);
+
+        // The object was unpublished before this call, so a quiescent point that sees the
+        // bumped epoch can only be followed by loads of the replacement
+        const auto epoch = globalEpoch.fetch_add(1, std::memory_order_acq_rel) + 1;
+        retired.push_back({std::move(reclaim), epoch});
+    }
+
+    collector->notify();
+}
+
+bool DeferredReclaimer::retireFromAudioThread(void* object, ReclaimFunction reclaim) noexcept
+{
+    const auto scope = audioFifo.write(1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+        return false;
+
+    scope.forEach([this, object, reclaim](int index) { audioRetired[static_cast<size_t>(index)] = {object, reclaim}; });
+    return true;
+}
+
+void DeferredReclaimer::collect()
+{
+    // Objects the audio thread handed back are no longer referenced anywhere
+    {
+        const auto scope = audioFifo.read(audioFifo.getNumReady());
+        scope.forEach(
+            [this](int index)
+            {
+                auto& item = audioRetired[static_cast<size_t>(index)];
+                item.reclaim(item.object);
+                item = {};
+            }
+        );
+    }
+
+    const auto observed = observedEpoch.load(std::memory_order_acquire);
+
+    std::vector<Retired> ready;
+    {
+        const juce::ScopedLock sl(retiredLock);
+
+        // Keep what the audio thread may still see at the front, move the rest out
+        auto firstReady = std::stable_partition(
+            retired.begin(),
+            retired.end(),
+            [observed](const Retired& item) { return item.epoch > observed; }
+        );
+
+        ready.assign(std::make_move_iterator(firstReady), std::make_move_iterator(retired.end()));
+        retired.erase(firstReady, retired.end());
+    }
+
+    // Reclaim outside the lock; reclaim functions may be slow (e.g. sx_destroyInstance)
+    for (auto& item : ready)
+        item.reclaim();
+}
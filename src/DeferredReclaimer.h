@@ -0,0 +1,113 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <vector>
+
+/**
+ * Epoch-based deferred reclamation for objects the audio thread may still be using.
+ *
+ * Each AudioProcessor owns one DeferredReclaimer. Its audio thread calls
+ * quiescentPoint() at the start of every processBlock, declaring that it holds no
+ * pointer obtained during an earlier block. Any other thread can unpublish an
+ * object (e.g. swap it out of an atomic pointer) and then retire() it; it is
+ * reclaimed on a shared low-priority thread once the audio thread has passed a
+ * quiescent point after the retirement.
+ *
+ * The audio thread can also hand back objects it owns itself (e.g. an SX_Instance
+ * at the end of a crossfade) through retireFromAudioThread(), which is wait-free
+ * and allocation-free.
+ */
+class DeferredReclaimer
+{
+public:
+    using ReclaimFunction = void (*)(void* object);
+
+    DeferredReclaimer();
+
+    /** Reclaims everything still pending. The audio callback must have stopped. */
+    ~DeferredReclaimer();
+
+    //==============================================================================
+    /** Audio thread: nothing loaded before this call is used after it. Wait-free. */
+    void quiescentPoint() noexcept;
+
+    /**
+     * The audio thread holds no references until its next quiescentPoint().
+     * Call when processing stops (releaseResources) so reclamation doesn't stall
+     * while the host isn't calling processBlock.
+     */
+    void goOffline() noexcept;
+
+    //==============================================================================
+    /** Any non-realtime thread: run reclaim once the audio thread can no longer see the object. */
+    void retire(std::function<void()> reclaim);
+
+    template <typename ObjectType>
+    void retire(ObjectType* object)
+    {
+        if (object != nullptr)
+            retire([object] { delete object; });
+    }
+
+    /**
+     * Audio thread: reclaim an object it has finished with.
+     * Realtime safe. Returns false if the fixed-size queue is full; retry on a later block.
+     */
+    bool retireFromAudioThread(void* object, ReclaimFunction reclaim) noexcept;
+
+private:
+    //==============================================================================
+    // Process-wide low-priority thread that collects from every live reclaimer
+    class CollectorThread final : public juce::Thread
+    {
+    public:
+        CollectorThread();
+        ~CollectorThread() override;
+
+        void add(DeferredReclaimer* reclaimer);
+        void remove(DeferredReclaimer* reclaimer);
+
+        void run() override;
+
+    private:
+        juce::CriticalSection lock;
+        juce::Array<DeferredReclaimer*> reclaimers;
+    };
+
+    // Run every reclaim that is safe right now
+    void collect();
+
+    struct Retired
+    {
+        std::function<void()> reclaim;
+        juce::uint64 epoch = 0;
+    };
+
+    struct AudioRetired
+    {
+        void* object = nullptr;
+        ReclaimFunction reclaim = nullptr;
+    };
+
+    static constexpr juce::uint64 offlineEpoch = std::numeric_limits<juce::uint64>::max();
+
+    // Bumped on every retire(); the audio thread publishes the value it last saw
+    std::atomic<juce::uint64> globalEpoch{1};
+    std::atomic<juce::uint64> observedEpoch{offlineEpoch};
+
+    juce::CriticalSection retiredLock;
+    std::vector<Retired> retired;
+
+    static constexpr int audioQueueSize = 64;
+    juce::AbstractFifo audioFifo{audioQueueSize};
+    std::array<AudioRetired, audioQueueSize> audioRetired{};
+
+    juce::SharedResourcePointer<CollectorThread> collector;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeferredReclaimer)
+};
@@ -0,0 +1,681 @@
+#include "InterleaveKernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define JUCESONIC_INTERLEAVE_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define JUCESONIC_INTERLEAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// AVX2 kernels are compiled with a per-function target so the rest of the
+// plugin keeps its baseline instruction set; they are only called when the CPU reports AVX2.
+#if JUCESONIC_INTERLEAVE_X86 && (defined(__GNUC__) || defined(__clang__))
+#define JUCESONIC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JUCESONIC_TARGET_AVX2
+#endif
+
+namespace
+{
+template <typename SampleType>
+using InterleaveFn = void (*)(const SampleType* const*, int, double*, int, int);
+
+template <typename SampleType>
+using DeinterleaveFn = void (*)(const double*, int, SampleType* const*, int, int);
+
+// Slot 0 is the generic kernel, slots 1-4 are the 1/2/4/8 channel specializations
+template <typename SampleType>
+struct KernelTable
+{
+    InterleaveFn<SampleType> interleave[5];
+    DeinterleaveFn<SampleType> deinterleave[5];
+    const char* name;
+};
+
+//==============================================================================
+// Scalar kernels - fallback and tail handling for the SIMD paths
+
+template <typename SampleType>
+inline void interleaveChannelScalar(const SampleType* src, double* dst, int stride, int start, int numSamples)
+{
+    for (int s = start; s < numSamples; ++s)
+        dst[s * stride] = static_cast<double>(src[s]);
+}
+
+template <typename SampleType>
+inline void deinterleaveChannelScalar(const double* src, int stride, SampleType* dst, int start, int numSamples)
+{
+    for (int s = start; s < numSamples; ++s)
+        dst[s] = static_cast<SampleType>(src[s * stride]);
+}
+
+template <typename SampleType, int FixedChannels>
+void interleaveScalar(const SampleType* const* src, int numChannels, double* dst, int stride, int numSamples)
+{
+    const int nch = FixedChannels > 0 ? FixedChannels : numChannels;
+    const int frameStride = FixedChannels > 0 ? FixedChannels : stride;
+
+    for (int ch = 0; ch < nch; ++ch)
+        interleaveChannelScalar(src[ch], dst + ch, frameStride, 0, numSamples);
+}
+
+template <typename SampleType, int FixedChannels>
+void deinterleaveScalar(const double* src, int stride, SampleType* const* dst, int numChannels, int numSamples)
+{
+    const int nch = FixedChannels > 0 ? FixedChannels : numChannels;
+    const int frameStride = FixedChannels > 0 ? FixedChannels : stride;
+
+    for (int ch = 0; ch < nch; ++ch)
+        deinterleaveChannelScalar(src + ch, frameStride, dst[ch], 0, numSamples);
+}
+
+#if JUCESONIC_INTERLEAVE_X86
+//==============================================================================
+// SSE2 kernels - channels are processed in pairs, four frames per iteration
+
+// Load four consecutive samples as two double vectors (samples 0-1 and 2-3)
+inline void loadSSE2(const float* p, __m128d& lo, __m128d& hi)
+{
+    const __m128 f = _mm_loadu_ps(p);
+    lo = _mm_cvtps_pd(f);
+    hi = _mm_cvtps_pd(_mm_movehl_ps(f, f));
+}
+
+inline void loadSSE2(const double* p, __m128d& lo, __m128d& hi)
+{
+    lo = _mm_loadu_pd(p);
+    hi = _mm_loadu_pd(p + 2);
+}
+
+// Store two double vectors as four consecutive samples
+inline void storeSSE2(float* p, __m128d lo, __m128d hi)
+{
+    _mm_storeu_ps(p, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+}
+
+inline void storeSSE2(double* p, __m128d lo, __m128d hi)
+{
+    _mm_storeu_pd(p, lo);
+    _mm_storeu_pd(p + 2, hi);
+}
+
+template <typename SampleType, int FixedChannels>
+void interleaveSSE2(const SampleType* const* src, int numChannels, double* dst, int stride, int numSamples)
+{
+    const int nch = FixedChannels > 0 ? FixedChannels : numChannels;
+    const int frameStride = FixedChannels > 0 ? FixedChannels : stride;
+    const int vectorEnd = numSamples & ~3;
+
+    int ch = 0;
+    for (; ch + 1 < nch; ch += 2)
+    {
+        const SampleType* a = src[ch];
+        const SampleType* b = src[ch + 1];
+        double* out = dst + ch;
+
+        for (int s = 0; s < vectorEnd; s += 4)
+        {
+            __m128d a01, a23, b01, b23;
+            loadSSE2(a + s, a01, a23);
+            loadSSE2(b + s, b01, b23);
+
+            _mm_storeu_pd(out + (s + 0) * frameStride, _mm_unpacklo_pd(a01, b01));
+            _mm_storeu_pd(out + (s + 1) * frameStride, _mm_unpackhi_pd(a01, b01));
+            _mm_storeu_pd(out + (s + 2) * frameStride, _mm_unpacklo_pd(a23, b23));
+            _mm_storeu_pd(out + (s + 3) * frameStride, _mm_unpackhi_pd(a23, b23));
+        }
+
+        interleaveChannelScalar(a, out, frameStride, vectorEnd, numSamples);
+        interleaveChannelScalar(b, out + 1, frameStride, vectorEnd, numSamples);
+    }
+
+    if (ch < nch)
+    {
+        if (frameStride == 1)
+        {
+            const SampleType* a = src[ch];
+            for (int s = 0; s < vectorEnd; s += 4)
+            {
+                __m128d lo, hi;
+                loadSSE2(a + s, lo, hi);
+                storeSSE2(dst + s, lo, hi);
+            }
+            interleaveChannelScalar(a, dst, 1, vectorEnd, numSamples);
+        }
+        else
+        {
+            interleaveChannelScalar(src[ch], dst + ch, frameStride, 0, numSamples);
+        }
+    }
+}
+
+template <typename SampleType, int FixedChannels>
+void deinterleaveSSE2(const double* src, int stride, SampleType* const* dst, int numChannels, int numSamples)
+{
+    const int nch = FixedChannels > 0 ? FixedChannels : numChannels;
+    const int frameStride = FixedChannels > 0 ? FixedChannels : stride;
+    const int vectorEnd = numSamples & ~3;
+
+    int ch = 0;
+    for (; ch + 1 < nch; ch += 2)
+    {
+        const double* in = src + ch;
+        SampleType* a = dst[ch];
+        SampleType* b = dst[ch + 1];
+
+        for (int s = 0; s < vectorEnd; s += 4)
+        {
+            const __m128d f0 = _mm_loadu_pd(in + (s + 0) * frameStride);
+            const __m128d f1 = _mm_loadu_pd(in + (s + 1) * frameStride);
+            const __m128d f2 = _mm_loadu_pd(in + (s + 2) * frameStride);
+            const __m128d f3 = _mm_loadu_pd(in + (s + 3) * frameStride);
+
+            storeSSE2(a + s, _mm_unpacklo_pd(f0, f1), _mm_unpacklo_pd(f2, f3));
+            storeSSE2(b + s, _mm_unpackhi_pd(f0, f1), _mm_unpackhi_pd(f2, f3));
+        }
+
+        deinterleaveChannelScalar(in, frameStride, a, vectorEnd, numSamples);
+        deinterleaveChannelScalar(in + 1, frameStride, b, vectorEnd, numSamples);
+    }
+
+    if (ch < nch)
+    {
+        if (frameStride == 1)
+        {
+            SampleType* a = dst[ch];
+            for (int s = 0; s < vectorEnd; s += 4)
+                storeSSE2(a + s, _mm_loadu_pd(src + s), _mm_loadu_pd(src + s + 2));
+            deinterleaveChannelScalar(src, 1, a, vectorEnd, numSamples);
+        }
+        else
+        {
+            deinterleaveChannelScalar(src + ch, frameStride, dst[ch], 0, numSamples);
+        }
+    }
+}
+
+//==============================================================================
+// AVX2 kernels - channels are processed as 4x4 transposes, then pairs, then singles
+
+JUCESONIC_TARGET_AVX2 inline __m256d loadAVX2(const float* p)
+{
+    return _mm256_cvtps_pd(_mm_loadu_ps(p));
+}
+
+JUCESONIC_TARGET_AVX2 inline __m256d loadAVX2(const double* p)
+{
+    return _mm256_loadu_pd(p);
+}
+
+JUCESONIC_TARGET_AVX2 inline void storeAVX2(float* p, __m256d v)
+{
+    _mm_storeu_ps(p, _mm256_cvtpd_ps(v));
+}
+
+JUCESONIC_TARGET_AVX2 inline void storeAVX2(double* p, __m256d v)
+{
+    _mm256_storeu_pd(p, v);
+}
+
+template <typename SampleType, int FixedChannels>
+JUCESONIC_TARGET_AVX2 void
+interleaveAVX2(const SampleType* const* src, int numChannels, double* dst, int stride, int numSamples)
+{
+    const int nch = FixedChannels > 0 ? FixedChannels : numChannels;
+    const int frameStride = FixedChannels > 0 ? FixedChannels : stride;
+    const int vectorEnd = numSamples & ~3;
+
+    int ch = 0;
+    for (; ch + 3 < nch; ch += 4)
+    {
+        double* out = dst + ch;
+
+        for (int s = 0; s < vectorEnd; s += 4)
+        {
+            const __m256d va = loadAVX2(src[ch + 0] + s);
+            const __m256d vb = loadAVX2(src[ch + 1] + s);
+            const __m256d vc = loadAVX2(src[ch + 2] + s);
+            const __m256d vd = loadAVX2(src[ch + 3] + s);
+
+            const __m256d loAB = _mm256_unpacklo_pd(va, vb); // a0 b0 a2 b2
+            const __m256d hiAB = _mm256_unpackhi_pd(va, vb); // a1 b1 a3 b3
+            const __m256d loCD = _mm256_unpacklo_pd(vc, vd);
+            const __m256d hiCD = _mm256_unpackhi_pd(vc, vd);
+
+            _mm256_storeu_pd(out + (s + 0) * frameStride, _mm256_permute2f128_pd(loAB, loCD, 0x20));
+            _mm256_storeu_pd(out + (s + 1) * frameStride, _mm256_permute2f128_pd(hiAB, hiCD, 0x20));
+            _mm256_storeu_pd(out + (s + 2) * frameStride, _mm256_permute2f128_pd(loAB, loCD, 0x31));
+            _mm256_storeu_pd(out + (s + 3) * frameStride, _mm256_permute2f128_pd(hiAB, hiCD, 0x31));
+        }
+
+        for (int i = 0; i < 4; ++i)
+            interleaveChannelScalar(src[ch + i], out + i, frameStride, vectorEnd, numSamples);
+    }
+
+    for (; ch + 1 < nch; ch += 2)
+    {
+        const SampleType* a = src[ch];
+        const SampleType* b = src[ch + 1];
+        double* out = dst + ch;
+
+        for (int s = 0; s < vectorEnd; s += 4)
+        {
+            const __m256d lo = _mm256_unpacklo_pd(loadAVX2(a + s), loadAVX2(b + s));
+            const __m256d hi = _mm256_unpackhi_pd(loadAVX2(a + s), loadAVX2(b + s));
+
+            _mm_storeu_pd(out + (s + 0) * frameStride, _mm256_castpd256_pd128(lo));
+            _mm_storeu_pd(out + (s + 1) * frameStride, _mm256_castpd256_pd128(hi));
+            _mm_storeu_pd(out + (s + 2) * frameStride, _mm256_extractf128_pd(lo, 1));
+            _mm_storeu_pd(out + (s + 3) * frameStride, _mm256_extractf128_pd(hi, 1));
+        }
+
+        interleaveChannelScalar(a, out, frameStride, vectorEnd, numSamples);
+        interleaveChannelScalar(b, out + 1, frameStride, vectorEnd, numSamples);
+    }
+
+    if (ch < nch)
+    {
+        if (frameStride == 1)
+        {
+            const SampleType* a = src[ch];
+            for (int s = 0; s < vectorEnd; s += 4)
+                storeAVX2(dst + s, loadAVX2(a + s));
+            interleaveChannelScalar(a, dst, 1, vectorEnd, numSamples);
+        }
+        else
+        {
+            interleaveChannelScalar(src[ch], dst + ch, frameStride, 0, numSamples);
+        }
+    }
+
+    _mm256_zeroupper();
+}
+
+template <typename SampleType, int FixedChannels>
+JUCESONIC_TARGET_AVX2 void
+deinterleaveAVX2(const double* src, int stride, SampleType* const* dst, int numChannels, int numSamples)
+{
+    const int nch = FixedChannels > 0 ? FixedChannels : numChannels;
+    const int frameStride = FixedChannels > 0 ? FixedChannels : stride;
+    const int vectorEnd = numSamples & ~3;
+
+    int ch = 0;
+    for (; ch + 3 < nch; ch += 4)
+    {
+        const double* in = src + ch;
+
+        for (int s = 0; s < vectorEnd; s += 4)
+        {
+            const __m256d f0 = _mm256_loadu_pd(in + (s + 0) * frameStride);
+            const __m256d f1 = _mm256_loadu_pd(in + (s + 1) * frameStride);
+            const __m256d f2 = _mm256_loadu_pd(in + (s + 2) * frameStride);
+            const __m256d f3 = _mm256_loadu_pd(in + (s + 3) * frameStride);
+
+            const __m256d t0 = _mm256_unpacklo_pd(f0, f1); // a0 a1 c0 c1
+            const __m256d t1 = _mm256_unpackhi_pd(f0, f1); // b0 b1 d0 d1
+            const __m256d t2 = _mm256_unpacklo_pd(f2, f3); // a2 a3 c2 c3
+            const __m256d t3 = _mm256_unpackhi_pd(f2, f3); // b2 b3 d2 d3
+
+            storeAVX2(dst[ch + 0] + s, _mm256_permute2f128_pd(t0, t2, 0x20));
+            storeAVX2(dst[ch + 1] + s, _mm256_permute2f128_pd(t1, t3, 0x20));
+            storeAVX2(dst[ch + 2] + s, _mm256_permute2f128_pd(t0, t2, 0x31));
+            storeAVX2(dst[ch + 3] + s, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+
+        for (int i = 0; i < 4; ++i)
+            deinterleaveChannelScalar(in + i, frameStride, dst[ch + i], vectorEnd, numSamples);
+    }
+
+    for (; ch + 1 < nch; ch += 2)
+    {
+        const double* in = src + ch;
+        SampleType* a = dst[ch];
+        SampleType* b = dst[ch + 1];
+
+        for (int s = 0; s < vectorEnd; s += 4)
+        {
+            // Pair frames {0, 2} and {1, 3} so the in-lane unpacks yield whole channels
+            const __m256d f02 =
+                _mm256_set_m128d(_mm_loadu_pd(in + (s + 2) * frameStride), _mm_loadu_pd(in + (s + 0) * frameStride));
+            const __m256d f13 =
+                _mm256_set_m128d(_mm_loadu_pd(in + (s + 3) * frameStride), _mm_loadu_pd(in + (s + 1) * frameStride));
+
+            storeAVX2(a + s, _mm256_unpacklo_pd(f02, f13));
+            storeAVX2(b + s, _mm256_unpackhi_pd(f02, f13));
+        }
+
+        deinterleaveChannelScalar(in, frameStride, a, vectorEnd, numSamples);
+        deinterleaveChannelScalar(in + 1, frameStride, b, vectorEnd, numSamples);
+    }
+
+    if (ch < nch)
+    {
+        if (frameStride == 1)
+        {
+            SampleType* a = dst[ch];
+            for (int s = 0; s < vectorEnd; s += 4)
+                storeAVX2(a + s, _mm256_loadu_pd(src + s));
+            deinterleaveChannelScalar(src, 1, a, vectorEnd, numSamples);
+        }
+        else
+        {
+            deinterleaveChannelScalar(src + ch, frameStride, dst[ch], 0, numSamples);
+        }
+    }
+
+    _mm256_zeroupper();
+}
+#endif // JUCESONIC_INTERLEAVE_X86
+
+#if JUCESONIC_INTERLEAVE_NEON
+//==============================================================================
+// NEON kernels - channels are processed in pairs, four frames per iteration
+
+inline void loadNEON(const float* p, float64x2_t& lo, float64x2_t& hi)
+{
+    const float32x4_t f = vld1q_f32(p);
+    lo = vcvt_f64_f32(vget_low_f32(f));
+    hi = vcvt_high_f64_f32(f);
+}
+
+inline void loadNEON(const double* p, float64x2_t& lo, float64x2_t& hi)
+{
+    lo = vld1q_f64(p);
+    hi = vld1q_f64(p + 2);
+}
+
+inline void storeNEON(float* p, float64x2_t lo, float64x2_t hi)
+{
+    vst1q_f32(p, vcvt_high_f32_f64(vcvt_f32_f64(lo), hi));
+}
+
+inline void storeNEON(double* p, float64x2_t lo, float64x2_t hi)
+{
+    vst1q_f64(p, lo);
+    vst1q_f64(p + 2, hi);
+}
+
+template <typename SampleType, int FixedChannels>
+void interleaveNEON(const SampleType* const* src, int numChannels, double* dst, int stride, int numSamples)
+{
+    const int nch = FixedChannels > 0 ? FixedChannels : numChannels;
+    const int frameStride = FixedChannels > 0 ? FixedChannels : stride;
+    const int vectorEnd = numSamples & ~3;
+
+    int ch = 0;
+    for (; ch + 1 < nch; ch += 2)
+    {
+        const SampleType* a = src[ch];
+        const SampleType* b = src[ch + 1];
+        double* out = dst + ch;
+
+        for (int s = 0; s < vectorEnd; s += 4)
+        {
+            float64x2_t a01, a23, b01, b23;
+            loadNEON(a + s, a01, a23);
+            loadNEON(b + s, b01, b23);
+
+            vst1q_f64(out + (s + 0) * frameStride, vzip1q_f64(a01, b01));
+            vst1q_f64(out + (s + 1) * frameStride, vzip2q_f64(a01, b01));
+            vst1q_f64(out + (s + 2) * frameStride, vzip1q_f64(a23, b23));
+            vst1q_f64(out + (s + 3) * frameStride, vzip2q_f64(a23, b23));
+        }
+
+        interleaveChannelScalar(a, out, frameStride, vectorEnd, numSamples);
+        interleaveChannelScalar(b, out + 1, frameStride, vectorEnd, numSamples);
+    }
+
+    if (ch < nch)
+    {
+        if (frameStride == 1)
+        {
+            const SampleType* a = src[ch];
+            for (int s = 0; s < vectorEnd; s += 4)
+            {
+                float64x2_t lo, hi;
+                loadNEON(a + s, lo, hi);
+                storeNEON(dst + s, lo, hi);
+            }
+            interleaveChannelScalar(a, dst, 1, vectorEnd, numSamples);
+        }
+        else
+        {
+            interleaveChannelScalar(src[ch], dst + ch, frameStride, 0, numSamples);
+        }
+    }
+}
+
+template <typename SampleType, int FixedChannels>
+void deinterleaveNEON(const double* src, int stride, SampleType* const* dst, int numChannels, int numSamples)
+{
+    const int nch = FixedChannels > 0 ? FixedChannels : numChannels;
+    const int frameStride = FixedChannels > 0 ? FixedChannels : stride;
+    const int vectorEnd = numSamples & ~3;
+
+    int ch = 0;
+    for (; ch + 1 < nch; ch += 2)
+    {
+        const double* in = src + ch;
+        SampleType* a = dst[ch];
+        SampleType* b = dst[ch + 1];
+
+        for (int s = 0; s < vectorEnd; s += 4)
+        {
+            const float64x2_t f0 = vld1q_f64(in + (s + 0) * frameStride);
+            const float64x2_t f1 = vld1q_f64(in + (s + 1) * frameStride);
+            const float64x2_t f2 = vld1q_f64(in + (s + 2) * frameStride);
+            const float64x2_t f3 = vld1q_f64(in + (s + 3) * frameStride);
+
+            storeNEON(a + s, vzip1q_f64(f0, f1), vzip1q_f64(f2, f3));
+            storeNEON(b + s, vzip2q_f64(f0, f1), vzip2q_f64(f2, f3));
+        }
+
+        deinterleaveChannelScalar(in, frameStride, a, vectorEnd, numSamples);
+        deinterleaveChannelScalar(in + 1, frameStride, b, vectorEnd, numSamples);
+    }
+
+    if (ch < nch)
+    {
+        if (frameStride == 1)
+        {
+            SampleType* a = dst[ch];
+            for (int s = 0; s < vectorEnd; s += 4)
+                storeNEON(a + s, vld1q_f64(src + s), vld1q_f64(src + s + 2));
+            deinterleaveChannelScalar(src, 1, a, vectorEnd, numSamples);
+        }
+        else
+        {
+            deinterleaveChannelScalar(src + ch, frameStride, dst[ch], 0, numSamples);
+        }
+    }
+}
+#endif // JUCESONIC_INTERLEAVE_NEON
+
+//==============================================================================
+template <typename SampleType>
+KernelTable<SampleType> selectKernelTable()
+{
+    using T = SampleType;
+
+#if JUCESONIC_INTERLEAVE_X86
+    if (juce::SystemStats::hasAVX2())
+        return {
+            {interleaveAVX2<T, 0>,
+             interleaveAVX2<T, 1>,
+             interleaveAVX2<T, 2>,
+             interleaveAVX2<T, 4>,
+             interleaveAVX2<T, 8>},
+            {deinterleaveAVX2<T, 0>,
+             deinterleaveAVX2<T, 1>,
+             deinterleaveAVX2<T, 2>,
+             deinterleaveAVX2<T, 4>,
+             deinterleaveAVX2<T, 8>},
+            "AVX2"
+        };
+
+    if (juce::SystemStats::hasSSE2())
+        return {
+            {interleaveSSE2<T, 0>,
+             interleaveSSE2<T, 1>,
+             interleaveSSE2<T, 2>,
+             interleaveSSE2<T, 4>,
+             interleaveSSE2<T, 8>},
+            {deinterleaveSSE2<T, 0>,
+             deinterleaveSSE2<T, 1>,
+             deinterleaveSSE2<T, 2>,
+             deinterleaveSSE2<T, 4>,
+             deinterleaveSSE2<T, 8>},
+            "SSE2"
+        };
+#elif JUCESONIC_INTERLEAVE_NEON
+    return {
+        {interleaveNEON<T, 0>, interleaveNEON<T, 1>, interleaveNEON<T, 2>, interleaveNEON<T, 4>, interleaveNEON<T, 8>},
+        {deinterleaveNEON<T, 0>,
+         deinterleaveNEON<T, 1>,
+         deinterleaveNEON<T, 2>,
+         deinterleaveNEON<T, 4>,
+         deinterleaveNEON<T, 8>},
+        "NEON"
+    };
+#endif
+
+    return {
+        {interleaveScalar<T, 0>,
+         interleaveScalar<T, 1>,
+         interleaveScalar<T, 2>,
+         interleaveScalar<T, 4>,
+         interleaveScalar<T, 8>},
+        {deinterleaveScalar<T, 0>,
+         deinterleaveScalar<T, 1>,
+         deinterleaveScalar<T, 2>,
+         deinterleaveScalar<T, 4>,
+         deinterleaveScalar<T, 8>},
+        "Scalar"
+    };
+}
+
+template <typename SampleType>
+const KernelTable<SampleType>& getKernelTable()
+{
+    static const KernelTable<SampleType> table = selectKernelTable<SampleType>();
+    return table;
+}
+
+// Pick the 1/2/4/8 specialization when the frame is densely packed, otherwise the generic kernel
+inline int getKernelSlot(int numChannels, int frameStride)
+{
+    if (numChannels != frameStride)
+        return 0;
+
+    switch (numChannels)
+    {
+    case 1:
+        return 1;
+    case 2:
+        return 2;
+    case 4:
+        return 3;
+    case 8:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+template <typename SampleType>
+void interleaveImpl(const SampleType* const* src, int numChannels, double* dst, int frameStride, int numSamples)
+{
+    if (numSamples <= 0 || frameStride <= 0)
+        return;
+
+    numChannels = juce::jlimit(0, frameStride, numChannels);
+
+    if (numChannels > 0)
+        getKernelTable<SampleType>().interleave[getKernelSlot(numChannels, frameStride)](
+            src,
+            numChannels,
+            dst,
+            frameStride,
+            numSamples
+        );
+
+    // Zero the unused channels of every frame
+    if (numChannels < frameStride)
+    {
+        const auto numUnused = static_cast<size_t>(frameStride - numChannels);
+        for (int s = 0; s < numSamples; ++s)
+            std::fill_n(dst + s * frameStride + numChannels, numUnused, 0.0);
+    }
+}
+
+template <typename SampleType>
+void deinterleaveImpl(const double* src, int frameStride, SampleType* const* dst, int numChannels, int numSamples)
+{
+    if (numSamples <= 0 || frameStride <= 0)
+        return;
+
+    numChannels = juce::jlimit(0, frameStride, numChannels);
+
+    if (numChannels > 0)
+        getKernelTable<SampleType>().deinterleave[getKernelSlot(numChannels, frameStride)](
+            src,
+            frameStride,
+            dst,
+            numChannels,
+            numSamples
+        );
+}
+} // namespace
+
+//==============================================================================
+void InterleaveKernels::interleave(
+    const float* const* src,
+    int numChannels,
+    double* dst,
+    int frameStride,
+    int numSamples
+)
+{
+    interleaveImpl(src, numChannels, dst, frameStride, numSamples);
+}
+
+void InterleaveKernels::interleave(
+    const double* const* src,
+    int numChannels,
+    double* dst,
+    int frameStride,
+    int numSamples
+)
+{
+    interleaveImpl(src, numChannels, dst, frameStride, numSamples);
+}
+
+void InterleaveKernels::deinterleave(
+    const double* src,
+    int frameStride,
+    float* const* dst,
+    int numChannels,
+    int numSamples
+)
+{
+    deinterleaveImpl(src, frameStride, dst, numChannels, numSamples);
+}
+
+void InterleaveKernels::deinterleave(
+    const double* src,
+    int frameStride,
+    double* const* dst,
+    int numChannels,
+    int numSamples
+)
+{
+    deinterleaveImpl(src, frameStride, dst, numChannels, numSamples);
+}
+
+const char* InterleaveKernels::getInstructionSetName()
+{
+    return getKernelTable<float>().name;
+}
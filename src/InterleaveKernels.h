@@ -0,0 +1,37 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Conversion kernels between JUCE's planar float/double buffers and the
+ * interleaved double layout expected by sx_processSamples().
+ *
+ * Specialized kernels exist for 1, 2, 4 and 8 channel frames plus a generic
+ * N channel kernel. The instruction set (SSE2, AVX2 or NEON, with a scalar
+ * fallback) is chosen once at runtime from the capabilities of the CPU.
+ *
+ * All functions are realtime safe: no allocation, no locks.
+ */
+class InterleaveKernels
+{
+public:
+    /**
+     * Write numChannels planar channels into an interleaved double buffer.
+     * Each frame holds frameStride doubles; channels in [numChannels, frameStride)
+     * are zero-filled, so the destination does not need clearing beforehand.
+     */
+    static void interleave(const float* const* src, int numChannels, double* dst, int frameStride, int numSamples);
+    static void interleave(const double* const* src, int numChannels, double* dst, int frameStride, int numSamples);
+
+    /**
+     * Write the first numChannels channels of an interleaved double buffer into
+     * planar channels (overwrites the destination).
+     */
+    static void deinterleave(const double* src, int frameStride, float* const* dst, int numChannels, int numSamples);
+    static void deinterleave(const double* src, int frameStride, double* const* dst, int numChannels, int numSamples);
+
+    /**
+     * Name of the instruction set selected for this machine ("AVX2", "SSE2", "NEON" or "Scalar").
+     */
+    static const char* getInstructionSetName();
+};
@@ -0,0 +1,44 @@
+#include "JsfxChain.h"
+
+#include <algorithm>
+
+void JsfxChain::preparePipeline()
+{
+    pipelineStorage.resize(stages.size());
+    pipeline.clear();
+
+    for (auto& buffer : pipelineStorage)
+    {
+        buffer.setSize(1, capacitySamples * numChannels);
+        buffer.clear();
+        pipeline.push_back(buffer.getWritePointer(0));
+    }
+
+    pipelineBlockSize = 0;
+}
+
+void JsfxChain::beginPipelineBlock(int numSamples) noexcept
+{
+    if (numSamples == pipelineBlockSize)
+        return;
+
+    // Audio buffered at another block size no longer lines up; start over from silence
+    const size_t length = static_cast<size_t>(numSamples) * static_cast<size_t>(numChannels);
+    for (auto* buffer : pipeline)
+        std::fill(buffer, buffer + length, 0.0);
+
+    pipelineBlockSize = numSamples;
+}
+
+void JsfxChain::advancePipeline(double* block, int numSamples) noexcept
+{
+    if (pipeline.empty())
+        return;
+
+    const size_t length = static_cast<size_t>(numSamples) * static_cast<size_t>(numChannels);
+
+    // Stage i processed pipeline[i], which now feeds stage i + 1; the last stage's output
+    // leaves the pipeline and its buffer takes the main JSFX output for stage 0
+    std::rotate(pipeline.begin(), pipeline.end() - 1, pipeline.end());
+    std::swap_ranges(block, block + length, pipeline.front());
+}
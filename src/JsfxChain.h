@@ -0,0 +1,68 @@
+#pragma once
+
+#include <jsfx.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <vector>
+
+//==============================================================================
+/**
+ * Snapshot of the JSFX chain: further instances that run in order after the
+ * main JSFX, on the same interleaved buffer.
+ *
+ * Built on the message thread and published to the audio thread, which uses
+ * it for a whole block. The stage instances belong to the processor; a
+ * snapshot only refers to them.
+ *
+ * When pipelined, every stage processes the output the stage before it made
+ * in the previous block, so the main JSFX and all stages can run at once on
+ * different cores. This adds one block of latency per stage and needs blocks
+ * of a fixed size.
+ *
+ * Stages process audio only. They have no MIDI callback, so they see neither
+ * the host's MIDI nor what the main JSFX sends, and what they send is dropped:
+ * an instrument driven by a MIDI effect still needs plugin instances of its own.
+ */
+struct JsfxChain
+{
+    std::vector<SX_Instance*> stages;
+    bool pipelined = false;
+    int numChannels = 0;     // JSFX channel count the pipeline buffers were made for
+    int capacitySamples = 0; // Largest block the pipeline buffers hold
+
+    /** Allocate the pipeline buffers (message thread, before publishing). */
+    void preparePipeline();
+
+    /** Audio thread: whether a block can go through the pipeline buffers. */
+    bool canPipeline(int numSamples, int blockChannels) const noexcept
+    {
+        return pipelined && numSamples > 0 && numSamples <= capacitySamples && blockChannels == numChannels;
+    }
+
+    /** Audio thread, before the stages run: clears the pipeline when the block size changed. */
+    void beginPipelineBlock(int numSamples) noexcept;
+
+    /** Audio thread: input of stage index for this block (the output of the stage before it, one block ago). */
+    double* getPipelineInput(int stageIndex) const noexcept
+    {
+        return pipeline[static_cast<size_t>(stageIndex)];
+    }
+
+    /**
+     * Audio thread, after the main JSFX and every stage processed this block:
+     * moves each stage's output on to the next stage and swaps the main JSFX
+     * output in block for the output of the last stage.
+     */
+    void advancePipeline(double* block, int numSamples) noexcept;
+
+    /** Latency the pipeline adds, in samples (0 until a block went through it). */
+    int getPipelineLatency() const noexcept
+    {
+        return static_cast<int>(stages.size()) * pipelineBlockSize;
+    }
+
+private:
+    std::vector<juce::AudioBuffer<double>> pipelineStorage;
+    std::vector<double*> pipeline; // Audio thread: rotated instead of copied
+    int pipelineBlockSize = 0;     // Audio thread: block size the buffered audio was made with
+};
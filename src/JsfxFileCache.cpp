@@ -0,0 +1,130 @@
+#include "JsfxFileCache.h"
+
+#include "JsfxHelper.h"
+#include "ReaperPresetConverter.h"
+
+namespace
+{
+// FNV-1a: only has to tell one version of a file from the next
+juce::uint64 hashContent(const juce::MemoryBlock& data)
+{
+    juce::uint64 hash = 14695981039346656037ull;
+    const auto* bytes = static_cast<const juce::uint8*>(data.getData());
+    for (size_t i = 0; i < data.getSize(); ++i)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+
+    return hash;
+}
+
+// The path every spelling of one file maps to: juce::File keeps "." and ".." segments as given,
+// and on a case-insensitive file system "A.jsfx" and "a.jsfx" are the same file
+juce::String getCanonicalPath(const juce::File& file)
+{
+    const auto separator = juce::File::getSeparatorString();
+    const auto path = file.getLinkedTarget().getFullPathName();
+
+    // The first segment is the root ("" or a drive), which ".." can't remove
+    juce::StringArray segments;
+    for (const auto& segment : juce::StringArray::fromTokens(path, separator, ""))
+    {
+        if (segment == ".")
+            continue;
+
+        if (segment == ".." && segments.size() > 1)
+            segments.remove(segments.size() - 1);
+        else
+            segments.add(segment);
+    }
+
+    const auto canonical = segments.joinIntoString(separator);
+    return juce::File::areFileNamesCaseSensitive() ? canonical : canonical.toLowerCase();
+}
+} // namespace
+
+//==============================================================================
+std::shared_ptr<const JsfxFileCache::ScriptInfo> JsfxFileCache::getScriptInfo(const juce::File& jsfxFile)
+{
+    auto entry = getEntry(scripts, jsfxFile);
+    const juce::ScopedLock lock(entry->lock);
+
+    juce::MemoryBlock data;
+    if (needsParsing(*entry, jsfxFile, data))
+    {
+        if (data.isEmpty())
+        {
+            entry->script = nullptr;
+        }
+        else
+        {
+            // The source is only needed while parsing; the compiler reads the file itself
+            const auto source = juce::String::createStringFromData(data.getData(), static_cast<int>(data.getSize()));
+            auto script = std::make_shared<ScriptInfo>();
+            script->author = JsfxHelper::parseJSFXAuthorFromSource(source);
+            script->hasGfx = source.contains("@gfx");
+            entry->script = std::move(script);
+        }
+    }
+
+    return entry->script;
+}
+
+juce::ValueTree JsfxFileCache::getPresetFile(const juce::File& rplFile)
+{
+    auto entry = getEntry(presetFiles, rplFile);
+    const juce::ScopedLock lock(entry->lock);
+
+    juce::MemoryBlock data;
+    if (needsParsing(*entry, rplFile, data))
+    {
+        // The converter reads the file again; that only happens when it changed
+        ReaperPresetConverter converter;
+        entry->presetFile = data.isEmpty() ? juce::ValueTree() : converter.convertFileToTree(rplFile);
+    }
+
+    return entry->presetFile.createCopy();
+}
+
+void JsfxFileCache::clear()
+{
+    const juce::ScopedLock lock(mapLock);
+    scripts.clear();
+    presetFiles.clear();
+}
+
+//==============================================================================
+std::shared_ptr<JsfxFileCache::Entry>
+JsfxFileCache::getEntry(std::map<juce::String, std::shared_ptr<Entry>>& entries, const juce::File& file)
+{
+    // Symlinked, relative and differently cased paths to one file share an entry
+    const auto key = getCanonicalPath(file);
+
+    const juce::ScopedLock lock(mapLock);
+    auto& entry = entries[key];
+    if (!entry)
+        entry = std::make_shared<Entry>();
+
+    return entry;
+}
+
+bool JsfxFileCache::needsParsing(Entry& entry, const juce::File& file, juce::MemoryBlock& data)
+{
+    const auto modificationTime = file.getLastModificationTime();
+    const auto size = file.getSize();
+    if (size == entry.size && modificationTime == entry.modificationTime)
+        return false;
+
+    entry.modificationTime = modificationTime;
+    entry.size = size;
+
+    if (!file.loadFileAsData(data))
+        data.reset();
+
+    // Touched but not changed: keep what was parsed
+    const auto contentHash = hashContent(data);
+    const bool hasParsed = entry.script != nullptr || entry.presetFile.isValid();
+    if (hasParsed && contentHash == entry.contentHash)
+        return false;
+
+    entry.contentHash = contentHash;
+    return true;
+}
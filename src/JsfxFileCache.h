@@ -0,0 +1,77 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_data_structures/juce_data_structures.h>
+
+#include <map>
+#include <memory>
+
+/**
+ * Process-wide cache of the files every plugin instance would otherwise read and
+ * parse for itself: JSFX header metadata, and parsed .rpl preset libraries. When
+ * a session opens 40 instances of one effect, its script and presets are read
+ * and parsed once. Only the metadata of a script is kept, not its source, which
+ * the compiler reads from disk anyway.
+ *
+ * Shared by every plugin instance in the process via
+ * juce::SharedResourcePointer<JsfxFileCache>, and freed with the last one.
+ *
+ * Entries are keyed by canonical path (link target, "." and ".." resolved, case
+ * folded where the file system ignores it) and checked against the file's
+ * modification time and size on every lookup. When either changed, the file is
+ * read again; if its content hash is unchanged (touched, or copied over with the
+ * same content) the parsed data is kept. Concurrent lookups of the same file
+ * wait for one read instead of each doing it.
+ *
+ * Preset trees are handed out as copies of the cached tree. ValueTree copies
+ * share their string data, so the base64 preset payloads are held once however
+ * many instances list them.
+ *
+ * Compiled EEL2 code is not shared: sx_createInstance() preprocesses and
+ * compiles into the new instance's own VM from a path, with no way to hand it
+ * prepared source or code.
+ *
+ * Thread-safe: any thread.
+ */
+class JsfxFileCache
+{
+public:
+    struct ScriptInfo
+    {
+        juce::String author; // "Unknown" without an author: line in the header
+        bool hasGfx = false;
+    };
+
+    JsfxFileCache() = default;
+
+    /** The JSFX's header metadata; null if it can't be read. */
+    std::shared_ptr<const ScriptInfo> getScriptInfo(const juce::File& jsfxFile);
+
+    /** A copy of the preset library parsed by ReaperPresetConverter; invalid if it can't be read. */
+    juce::ValueTree getPresetFile(const juce::File& rplFile);
+
+    /** Forget everything, e.g. after a bulk change on disk. Lookups in progress finish normally. */
+    void clear();
+
+private:
+    struct Entry
+    {
+        juce::CriticalSection lock; // Held while the file is read, so concurrent lookups wait for it
+        juce::Time modificationTime;
+        juce::int64 size = -1;
+        juce::uint64 contentHash = 0;
+        std::shared_ptr<const ScriptInfo> script;
+        juce::ValueTree presetFile;
+    };
+
+    std::shared_ptr<Entry> getEntry(std::map<juce::String, std::shared_ptr<Entry>>& entries, const juce::File& file);
+
+    /** Entry lock held: whether the file is new or changed, reading it into data if so. */
+    static bool needsParsing(Entry& entry, const juce::File& file, juce::MemoryBlock& data);
+
+    juce::CriticalSection mapLock;
+    std::map<juce::String, std::shared_ptr<Entry>> scripts;
+    std::map<juce::String, std::shared_ptr<Entry>> presetFiles;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JsfxFileCache)
+};
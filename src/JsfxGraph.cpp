@@ -0,0 +1,271 @@
+#include "JsfxGraph.h"
+
+#include <algorithm>
+
+extern jsfxAPI JesusonicAPI;
+
+namespace
+{
+// Kahn's algorithm; returns fewer than numNodes entries if the edges contain a cycle
+std::vector<int> sortTopologically(int numNodes, const std::vector<JsfxGraph::EdgeDescription>& edges)
+{
+    std::vector<int> incoming(static_cast<size_t>(numNodes), 0);
+    for (const auto& edge : edges)
+        if (edge.source != JsfxGraph::graphIO && edge.destination != JsfxGraph::graphIO)
+            ++incoming[static_cast<size_t>(edge.destination)];
+
+    std::vector<int> order;
+    for (int node = 0; node < numNodes; ++node)
+        if (incoming[static_cast<size_t>(node)] == 0)
+            order.push_back(node);
+
+    for (size_t next = 0; next < order.size(); ++next)
+        for (const auto& edge : edges)
+            if (edge.source == order[next] && edge.destination != JsfxGraph::graphIO)
+                if (--incoming[static_cast<size_t>(edge.destination)] == 0)
+                    order.push_back(edge.destination);
+
+    return order;
+}
+} // namespace
+
+//==============================================================================
+bool JsfxGraph::isValid(int numNodes, const std::vector<EdgeDescription>& edges)
+{
+    for (const auto& edge : edges)
+    {
+        if (edge.source != graphIO && !juce::isPositiveAndBelow(edge.source, numNodes))
+            return false;
+
+        if (edge.destination != graphIO && !juce::isPositiveAndBelow(edge.destination, numNodes))
+            return false;
+
+        if (edge.source != graphIO && edge.source == edge.destination)
+            return false;
+    }
+
+    return static_cast<int>(sortTopologically(numNodes, edges).size()) == numNodes;
+}
+
+std::unique_ptr<JsfxGraph> JsfxGraph::create(
+    const std::vector<SX_Instance*>& instances,
+    const std::vector<EdgeDescription>& edges,
+    int numChannels,
+    int capacitySamples
+)
+{
+    const int numNodes = static_cast<int>(instances.size());
+    if (numNodes == 0 || !isValid(numNodes, edges))
+        return nullptr;
+
+    // Until an edge reaches the graph output the graph would only produce silence
+    if (std::none_of(edges.begin(), edges.end(), [](const auto& edge) { return edge.destination == graphIO; }))
+        return nullptr;
+
+    std::unique_ptr<JsfxGraph> graph(new JsfxGraph());
+    graph->numChannels = numChannels;
+    graph->capacitySamples = capacitySamples;
+    graph->topologicalOrder = sortTopologically(numNodes, edges);
+    graph->outputBuffer.setSize(1, capacitySamples * numChannels);
+    graph->readySlots = std::vector<std::atomic<int>>(static_cast<size_t>(numNodes));
+
+    for (auto* instance : instances)
+    {
+        auto node = std::make_unique<Node>();
+        node->instance = instance;
+        node->buffer.setSize(1, capacitySamples * numChannels);
+        graph->nodes.push_back(std::move(node));
+    }
+
+    for (const auto& description : edges)
+    {
+        Edge edge;
+        edge.source = description.source;
+        RoutingPlan::compileMatrix(description.matrix, numChannels, numChannels, edge.connections);
+
+        if (description.destination == graphIO)
+        {
+            graph->outputs.push_back(std::move(edge));
+            continue;
+        }
+
+        auto& destination = *graph->nodes[static_cast<size_t>(description.destination)];
+        if (description.source != graphIO)
+        {
+            graph->nodes[static_cast<size_t>(description.source)]->dependents.push_back(description.destination);
+            ++destination.numDependencies;
+        }
+
+        destination.inputs.push_back(std::move(edge));
+    }
+
+    return graph;
+}
+
+//==============================================================================
+int JsfxGraph::getLatencySamples() noexcept
+{
+    // Longest path through the graph; shorter parallel branches aren't delay-compensated
+    int latency = 0;
+
+    for (int nodeIndex : topologicalOrder)
+    {
+        auto& node = *nodes[static_cast<size_t>(nodeIndex)];
+        const int nodeLatency = node.pathLatency + JesusonicAPI.sx_getCurrentLatency(node.instance);
+        latency = juce::jmax(latency, nodeLatency);
+
+        for (int dependent : node.dependents)
+        {
+            auto& dependentNode = *nodes[static_cast<size_t>(dependent)];
+            dependentNode.pathLatency = juce::jmax(dependentNode.pathLatency, nodeLatency);
+        }
+
+        node.pathLatency = 0;
+    }
+
+    return latency;
+}
+
+void JsfxGraph::processImpl(
+    double* block,
+    int numSamples,
+    RealtimeThreadPool* pool,
+    RunNodeFunction function,
+    void* context
+) noexcept
+{
+    // Node buffers hold capacitySamples frames; a longer host block runs through in pieces
+    for (int start = 0; start < numSamples; start += capacitySamples)
+    {
+        const int length = juce::jmin(capacitySamples, numSamples - start);
+        double* chunk = block + static_cast<size_t>(start) * static_cast<size_t>(numChannels);
+        processChunk(chunk, length, pool, function, context);
+    }
+}
+
+void JsfxGraph::processChunk(
+    double* block,
+    int numSamples,
+    RealtimeThreadPool* pool,
+    RunNodeFunction function,
+    void* context
+) noexcept
+{
+    const int numNodes = static_cast<int>(nodes.size());
+
+    if (pool == nullptr)
+    {
+        for (int nodeIndex : topologicalOrder)
+            runNode(nodeIndex, block, numSamples, function, context);
+    }
+    else
+    {
+        readyPushed.store(0, std::memory_order_relaxed);
+        readyPopped.store(0, std::memory_order_relaxed);
+        nodesCompleted.store(0, std::memory_order_relaxed);
+
+        for (auto& slot : readySlots)
+            slot.store(-1, std::memory_order_relaxed);
+
+        for (int nodeIndex = 0; nodeIndex < numNodes; ++nodeIndex)
+        {
+            auto& node = *nodes[static_cast<size_t>(nodeIndex)];
+            node.remainingDependencies.store(node.numDependencies, std::memory_order_relaxed);
+        }
+
+        for (int nodeIndex = 0; nodeIndex < numNodes; ++nodeIndex)
+            if (nodes[static_cast<size_t>(nodeIndex)]->numDependencies == 0)
+                pushReady(nodeIndex);
+
+        // One runner per thread that can help; each takes ready nodes until the whole graph is done
+        auto runner = [&](int) { runReadyNodes(block, numSamples, function, context); };
+        pool->parallelFor(juce::jmin(numNodes, pool->getNumWorkers() + 1), runner);
+    }
+
+    // The graph input is still read by direct input -> output edges, so sum into a separate buffer
+    const size_t length = static_cast<size_t>(numSamples) * static_cast<size_t>(numChannels);
+    double* output = outputBuffer.getWritePointer(0);
+    std::fill(output, output + length, 0.0);
+
+    for (const auto& edge : outputs)
+    {
+        const double* source = getEdgeSource(edge, block);
+        RoutingPlan::mixInterleaved(edge.connections, source, numChannels, output, numChannels, numSamples);
+    }
+
+    std::copy(output, output + length, block);
+}
+
+void JsfxGraph::runNode(
+    int nodeIndex,
+    const double* block,
+    int numSamples,
+    RunNodeFunction function,
+    void* context
+) noexcept
+{
+    auto& node = *nodes[static_cast<size_t>(nodeIndex)];
+    double* interleaved = node.buffer.getWritePointer(0);
+    std::fill(interleaved, interleaved + static_cast<size_t>(numSamples) * static_cast<size_t>(numChannels), 0.0);
+
+    for (const auto& edge : node.inputs)
+    {
+        const double* source = getEdgeSource(edge, block);
+        RoutingPlan::mixInterleaved(edge.connections, source, numChannels, interleaved, numChannels, numSamples);
+    }
+
+    function(context, node.instance, interleaved, numChannels, numSamples);
+}
+
+void JsfxGraph::runReadyNodes(const double* block, int numSamples, RunNodeFunction function, void* context) noexcept
+{
+    juce::ScopedNoDenormals noDenormals;
+    const int numNodes = static_cast<int>(nodes.size());
+
+    while (nodesCompleted.load(std::memory_order_acquire) < numNodes)
+    {
+        const int nodeIndex = popReady();
+        if (nodeIndex < 0)
+        {
+            // Every ready node is taken; wait for a running one to release its dependents
+            RealtimeThreadPool::spinPause();
+            continue;
+        }
+
+        runNode(nodeIndex, block, numSamples, function, context);
+
+        // The last input to finish releases the dependent, with every input's output visible to it
+        for (int dependent : nodes[static_cast<size_t>(nodeIndex)]->dependents)
+        {
+            auto& remaining = nodes[static_cast<size_t>(dependent)]->remainingDependencies;
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                pushReady(dependent);
+        }
+
+        nodesCompleted.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+void JsfxGraph::pushReady(int nodeIndex) noexcept
+{
+    const int slot = readyPushed.fetch_add(1, std::memory_order_acq_rel);
+    readySlots[static_cast<size_t>(slot)].store(nodeIndex, std::memory_order_release);
+}
+
+int JsfxGraph::popReady() noexcept
+{
+    int slot = readyPopped.load(std::memory_order_acquire);
+
+    do
+    {
+        if (slot >= readyPushed.load(std::memory_order_acquire))
+            return -1;
+    } while (!readyPopped.compare_exchange_weak(slot, slot + 1, std::memory_order_acq_rel));
+
+    // The pusher reserves the slot before writing it; the write follows right after
+    int nodeIndex;
+    while ((nodeIndex = readySlots[static_cast<size_t>(slot)].load(std::memory_order_acquire)) < 0)
+        RealtimeThreadPool::spinPause();
+
+    return nodeIndex;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "RealtimeThreadPool.h"
+#include "RoutingPlan.h"
+
+#include <jsfx.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * Snapshot of a small DAG of JSFX nodes, run on the interleaved JSFX buffer.
+ *
+ * Edges carry a routing matrix from one node's channels to another's, so a
+ * split is one source feeding several edges and a merge is several edges into
+ * one destination (they're summed). graphIO as an edge endpoint stands for the
+ * block coming into the graph (source) or the block it produces (destination).
+ *
+ * Nodes whose inputs are all done run in parallel on the realtime thread pool:
+ * finished nodes release their dependents into a shared lock-free ready queue,
+ * which every thread of the job takes work from. Each node sums its inputs in
+ * edge order on its own, so the result doesn't depend on which thread ran what;
+ * process() with no pool runs the nodes in topological order on the calling
+ * thread, for a fully deterministic render.
+ *
+ * Built on the message thread and published to the audio thread, which uses it
+ * for a whole block. Node instances belong to the processor.
+ *
+ * Nodes process audio only: like chain stages they have no MIDI callback, so
+ * host MIDI and the main JSFX's MIDI output reach none of them.
+ */
+class JsfxGraph
+{
+public:
+    static constexpr int graphIO = -1;
+
+    struct EdgeDescription
+    {
+        int source = graphIO;
+        int destination = graphIO;
+        RoutingConfig::Matrix matrix{};
+    };
+
+    /**
+     * Message thread: build the snapshot for these nodes and edges. Returns
+     * nullptr if an edge refers to a missing node, the edges form a cycle, or
+     * no edge reaches graphIO (the graph would have no output).
+     */
+    static std::unique_ptr<JsfxGraph> create(
+        const std::vector<SX_Instance*>& instances,
+        const std::vector<EdgeDescription>& edges,
+        int numChannels,
+        int capacitySamples
+    );
+
+    /** Message thread: whether these edges are acyclic and only refer to existing nodes. */
+    static bool isValid(int numNodes, const std::vector<EdgeDescription>& edges);
+
+    int getNumChannels() const noexcept
+    {
+        return numChannels;
+    }
+
+    /** Audio thread: latency of the slowest path from the graph input to a node. */
+    int getLatencySamples() noexcept;
+
+    /**
+     * Audio thread: run the graph on numSamples frames of block, in place, in
+     * pieces of at most the capacity the graph was created with.
+     * processNode(SX_Instance*, double* interleaved, int numChannels, int numSamples)
+     * runs one node; with a pool it's called from several threads at once.
+     */
+    template <typename ProcessNodeFn>
+    void process(double* block, int numSamples, RealtimeThreadPool* pool, ProcessNodeFn& processNode) noexcept
+    {
+        auto runNodeFn = [](void* context, SX_Instance* instance, double* interleaved, int channels, int length)
+        { (*static_cast<ProcessNodeFn*>(context))(instance, interleaved, channels, length); };
+
+        processImpl(block, numSamples, pool, runNodeFn, &processNode);
+    }
+
+private:
+    using RunNodeFunction =
+        void (*)(void* context, SX_Instance* instance, double* interleaved, int numChannels, int numSamples);
+
+    struct Edge
+    {
+        int source = graphIO;
+        RoutingPlan::ConnectionList connections;
+    };
+
+    struct Node
+    {
+        SX_Instance* instance = nullptr;
+        juce::AudioBuffer<double> buffer; // Interleaved output of this node
+        std::vector<Edge> inputs;         // In the order the edges were given
+        std::vector<int> dependents;
+        int numDependencies = 0;
+        std::atomic<int> remainingDependencies{0};
+        int pathLatency = 0; // getLatencySamples() scratch
+    };
+
+    JsfxGraph() = default;
+
+    void processImpl(
+        double* block,
+        int numSamples,
+        RealtimeThreadPool* pool,
+        RunNodeFunction runNode,
+        void* context
+    ) noexcept;
+    void processChunk(
+        double* block,
+        int numSamples,
+        RealtimeThreadPool* pool,
+        RunNodeFunction runNode,
+        void* context
+    ) noexcept;
+    void runNode(int nodeIndex, const double* block, int numSamples, RunNodeFunction function, void* context) noexcept;
+    void runReadyNodes(const double* block, int numSamples, RunNodeFunction function, void* context) noexcept;
+    void pushReady(int nodeIndex) noexcept;
+
+    const double* getEdgeSource(const Edge& edge, const double* block) const noexcept
+    {
+        return edge.source == graphIO ? block : nodes[static_cast<size_t>(edge.source)]->buffer.getReadPointer(0);
+    }
+
+    int popReady() noexcept;
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::vector<int> topologicalOrder;
+    std::vector<Edge> outputs; // Edges into graphIO, summed into the graph's output
+    juce::AudioBuffer<double> outputBuffer;
+    int numChannels = 0;
+    int capacitySamples = 0;
+
+    // Ready queue for one block: every node is pushed exactly once, so it never wraps
+    std::vector<std::atomic<int>> readySlots;
+    std::atomic<int> readyPushed{0};
+    std::atomic<int> readyPopped{0};
+    std::atomic<int> nodesCompleted{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JsfxGraph)
+};
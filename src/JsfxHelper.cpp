@@ -461,6 +461,17 @@ juce::String JsfxHelper::parseJSFXAuthor(const juce::File& jsfxFile)
     if (!stream.openedOk())
         return "Unknown";
 
+    return parseJSFXAuthor(stream);
+}
+
+juce::String JsfxHelper::parseJSFXAuthorFromSource(const juce::String& source)
+{
+    juce::MemoryInputStream stream(source.toRawUTF8(), source.getNumBytesAsUTF8(), false);
+    return parseJSFXAuthor(stream);
+}
+
+juce::String JsfxHelper::parseJSFXAuthor(juce::InputStream& stream)
+{
     // Read file line by line looking for "author:" tag
     juce::String line;
     while (!stream.isExhausted())
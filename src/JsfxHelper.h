@@ -53,6 +53,9 @@ public:
     // Parse author tag from JSFX file
     static juce::String parseJSFXAuthor(const juce::File& jsfxFile);
 
+    // Parse author tag from JSFX source already in memory
+    static juce::String parseJSFXAuthorFromSource(const juce::String& source);
+
 protected:
     // Initialize JSFX system for this instance
     void initializeJsfxSystem();
@@ -76,4 +79,6 @@ private:
     // Initialize/cleanup shared resources (window classes, etc.)
     static void initializeSharedResources();
     static void cleanupSharedResources();
+
+    static juce::String parseJSFXAuthor(juce::InputStream& stream);
 };
\ No newline at end of file
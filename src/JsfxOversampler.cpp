@@ -0,0 +1,74 @@
+#include "JsfxOversampler.h"
+#include "InterleaveKernels.h"
+
+#include <Config.h>
+#include <cmath>
+
+JsfxOversampler::JsfxOversampler(int channels, int oversamplingFactor, int maxBlock, bool linearPhase)
+    : numChannels(channels)
+    , factor(oversamplingFactor)
+    , maxBlockSize(maxBlock)
+    , oversampling(
+          static_cast<size_t>(channels),
+          static_cast<size_t>(juce::roundToInt(std::log2(oversamplingFactor))),
+          linearPhase ? juce::dsp::Oversampling<double>::filterHalfBandFIREquiripple
+                      : juce::dsp::Oversampling<double>::filterHalfBandPolyphaseIIR,
+          true,
+          true // Integer latency, so it can be reported to the host exactly
+      )
+{
+    jassert(isValidFactor(oversamplingFactor));
+
+    oversampling.initProcessing(static_cast<size_t>(maxBlockSize));
+    latencySamples = juce::roundToInt(oversampling.getLatencyInSamples());
+
+    planar.setSize(numChannels, maxBlockSize);
+    oversampled.setSize(1, maxBlockSize * factor * numChannels);
+}
+
+void JsfxOversampler::reset() noexcept
+{
+    oversampling.reset();
+}
+
+double* JsfxOversampler::upsample(const double* interleaved, int numSamples) noexcept
+{
+    jassert(numSamples <= maxBlockSize);
+
+    auto* const* planarChannels = planar.getArrayOfWritePointers();
+    InterleaveKernels::deinterleave(interleaved, numChannels, planarChannels, numChannels, numSamples);
+
+    juce::dsp::AudioBlock<double> block(
+        planarChannels,
+        static_cast<size_t>(numChannels),
+        static_cast<size_t>(numSamples)
+    );
+    oversampledBlock = oversampling.processSamplesUp(block);
+
+    double* output = oversampled.getWritePointer(0);
+    const double* channels[PluginConstants::JsfxMaxChannels];
+    for (int channel = 0; channel < numChannels; ++channel)
+        channels[channel] = oversampledBlock.getChannelPointer(static_cast<size_t>(channel));
+
+    InterleaveKernels::interleave(channels, numChannels, output, numChannels, numSamples * factor);
+    return output;
+}
+
+void JsfxOversampler::downsample(double* interleaved, int numSamples) noexcept
+{
+    double* channels[PluginConstants::JsfxMaxChannels];
+    for (int channel = 0; channel < numChannels; ++channel)
+        channels[channel] = oversampledBlock.getChannelPointer(static_cast<size_t>(channel));
+
+    const double* source = oversampled.getReadPointer(0);
+    InterleaveKernels::deinterleave(source, numChannels, channels, numChannels, numSamples * factor);
+
+    juce::dsp::AudioBlock<double> block(
+        planar.getArrayOfWritePointers(),
+        static_cast<size_t>(numChannels),
+        static_cast<size_t>(numSamples)
+    );
+    oversampling.processSamplesDown(block);
+
+    InterleaveKernels::interleave(planar.getArrayOfReadPointers(), numChannels, interleaved, numChannels, numSamples);
+}
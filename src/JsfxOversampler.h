@@ -0,0 +1,69 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+//==============================================================================
+/**
+ * Oversampling around sx_processSamples: takes the interleaved JSFX buffer up
+ * to factor times the host rate and back, using juce::dsp::Oversampling's
+ * polyphase half-band filters.
+ *
+ * upsample() returns an interleaved buffer of numSamples * factor frames for
+ * the JSFX to process in place; downsample() filters it back down into the
+ * original buffer. Everything is allocated in the constructor, so both calls
+ * are realtime safe for up to maxBlockSize host samples.
+ */
+class JsfxOversampler
+{
+public:
+    /** Message thread. factor must be 2, 4 or 8; linear phase uses FIR filters, otherwise IIR. */
+    JsfxOversampler(int numChannels, int factor, int maxBlockSize, bool linearPhase);
+
+    int getFactor() const noexcept
+    {
+        return factor;
+    }
+
+    int getNumChannels() const noexcept
+    {
+        return numChannels;
+    }
+
+    int getMaxBlockSize() const noexcept
+    {
+        return maxBlockSize;
+    }
+
+    /** Filter latency at the host rate, in samples. */
+    int getLatencySamples() const noexcept
+    {
+        return latencySamples;
+    }
+
+    /** Clear the filter state (audio thread). */
+    void reset() noexcept;
+
+    /** Upsample numSamples interleaved frames; returns the oversampled interleaved buffer. */
+    double* upsample(const double* interleaved, int numSamples) noexcept;
+
+    /** Downsample the buffer returned by the last upsample() back into interleaved. */
+    void downsample(double* interleaved, int numSamples) noexcept;
+
+    static bool isValidFactor(int factor) noexcept
+    {
+        return factor == 2 || factor == 4 || factor == 8;
+    }
+
+private:
+    int numChannels = 0;
+    int factor = 1;
+    int maxBlockSize = 0;
+    int latencySamples = 0;
+
+    juce::dsp::Oversampling<double> oversampling;
+    juce::AudioBuffer<double> planar;      // Host-rate channels
+    juce::AudioBuffer<double> oversampled; // Interleaved, at the oversampled rate
+    juce::dsp::AudioBlock<double> oversampledBlock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JsfxOversampler)
+};
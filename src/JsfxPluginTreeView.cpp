@@ -469,10 +469,18 @@ void JsfxPluginTreeView::loadPlugin(const juce::File& pluginFile)
         return;
     }
 
-    bool success = processor.loadJSFX(pluginFile);
+    // Compiled in the background; the callback fires once the new effect is live
+    processor.loadJSFXAsync(
+        pluginFile,
+        [safeThis = juce::Component::SafePointer<JsfxPluginTreeView>(this), pluginFile](bool success)
+        {
+            if (safeThis == nullptr || safeThis->isDestroyed)
+                return;
 
-    if (onPluginLoadedCallback)
-        onPluginLoadedCallback(pluginFile.getFullPathName(), success);
+            if (safeThis->onPluginLoadedCallback)
+                safeThis->onPluginLoadedCallback(pluginFile.getFullPathName(), success);
+        }
+    );
 }
 
 void JsfxPluginTreeView::loadRemotePlugin(const ReaPackIndexParser::JsfxEntry& entry, bool loadAfterDownload)
@@ -0,0 +1,60 @@
+#include "JsfxSplitGroup.h"
+
+#include <Config.h>
+
+std::vector<int> JsfxSplitGroup::computeSliceSizes(SplitMode mode, const juce::String& customGroups, int numChannels)
+{
+    std::vector<int> sizes;
+
+    switch (mode)
+    {
+    case SplitMode::Off:
+        return sizes;
+
+    case SplitMode::Mono:
+        sizes.assign(static_cast<size_t>(numChannels), 1);
+        break;
+
+    case SplitMode::Stereo:
+        for (int channel = 0; channel < numChannels; channel += 2)
+            sizes.push_back(juce::jmin(2, numChannels - channel));
+        break;
+
+    case SplitMode::Custom:
+    {
+        auto tokens = juce::StringArray::fromTokens(customGroups, ", ", {});
+        tokens.removeEmptyStrings();
+
+        int assigned = 0;
+        for (const auto& token : tokens)
+        {
+            const int size = juce::jmin(token.getIntValue(), numChannels - assigned);
+            if (size <= 0)
+                continue;
+
+            sizes.push_back(size);
+            assigned += size;
+        }
+
+        if (assigned < numChannels)
+            sizes.push_back(numChannels - assigned);
+        break;
+    }
+    }
+
+    // Beyond the limit, the last copy takes the remaining channels
+    if (static_cast<int>(sizes.size()) > PluginConstants::MaxSplitInstances)
+    {
+        int remaining = 0;
+        for (size_t i = PluginConstants::MaxSplitInstances - 1; i < sizes.size(); ++i)
+            remaining += sizes[i];
+
+        sizes.resize(PluginConstants::MaxSplitInstances);
+        sizes.back() = remaining;
+    }
+
+    if (sizes.size() < 2)
+        sizes.clear();
+
+    return sizes;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <jsfx.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <vector>
+
+//==============================================================================
+/** How the JSFX channels are divided between linked copies of the effect. */
+enum class SplitMode
+{
+    Off,    // One instance processes every channel
+    Mono,   // One instance per channel
+    Stereo, // One instance per channel pair
+    Custom  // Channel counts per instance, e.g. "2,2,4"
+};
+
+//==============================================================================
+/**
+ * Linked-split: copies of one JSFX that each process a slice of the channels,
+ * run in parallel on the realtime thread pool.
+ *
+ * Slice 0 is processed by the running instance itself (the owner); every other
+ * slice has a copy of its own, compiled from the same file with the owner's
+ * state. Parameter changes are mirrored to the copies. A group is built on a
+ * worker thread and handed to the audio thread, which only uses it while its
+ * owner is the running instance.
+ */
+struct JsfxSplitGroup
+{
+    struct Slice
+    {
+        int firstChannel = 0;
+        int numChannels = 0;
+        SX_Instance* instance = nullptr;  // Owner for slice 0, otherwise a copy owned by the group
+        juce::AudioBuffer<double> buffer; // Interleaved scratch for this slice's channels
+    };
+
+    SX_Instance* owner = nullptr;
+    int numChannels = 0;     // JSFX channel count the slices were made for
+    int capacitySamples = 0; // Longest run of samples a slice buffer holds
+    std::vector<Slice> slices;
+    std::vector<SX_Instance*> copies; // Instances of slices 1.., for parameter and preset mirroring
+    bool parametersMirrored = false;  // Audio thread: copies caught up with the owner's parameters
+
+    /**
+     * Channel counts per slice for a mode. Returns fewer than two slices when
+     * splitting makes no sense (mode Off, or a single slice covering everything).
+     * Custom groups that don't cover every channel get a final slice for the rest.
+     */
+    static std::vector<int> computeSliceSizes(SplitMode mode, const juce::String& customGroups, int numChannels);
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Process-wide pool of background threads for JSFX work that must stay off both
+ * the audio thread and the message thread: compiling new instances and
+ * destroying retired ones. Also counts session restores in flight, so a host
+ * opening many instances can tell when all of them are live.
+ *
+ * Shared by every plugin instance in the process via
+ * juce::SharedResourcePointer<JsfxWorkerPool>, so the thread count stays bounded
+ * no matter how many plugins the host opens.
+ */
+struct JsfxWorkerPool
+{
+    JsfxWorkerPool()
+        : pool(juce::ThreadPoolOptions{}
+                   .withThreadName("JSFX Worker")
+                   .withNumberOfThreads(getDefaultNumThreads())
+                   .withDesiredThreadPriority(juce::Thread::Priority::low))
+    {
+    }
+
+    // Leave one core to the audio thread, but cap the pool on many-core machines
+    static int getDefaultNumThreads()
+    {
+        return juce::jlimit(1, 8, juce::SystemStats::getNumCpus() - 1);
+    }
+
+    // Session restore progress across every instance, counted as each one's restore
+    // is queued and finishes. Locked so a batch reset and the count that starts the next
+    // batch can't interleave with another instance's restore.
+    void beginRestore()
+    {
+        const juce::SpinLock::ScopedLockType lock(restoreCountLock);
+
+        // A new batch: the previous one is finished, so stop counting it
+        if (numRestoresPending++ == 0)
+            numRestoresStarted = 0;
+
+        ++numRestoresStarted;
+    }
+
+    void endRestore()
+    {
+        const juce::SpinLock::ScopedLockType lock(restoreCountLock);
+        --numRestoresPending;
+    }
+
+    // Restores live and started in the current batch, read together
+    void getRestoreProgress(int& numLive, int& numStarted) const
+    {
+        const juce::SpinLock::ScopedLockType lock(restoreCountLock);
+        numStarted = numRestoresStarted;
+        numLive = juce::jmax(0, numRestoresStarted - numRestoresPending);
+    }
+
+    juce::ThreadPool pool;
+
+    // The JSFX compiler shares global state between instances, so instance
+    // creation and destruction are serialised across the whole process
+    juce::CriticalSection instanceLifecycleLock;
+
+private:
+    mutable juce::SpinLock restoreCountLock;
+    int numRestoresPending = 0;
+    int numRestoresStarted = 0; // Since the last time none were pending
+};
@@ -0,0 +1,59 @@
+#include "MidiEventArena.h"
+
+#include <cstring>
+
+MidiEventArena::MidiEventArena()
+{
+    events.resize(MaxEvents);
+    bytes.resize(MaxBytes);
+}
+
+void MidiEventArena::clear() noexcept
+{
+    numEvents = 0;
+    numBytes = 0;
+    readPosition = 0;
+}
+
+bool MidiEventArena::add(int sampleOffset, int bus, const juce::uint8* data, int size) noexcept
+{
+    auto* destination = reserve(sampleOffset, bus, size);
+    if (destination == nullptr)
+        return false;
+
+    std::memcpy(destination, data, static_cast<size_t>(size));
+    return true;
+}
+
+juce::uint8* MidiEventArena::reserve(int sampleOffset, int bus, int size) noexcept
+{
+    if (size <= 0 || numEvents >= MaxEvents || numBytes + size > MaxBytes)
+        return nullptr;
+
+    auto& event = events[static_cast<size_t>(numEvents++)];
+    event.sampleOffset = sampleOffset;
+    event.bus = bus;
+    event.dataOffset = numBytes;
+    event.size = size;
+
+    numBytes += size;
+    return bytes.data() + event.dataOffset;
+}
+
+void MidiEventArena::fillFrom(const juce::MidiBuffer& buffer, int bus) noexcept
+{
+    clear();
+
+    for (const auto metadata : buffer)
+        if (!add(metadata.samplePosition, bus, metadata.data, metadata.numBytes))
+            break;
+}
+
+void MidiEventArena::copyTo(juce::MidiBuffer& buffer) const
+{
+    for (int i = 0; i < numEvents; ++i)
+    {
+        const auto& event = events[static_cast<size_t>(i)];
+        buffer.addEvent(getData(event), event.size, event.sampleOffset);
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <vector>
+
+/**
+ * Fixed-capacity store for one block of MIDI events, used to bridge between
+ * JUCE MidiBuffers and the JSFX midi_sendrecv callback.
+ *
+ * Events keep their sample offset within the block and their JSFX MIDI bus.
+ * Short messages and sysex are supported. Event payloads live in one
+ * preallocated byte pool, so after construction nothing here allocates; when
+ * the arena is full, further events are dropped.
+ */
+class MidiEventArena
+{
+public:
+    static constexpr int MaxEvents = 4096;
+    static constexpr int MaxBytes = 64 * 1024;
+
+    struct Event
+    {
+        int sampleOffset = 0;
+        int bus = 0;
+        int dataOffset = 0;
+        int size = 0;
+    };
+
+    MidiEventArena();
+
+    //==============================================================================
+    /** Remove all events and rewind the read cursor. */
+    void clear() noexcept;
+
+    /** Append a copy of the message. Returns false if the arena is full. */
+    bool add(int sampleOffset, int bus, const juce::uint8* data, int size) noexcept;
+
+    /**
+     * Append an event whose payload the caller writes afterwards (JSFX fills its
+     * send buffer after the callback returns). Returns nullptr if the arena is full.
+     */
+    juce::uint8* reserve(int sampleOffset, int bus, int size) noexcept;
+
+    /** Replace the contents with the events of a host buffer, all on the given bus. */
+    void fillFrom(const juce::MidiBuffer& buffer, int bus) noexcept;
+
+    /** Append every event to a host buffer (events on all buses are merged). */
+    void copyTo(juce::MidiBuffer& buffer) const;
+
+    //==============================================================================
+    int getNumEvents() const noexcept
+    {
+        return numEvents;
+    }
+
+    const Event& getEvent(int index) const noexcept
+    {
+        return events[static_cast<size_t>(index)];
+    }
+
+    const juce::uint8* getData(const Event& event) const noexcept
+    {
+        return bytes.data() + event.dataOffset;
+    }
+
+    static bool isSysEx(const juce::uint8* data, int size) noexcept
+    {
+        return size > 0 && data[0] == 0xf0;
+    }
+
+    //==============================================================================
+    /**
+     * Sequential reading for JSFX midirecv: returns the next event before endOffset,
+     * or nullptr when all of them were read. Events must have been added in time order.
+     */
+    const Event* readNext(int endOffset) noexcept
+    {
+        if (readPosition >= numEvents || events[static_cast<size_t>(readPosition)].sampleOffset >= endOffset)
+            return nullptr;
+
+        return &events[static_cast<size_t>(readPosition++)];
+    }
+
+private:
+    std::vector<Event> events;
+    std::vector<juce::uint8> bytes;
+    int numEvents = 0;
+    int numBytes = 0;
+    int readPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiEventArena)
+};
@@ -1,160 +1,362 @@
 #include "ParameterSyncManager.h"
 
+#include "ParameterUtils.h"
+
 #include <cmath>
 
 ParameterSyncManager::ParameterSyncManager()
 {
+    rampSlot.fill(-1);
 }
 
 ParameterSyncManager::~ParameterSyncManager()
 {
+    for (auto* param : apvtsParams)
+        if (param)
+            param->removeListener(this);
 }
 
-void ParameterSyncManager::initialize(
-    const std::array<juce::RangedAudioParameter*, PluginConstants::MaxParameters>& apvtsParamsIn,
-    SX_Instance* jsfxInstance,
-    int numParamsIn,
-    double sampleRate
+void ParameterSyncManager::attachToParameters(
+    const std::array<juce::RangedAudioParameter*, PluginConstants::MaxParameters>& params
 )
 {
-    apvtsParams = apvtsParamsIn;
-    numParams = numParamsIn;
-    currentSampleRate = sampleRate;
+    jassert(firstListenedIndex < 0); // Attach once
+
+    apvtsParams = params;
+    firstListenedIndex = params[0] ? params[0]->getParameterIndex() : -1;
+
+    for (int i = 0; i < PluginConstants::MaxParameters; ++i)
+    {
+        if (auto* param = apvtsParams[i])
+        {
+            // parameterValueChanged() maps processor indices back to slots by offset
+            jassert(param->getParameterIndex() == firstListenedIndex + i);
+            param->addListener(this);
+        }
+    }
+}
+
+std::unique_ptr<ParameterSyncManager::Binding>
+ParameterSyncManager::createBinding(SX_Instance* jsfxInstance, int numParams) const
+{
+    auto newBinding = std::make_unique<Binding>();
+    newBinding->instance = jsfxInstance;
+    newBinding->numParams = jsfxInstance ? juce::jlimit(0, PluginConstants::MaxParameters, numParams) : 0;
 
     // Initialize sync state from current values
-    for (int i = 0; i < numParams; ++i)
+    for (int i = 0; i < newBinding->numParams; ++i)
     {
-        if (i < static_cast<int>(apvtsParams.size()) && apvtsParams[i] && jsfxInstance)
+        if (!apvtsParams[i])
+            continue;
+
+        double minVal, maxVal, step;
+        const double jsfxValue = JesusonicAPI.sx_getParmVal(jsfxInstance, i, &minVal, &maxVal, &step);
+        const bool isContinuous =
+            ParameterUtils::detectParameterType(jsfxInstance, i) == ParameterUtils::ParameterType::Float;
+
+        newBinding->ranges[i] = {minVal, maxVal, isContinuous};
+        newBinding->apvtsValues[i] = apvtsParams[i]->getValue();
+        newBinding->jsfxValues[i] = jsfxValue;
+    }
+
+    return newBinding;
+}
+
+void ParameterSyncManager::bind(std::unique_ptr<Binding>& newBinding) noexcept
+{
+    std::swap(binding, newBinding);
+
+    scanPosition = 0;
+    clearRamps();
+
+    const int numParams = binding ? binding->numParams : 0;
+    for (int i = 0; i < PluginConstants::MaxParameters; ++i)
+    {
+        auto& state = parameterStates[i];
+        state.apvtsNeedsUpdate.store(false, std::memory_order_release);
+
+        if (i < numParams)
         {
-            // Get initial values from both sides
-            float apvtsValue = apvtsParams[i]->getValue();
-
-            double minVal, maxVal, step;
-            double jsfxValue = JesusonicAPI.sx_getParmVal(jsfxInstance, i, &minVal, &maxVal, &step);
-
-            // Store initial state (release ensures writes are visible to other threads)
-            parameterStates[i].apvtsValue.store(apvtsValue, std::memory_order_release);
-            parameterStates[i].jsfxValue.store(jsfxValue, std::memory_order_release);
-            parameterStates[i].apvtsNeedsUpdate.store(false, std::memory_order_release);
-
-            DBG("Initialized param "
-                << i
-                << " - APVTS: "
-                << juce::String(apvtsValue, 3)
-                << " JSFX: "
-                << juce::String(jsfxValue, 3));
+            state.apvtsValue.store(binding->apvtsValues[i], std::memory_order_release);
+            state.jsfxValue.store(binding->jsfxValues[i], std::memory_order_release);
+        }
+        else
+        {
+            state.apvtsValue.store(-999.0f, std::memory_order_release);
+            state.jsfxValue.store(-999999.0, std::memory_order_release);
         }
     }
+
+    // Leftover dirty marks are harmless: each sync compares against the values stored above.
+    // Queued APVTS updates came from the previous instance and are dropped with their flags.
 }
 
 void ParameterSyncManager::updateFromAudioThread(SX_Instance* jsfxInstance, int numSamples)
 {
-    if (!jsfxInstance || numParams == 0)
+    juce::ignoreUnused(numSamples);
+
+    numChangesInLastUpdate = 0;
+
+    // Skip instances the state doesn't belong to (outgoing instance during a hot-swap)
+    if (!jsfxInstance || !binding || jsfxInstance != binding->instance || binding->numParams == 0)
         return;
 
-    // Note: Audio processing is suspended during JSFX loading/unloading,
-    // so we don't need to check for parameter count mismatches here
+    const int numParams = binding->numParams;
 
-    // Check each parameter for changes
-    for (int i = 0; i < numParams; ++i)
+    // Script-side changes the slider automation callback didn't report
+    for (int n = 0; n < juce::jmin(scanParametersPerBlock, numParams); ++n)
     {
-        if (i >= static_cast<int>(apvtsParams.size()) || !apvtsParams[i])
-            continue;
+        jsfxDirty.set(scanPosition);
+        scanPosition = (scanPosition + 1) % numParams;
+    }
 
-        auto& state = parameterStates[i];
+    for (int word = 0; word < DirtyBits::numWords; ++word)
+    {
+        const auto apvtsBits = apvtsDirty.take(word);
+        const auto jsfxBits = jsfxDirty.take(word);
 
-        // Read current values
-        float currentApvtsValue = apvtsParams[i]->getValue();
+        // When both sides changed, APVTS takes precedence, so only look at JSFX where APVTS didn't move
+        forEachBit(word, jsfxBits & ~apvtsBits, [this, jsfxInstance](int i) { syncJsfxToApvts(jsfxInstance, i); });
+        forEachBit(word, apvtsBits, [this, jsfxInstance](int i) { syncApvtsToJsfx(jsfxInstance, i); });
+    }
+}
 
-        double minVal, maxVal, step;
-        double currentJsfxValue = JesusonicAPI.sx_getParmVal(jsfxInstance, i, &minVal, &maxVal, &step);
+void ParameterSyncManager::syncApvtsToJsfx(SX_Instance* jsfxInstance, int paramIndex)
+{
+    if (paramIndex >= binding->numParams || !apvtsParams[paramIndex])
+        return;
 
-        // Load stored values atomically (acquire ensures we see writes from timer thread)
-        float storedApvtsValue = state.apvtsValue.load(std::memory_order_acquire);
-        double storedJsfxValue = state.jsfxValue.load(std::memory_order_acquire);
+    auto& state = parameterStates[paramIndex];
 
-        // Check if APVTS changed (user moved UI control or host automation)
-        bool apvtsChanged = std::abs(currentApvtsValue - storedApvtsValue) > 0.0001f;
+    // Read current value and compare with what we last synced
+    float currentApvtsValue = apvtsParams[paramIndex]->getValue();
+    float storedApvtsValue = state.apvtsValue.load(std::memory_order_acquire);
 
-        // Check if JSFX changed (JSFX script modified parameter internally)
-        bool jsfxChanged = std::abs(currentJsfxValue - storedJsfxValue) > 0.0001;
+    if (std::abs(currentApvtsValue - storedApvtsValue) <= 0.0001f)
+        return;
 
-        if (apvtsChanged && jsfxChanged)
-        {
-            // Both changed - APVTS takes precedence
+    double jsfxTargetValue = normalizedToJsfx(paramIndex, currentApvtsValue);
+    state.apvtsValue.store(currentApvtsValue, std::memory_order_release);
+    ++numChangesInLastUpdate;
 
-            // Convert and set JSFX value directly (no smoothing)
-            double jsfxTargetValue = normalizedToJsfx(jsfxInstance, i, currentApvtsValue);
-            JesusonicAPI.sx_setParmVal(jsfxInstance, i, jsfxTargetValue, 0);
+    if (binding->ranges[paramIndex].isContinuous && getSmoothingBlockSize() > 0)
+    {
+        // Ramp from wherever the JSFX is now; advanceRamps() writes the values
+        const int slot = rampSlot[paramIndex];
+        const double fromValue = slot >= 0 ? rampValue[slot] : state.jsfxValue.load(std::memory_order_acquire);
+        startRamp(paramIndex, fromValue, jsfxTargetValue);
+        return;
+    }
 
-            // Update our state atomically (release makes writes visible to timer thread)
-            state.apvtsValue.store(currentApvtsValue, std::memory_order_release);
-            state.jsfxValue.store(jsfxTargetValue, std::memory_order_release);
-        }
-        else if (apvtsChanged)
-        {
-            // Only APVTS changed - set JSFX value directly (no smoothing)
-            double jsfxTargetValue = normalizedToJsfx(jsfxInstance, i, currentApvtsValue);
-            JesusonicAPI.sx_setParmVal(jsfxInstance, i, jsfxTargetValue, 0);
+    // Set JSFX value directly (no smoothing)
+    if (const int slot = rampSlot[paramIndex]; slot >= 0)
+    {
+        // Smoothing was switched off mid-ramp: end it on the new value at the next advanceRamps()
+        rampTarget[slot] = jsfxTargetValue;
+        rampSamplesRemaining[slot] = 0;
+    }
 
-            // Update our state atomically (release makes writes visible to timer thread)
-            state.apvtsValue.store(currentApvtsValue, std::memory_order_release);
-            state.jsfxValue.store(jsfxTargetValue, std::memory_order_release);
-        }
-        else if (jsfxChanged)
+    writeParameter(jsfxInstance, paramIndex, jsfxTargetValue);
+
+    // Update our state atomically (release makes writes visible to timer thread)
+    state.jsfxValue.store(jsfxTargetValue, std::memory_order_release);
+}
+
+void ParameterSyncManager::startRamp(int paramIndex, double fromValue, double toValue)
+{
+    const int rampLength =
+        juce::jmax(1, juce::roundToInt(currentSampleRate * PluginConstants::ParameterSmoothingMs / 1000.0));
+
+    int slot = rampSlot[paramIndex];
+    if (slot < 0)
+    {
+        slot = numRamps++;
+        rampSlot[paramIndex] = slot;
+        rampParam[slot] = paramIndex;
+    }
+
+    rampValue[slot] = fromValue;
+    rampTarget[slot] = toValue;
+    rampIncrement[slot] = (toValue - fromValue) / rampLength;
+    rampSamplesRemaining[slot] = rampLength;
+}
+
+void ParameterSyncManager::writeParameter(SX_Instance* jsfxInstance, int paramIndex, double value) const noexcept
+{
+    JesusonicAPI.sx_setParmVal(jsfxInstance, paramIndex, value, 0);
+
+    for (int i = 0; i < numLinkedInstances; ++i)
+        JesusonicAPI.sx_setParmVal(linkedInstances[i], paramIndex, value, 0);
+}
+
+void ParameterSyncManager::advanceRamps(SX_Instance* jsfxInstance, int numSamples) noexcept
+{
+    if (numRamps == 0 || !jsfxInstance || !binding || jsfxInstance != binding->instance)
+        return;
+
+    // Step the packed ramp values first, in a loop the compiler can vectorise
+    for (int slot = 0; slot < numRamps; ++slot)
+    {
+        const int steps = juce::jmin(numSamples, rampSamplesRemaining[slot]);
+        rampValue[slot] += rampIncrement[slot] * steps;
+        rampSamplesRemaining[slot] -= steps;
+    }
+
+    for (int slot = 0; slot < numRamps;)
+    {
+        const int paramIndex = rampParam[slot];
+        const bool finished = rampSamplesRemaining[slot] <= 0;
+        const double value = finished ? rampTarget[slot] : rampValue[slot];
+
+        writeParameter(jsfxInstance, paramIndex, value);
+
+        // Track what we wrote, so the JSFX change detection doesn't mistake the ramp for the script
+        parameterStates[paramIndex].jsfxValue.store(value, std::memory_order_release);
+
+        if (!finished)
         {
-            // Only JSFX changed - queue update for APVTS (can't modify APVTS from audio thread)
-            float normalizedValue = static_cast<float>(jsfxToNormalized(jsfxInstance, i, currentJsfxValue));
+            ++slot;
+            continue;
+        }
+
+        // Remove by moving the last ramp into this slot
+        const int last = --numRamps;
+        rampSlot[paramIndex] = -1;
 
-            // Queue the update atomically (release makes writes visible to timer thread)
-            state.pendingApvtsValue.store(normalizedValue, std::memory_order_release);
-            state.jsfxValue.store(currentJsfxValue, std::memory_order_release);
-            state.apvtsNeedsUpdate.store(true, std::memory_order_release);
+        if (slot != last)
+        {
+            rampParam[slot] = rampParam[last];
+            rampValue[slot] = rampValue[last];
+            rampTarget[slot] = rampTarget[last];
+            rampIncrement[slot] = rampIncrement[last];
+            rampSamplesRemaining[slot] = rampSamplesRemaining[last];
+            rampSlot[rampParam[slot]] = slot;
         }
     }
 }
 
-void ParameterSyncManager::pushAPVTSUpdatesFromTimer()
+void ParameterSyncManager::clearRamps() noexcept
+{
+    rampSlot.fill(-1);
+    numRamps = 0;
+}
+
+void ParameterSyncManager::syncJsfxToApvts(SX_Instance* jsfxInstance, int paramIndex)
+{
+    if (paramIndex >= binding->numParams || !apvtsParams[paramIndex])
+        return;
+
+    // The ramp overwrites the slider on every sub-block until it reaches the APVTS value
+    if (rampSlot[paramIndex] >= 0)
+        return;
+
+    auto& state = parameterStates[paramIndex];
+
+    double minVal, maxVal, step;
+    double currentJsfxValue = JesusonicAPI.sx_getParmVal(jsfxInstance, paramIndex, &minVal, &maxVal, &step);
+    double storedJsfxValue = state.jsfxValue.load(std::memory_order_acquire);
+
+    if (std::abs(currentJsfxValue - storedJsfxValue) <= 0.0001)
+        return;
+
+    // Queue update for APVTS (can't modify APVTS from audio thread)
+    float normalizedValue = static_cast<float>(jsfxToNormalized(paramIndex, currentJsfxValue));
+
+    // Queue the update atomically (release makes writes visible to timer thread)
+    state.pendingApvtsValue.store(normalizedValue, std::memory_order_release);
+    state.jsfxValue.store(currentJsfxValue, std::memory_order_release);
+    state.apvtsNeedsUpdate.store(true, std::memory_order_release);
+    apvtsPending.set(paramIndex);
+    ++numChangesInLastUpdate;
+}
+
+void ParameterSyncManager::adoptJsfxState(SX_Instance* jsfxInstance)
 {
-    // This runs on the message thread, safe to modify APVTS
+    if (!jsfxInstance || !binding || jsfxInstance != binding->instance)
+        return;
+
+    // The preset's values replace any ramp in progress
+    clearRamps();
+
+    const int numParams = binding->numParams;
     for (int i = 0; i < numParams; ++i)
     {
-        if (i >= static_cast<int>(apvtsParams.size()) || !apvtsParams[i])
+        if (!apvtsParams[i])
             continue;
 
         auto& state = parameterStates[i];
 
-        // Check if update is needed (acquire ensures we see all writes from audio thread)
-        if (state.apvtsNeedsUpdate.load(std::memory_order_acquire))
-        {
-            // Load the queued value (acquire ensures we see the value written by audio thread)
-            float pendingValue = state.pendingApvtsValue.load(std::memory_order_acquire);
+        double minVal, maxVal, step;
+        double currentJsfxValue = JesusonicAPI.sx_getParmVal(jsfxInstance, i, &minVal, &maxVal, &step);
+        float normalizedValue = static_cast<float>(jsfxToNormalized(i, currentJsfxValue));
+
+        // Record the current APVTS value as seen, so the next block doesn't treat it as a change
+        // that takes precedence over the preset
+        state.apvtsValue.store(apvtsParams[i]->getValue(), std::memory_order_release);
+        state.jsfxValue.store(currentJsfxValue, std::memory_order_release);
+        state.pendingApvtsValue.store(normalizedValue, std::memory_order_release);
+        state.apvtsNeedsUpdate.store(true, std::memory_order_release);
+    }
 
-            // Push the queued value to APVTS
-            apvtsParams[i]->setValueNotifyingHost(pendingValue);
+    apvtsPending.setAll(numParams);
+}
 
-            // Update our APVTS state tracking (release makes writes visible to audio thread)
-            state.apvtsValue.store(pendingValue, std::memory_order_release);
-            state.apvtsNeedsUpdate.store(false, std::memory_order_release);
-        }
-    }
+void ParameterSyncManager::markJsfxChanged(int paramIndex) noexcept
+{
+    if (paramIndex >= 0 && paramIndex < PluginConstants::MaxParameters)
+        jsfxDirty.set(paramIndex);
 }
 
-void ParameterSyncManager::reset()
+void ParameterSyncManager::parameterValueChanged(int parameterIndex, float newValue)
 {
-    numParams = 0;
+    const int paramIndex = parameterIndex - firstListenedIndex;
+    if (paramIndex < 0 || paramIndex >= PluginConstants::MaxParameters)
+        return;
+
+    // Our own timer pushes record the value before notifying, so they don't bounce back to the JSFX
+    const float storedApvtsValue = parameterStates[paramIndex].apvtsValue.load(std::memory_order_acquire);
+    if (std::abs(newValue - storedApvtsValue) > 0.0001f)
+        apvtsDirty.set(paramIndex);
+}
+
+void ParameterSyncManager::parameterGestureChanged(int parameterIndex, bool gestureIsStarting)
+{
+    juce::ignoreUnused(parameterIndex, gestureIsStarting);
+}
 
-    // Reset all parameter states to defaults
-    for (auto& state : parameterStates)
+void ParameterSyncManager::pushAPVTSUpdatesFromTimer()
+{
+    // This runs on the message thread, safe to modify APVTS. Only visit parameters with a queued update.
+    for (int word = 0; word < DirtyBits::numWords; ++word)
     {
-        state.apvtsValue.store(-999.0f, std::memory_order_release);
-        state.jsfxValue.store(-999999.0, std::memory_order_release);
-        state.apvtsNeedsUpdate.store(false, std::memory_order_release);
-        state.pendingApvtsValue.store(0.0f, std::memory_order_release);
+        forEachBit(
+            word,
+            apvtsPending.take(word),
+            [this](int i)
+            {
+                // Only the audio thread queues updates, and only for parameters of the bound instance
+                if (!apvtsParams[i])
+                    return;
+
+                auto& state = parameterStates[i];
+
+                // Check if update is needed (acquire ensures we see all writes from audio thread)
+                if (!state.apvtsNeedsUpdate.load(std::memory_order_acquire))
+                    return;
+
+                // Load the queued value (acquire ensures we see the value written by audio thread)
+                float pendingValue = state.pendingApvtsValue.load(std::memory_order_acquire);
+
+                // Update our APVTS state tracking first (release makes writes visible to audio thread),
+                // so the listener sees this as our own change
+                state.apvtsValue.store(pendingValue, std::memory_order_release);
+                state.apvtsNeedsUpdate.store(false, std::memory_order_release);
+
+                // Push the queued value to APVTS
+                apvtsParams[i]->setValueNotifyingHost(pendingValue);
+            }
+        );
     }
-
-    // Clear parameter references
-    apvtsParams.fill(nullptr);
 }
 
 void ParameterSyncManager::setSampleRate(double sampleRate)
@@ -162,27 +364,18 @@ void ParameterSyncManager::setSampleRate(double sampleRate)
     currentSampleRate = sampleRate;
 }
 
-double ParameterSyncManager::jsfxToNormalized(SX_Instance* instance, int paramIndex, double jsfxValue)
+double ParameterSyncManager::jsfxToNormalized(int paramIndex, double jsfxValue) const noexcept
 {
-    if (!instance)
-        return 0.0;
-
-    double minVal, maxVal, step;
-    JesusonicAPI.sx_getParmVal(instance, paramIndex, &minVal, &maxVal, &step);
+    const auto& range = binding->ranges[paramIndex];
 
-    if (maxVal > minVal)
-        return (jsfxValue - minVal) / (maxVal - minVal);
+    if (range.maxVal > range.minVal)
+        return (jsfxValue - range.minVal) / (range.maxVal - range.minVal);
 
     return 0.0;
 }
 
-double ParameterSyncManager::normalizedToJsfx(SX_Instance* instance, int paramIndex, float normalizedValue)
+double ParameterSyncManager::normalizedToJsfx(int paramIndex, float normalizedValue) const noexcept
 {
-    if (!instance)
-        return 0.0;
-
-    double minVal, maxVal, step;
-    JesusonicAPI.sx_getParmVal(instance, paramIndex, &minVal, &maxVal, &step);
-
-    return minVal + normalizedValue * (maxVal - minVal);
+    const auto& range = binding->ranges[paramIndex];
+    return range.minVal + normalizedValue * (range.maxVal - range.minVal);
 }
@@ -5,6 +5,7 @@
 #include <array>
 #include <atomic>
 #include <jsfx.h>
+#include <memory>
 #include <juce_audio_processors/juce_audio_processors.h>
 
 extern jsfxAPI JesusonicAPI;
@@ -12,30 +13,73 @@ extern jsfxAPI JesusonicAPI;
 /**
  * Two-way parameter synchronization mechanism between JUCE APVTS and JSFX.
  *
+ * Change detection is event driven: a parameter listener marks APVTS changes and
+ * the JSFX slider automation callback marks script-side changes in atomic dirty
+ * bitsets, so a block only touches the parameters that actually moved. Scripts
+ * that change sliders without slider_automate() are caught by a slow round-robin
+ * scan of a few parameters per block.
+ *
+ * APVTS changes to continuous parameters are ramped over ParameterSmoothingMs.
+ * The processor splits the block into sub-blocks of getSmoothingBlockSize()
+ * samples while ramps are active and calls advanceRamps() before each one;
+ * blocks without active ramps are processed in one piece.
+ *
+ * Each JSFX instance gets a Binding: its parameter count, ranges and starting
+ * values, captured on the message thread before the instance is visible to the
+ * audio thread. The processor hands the binding over together with the instance,
+ * and the audio thread switches to it with bind(), so the message thread never
+ * changes state the audio thread is using.
+ *
  * Thread Safety:
  * - processBlock() calls are made from audio thread (reads both, writes to temp state)
  * - Timer calls are made from message thread (writes to APVTS from temp state)
+ * - Dirty marks may come from any thread
  * - APVTS always takes precedence when both sides change simultaneously
  */
-class ParameterSyncManager
+class ParameterSyncManager : private juce::AudioProcessorParameter::Listener
 {
 public:
     ParameterSyncManager();
-    ~ParameterSyncManager();
+    ~ParameterSyncManager() override;
+
+    /**
+     * Listen to the APVTS parameters for change events (call once, after the parameters exist).
+     * The parameters must be contiguous in the processor's parameter list and outlive this object.
+     */
+    void attachToParameters(const std::array<juce::RangedAudioParameter*, PluginConstants::MaxParameters>& params);
+
+    // JSFX ranges, cached so conversions don't query the instance
+    struct CachedRange
+    {
+        double minVal = 0.0;
+        double maxVal = 1.0;
+        bool isContinuous = false; // Float parameters are smoothed; enums, booleans and integers jump
+    };
+
+    /** Everything the audio thread needs to sync one instance. Immutable once built. */
+    struct Binding
+    {
+        SX_Instance* instance = nullptr;
+        int numParams = 0;
+        std::array<CachedRange, PluginConstants::MaxParameters> ranges;
+        std::array<float, PluginConstants::MaxParameters> apvtsValues{};  // Normalized, when bound
+        std::array<double, PluginConstants::MaxParameters> jsfxValues{}; // In JSFX range, when bound
+    };
 
     /**
-     * Initialize the sync manager with parameter references
-     * @param apvtsParams Array of APVTS parameter pointers
+     * Capture the instance's ranges and the current values of both sides (message thread,
+     * before the instance is published to the audio thread).
      * @param jsfxInstance JSFX instance to sync with
      * @param numParams Number of active parameters
-     * @param sampleRate Current sample rate for smoothing
      */
-    void initialize(
-        const std::array<juce::RangedAudioParameter*, PluginConstants::MaxParameters>& apvtsParams,
-        SX_Instance* jsfxInstance,
-        int numParams,
-        double sampleRate
-    );
+    std::unique_ptr<Binding> createBinding(SX_Instance* jsfxInstance, int numParams) const;
+
+    /**
+     * Start syncing the binding's instance (audio thread, when it adopts the instance).
+     * Swaps: binding comes back holding the previous binding, for the caller to retire.
+     * Null stops syncing.
+     */
+    void bind(std::unique_ptr<Binding>& binding) noexcept;
 
     /**
      * Update sync state from audio thread (processBlock).
@@ -46,23 +90,138 @@ public:
     void updateFromAudioThread(SX_Instance* jsfxInstance, int numSamples);
 
     /**
-     * Push queued APVTS updates from timer thread (message thread).
-     * This is the only place where APVTS parameters are modified.
+     * Move every active ramp forward by numSamples and write the new values to the JSFX
+     * (audio thread, before processing the next sub-block).
+     * @param jsfxInstance Current JSFX instance
+     * @param numSamples Length of the sub-block about to be processed
      */
-    void pushAPVTSUpdatesFromTimer();
+    void advanceRamps(SX_Instance* jsfxInstance, int numSamples) noexcept;
+
+    /**
+     * Copies of the running instance that receive every value written to it (linked-split mode).
+     * Audio thread, before updateFromAudioThread(); the array must stay valid until the next call.
+     */
+    void setLinkedInstances(SX_Instance* const* instances, int numInstances) noexcept
+    {
+        linkedInstances = instances;
+        numLinkedInstances = instances != nullptr ? numInstances : 0;
+    }
+
+    /** True while any parameter is ramping towards its target (audio thread). */
+    bool hasActiveRamps() const noexcept
+    {
+        return numRamps > 0;
+    }
+
+    /** Parameters currently ramping towards their target (audio thread). */
+    int getNumActiveRamps() const noexcept
+    {
+        return numRamps;
+    }
+
+    /** Parameters that moved on either side in the last updateFromAudioThread() (audio thread). */
+    int getNumChangesInLastUpdate() const noexcept
+    {
+        return numChangesInLastUpdate;
+    }
 
     /**
-     * Reset all sync state (call when loading new JSFX)
+     * Ramp granularity in samples; smaller is smoother but runs the JSFX in more, shorter
+     * calls. 0 disables smoothing, so changes jump once per block. Any thread.
      */
-    void reset();
+    void setSmoothingBlockSize(int numSamples) noexcept
+    {
+        smoothingBlockSize.store(juce::jmax(0, numSamples), std::memory_order_relaxed);
+    }
+
+    int getSmoothingBlockSize() const noexcept
+    {
+        return smoothingBlockSize.load(std::memory_order_relaxed);
+    }
 
     /**
-     * Update sample rate for smoothing (call when sample rate changes)
+     * Take the JSFX's current values as authoritative (audio thread, after a preset load).
+     * Queues an APVTS update for every parameter, so the timer pushes the whole
+     * preset to APVTS in one pass and concurrent APVTS changes don't override it.
+     * @param jsfxInstance Instance the preset was applied to
+     */
+    void adoptJsfxState(SX_Instance* jsfxInstance);
+
+    /**
+     * Mark a parameter as changed by the JSFX (slider automation callback, any thread).
+     * @param paramIndex JSFX parameter index
+     */
+    void markJsfxChanged(int paramIndex) noexcept;
+
+    /**
+     * Push queued APVTS updates from timer thread (message thread).
+     * This is the only place where APVTS parameters are modified.
+     */
+    void pushAPVTSUpdatesFromTimer();
+
+    /**
+     * Update sample rate for smoothing (call when sample rate changes, audio stopped)
      * @param sampleRate New sample rate
      */
     void setSampleRate(double sampleRate);
 
 private:
+    //==============================================================================
+    /** Fixed-size set of parameter indices that can be marked from any thread. */
+    class DirtyBits
+    {
+    public:
+        void set(int index) noexcept
+        {
+            words[static_cast<size_t>(index >> 6)].fetch_or(juce::uint64(1) << (index & 63), std::memory_order_release);
+        }
+
+        void setAll(int numBits) noexcept
+        {
+            for (int i = 0; i < numBits; ++i)
+                set(i);
+        }
+
+        /** Takes and clears the marks of one 64-bit word. */
+        juce::uint64 take(int wordIndex) noexcept
+        {
+            return words[static_cast<size_t>(wordIndex)].exchange(0, std::memory_order_acq_rel);
+        }
+
+        void clear() noexcept
+        {
+            for (auto& word : words)
+                word.store(0, std::memory_order_release);
+        }
+
+        static constexpr int numWords = (PluginConstants::MaxParameters + 63) / 64;
+
+    private:
+        std::array<std::atomic<juce::uint64>, numWords> words{};
+    };
+
+    /** Calls fn(index) for every set bit of a word taken from DirtyBits. */
+    template <typename Fn>
+    static void forEachBit(int wordIndex, juce::uint64 bits, Fn&& fn)
+    {
+        while (bits != 0)
+        {
+            const auto lowestBit = bits & (~bits + 1);
+            fn(wordIndex * 64 + juce::countNumberOfBits(lowestBit - 1));
+            bits &= ~lowestBit;
+        }
+    }
+
+    //==============================================================================
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
+
+    void syncJsfxToApvts(SX_Instance* jsfxInstance, int paramIndex);
+    void syncApvtsToJsfx(SX_Instance* jsfxInstance, int paramIndex);
+    void startRamp(int paramIndex, double fromValue, double toValue);
+    void writeParameter(SX_Instance* jsfxInstance, int paramIndex, double value) const noexcept;
+    void clearRamps() noexcept;
+
     struct ParameterState
     {
         // Last known values from each side (accessed from both threads)
@@ -77,16 +236,46 @@ private:
     // Sync state for each parameter
     std::array<ParameterState, PluginConstants::MaxParameters> parameterStates;
 
-    // References to APVTS parameters (for timer thread updates)
-    std::array<juce::RangedAudioParameter*, PluginConstants::MaxParameters> apvtsParams;
+    // APVTS parameters we sync and listen to, and the processor index of the first one.
+    // Set once by attachToParameters(), read-only afterwards.
+    std::array<juce::RangedAudioParameter*, PluginConstants::MaxParameters> apvtsParams{};
+    int firstListenedIndex = -1;
 
-    // Number of active parameters
-    int numParams = 0;
+    // The bound instance (audio thread); null while nothing is synced
+    std::unique_ptr<Binding> binding;
+
+    DirtyBits apvtsDirty;   // APVTS changed, JSFX needs the value
+    DirtyBits jsfxDirty;    // JSFX reported a change, APVTS may need the value
+    DirtyBits apvtsPending; // Queued APVTS updates for the timer
+
+    // Active ramps, packed so a sub-block only visits the parameters that are moving (audio thread).
+    // rampSlot maps a parameter index to its position in the packed arrays, or -1.
+    std::array<int, PluginConstants::MaxParameters> rampSlot;
+    std::array<int, PluginConstants::MaxParameters> rampParam{};
+    std::array<double, PluginConstants::MaxParameters> rampValue{};
+    std::array<double, PluginConstants::MaxParameters> rampTarget{};
+    std::array<double, PluginConstants::MaxParameters> rampIncrement{};
+    std::array<int, PluginConstants::MaxParameters> rampSamplesRemaining{};
+    int numRamps = 0;
+
+    int numChangesInLastUpdate = 0; // Audio thread, for the xrun detector
+
+    std::atomic<int> smoothingBlockSize{PluginConstants::ParameterSmoothingBlockSize};
+
+    // Linked-split copies (audio thread)
+    SX_Instance* const* linkedInstances = nullptr;
+    int numLinkedInstances = 0;
+
+    // Round-robin fallback scan for scripts that change sliders silently (audio thread)
+    static constexpr int scanParametersPerBlock = 8;
+    int scanPosition = 0;
 
     // Current sample rate
     double currentSampleRate = 44100.0;
 
-    // Helper to convert between JSFX and normalized values
-    static double jsfxToNormalized(SX_Instance* instance, int paramIndex, double jsfxValue);
-    static double normalizedToJsfx(SX_Instance* instance, int paramIndex, float normalizedValue);
+    // Helpers to convert between JSFX and normalized values using the cached ranges
+    double jsfxToNormalized(int paramIndex, double jsfxValue) const noexcept;
+    double normalizedToJsfx(int paramIndex, float normalizedValue) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterSyncManager)
 };
@@ -6,12 +6,29 @@
 #include "PluginProcessor.h"
 #include "PresetWindow.h"
 #include "JsfxPluginWindow.h"
+#include "ProfilerComponent.h"
 
 #include <jsfx.h>
 #include <memory>
 
 extern jsfxAPI JesusonicAPI;
 
+namespace
+{
+// How often the title's session restore progress refreshes while restoring
+constexpr int restoreProgressIntervalMs = 250;
+
+// Every channel to the same channel, for graph edges added from the menu
+RoutingConfig::Matrix makeDiagonalMatrix()
+{
+    RoutingConfig::Matrix diagonal{};
+    for (int channel = 0; channel < PluginConstants::MaxChannels; ++channel)
+        diagonal[channel][channel] = true;
+
+    return diagonal;
+}
+} // namespace
+
 //==============================================================================
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(AudioPluginAudioProcessor& p)
     : AudioProcessorEditor(&p)
@@ -70,6 +87,12 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(AudioPluginAudi
     addAndMakeVisible(ioMatrixButton);
     ioMatrixButton.onClick = [this]() { toggleIOMatrix(); };
 
+    addAndMakeVisible(profilerButton);
+    profilerButton.onClick = [this]() { toggleProfiler(); };
+
+    addAndMakeVisible(processingButton);
+    processingButton.onClick = [this]() { showProcessingMenu(); };
+
     addAndMakeVisible(aboutButton);
     aboutButton.onClick = [this]() { showAboutWindow(); };
 
@@ -176,7 +199,7 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(AudioPluginAudi
     addAndMakeVisible(titleLabel);
     titleLabel.setJustificationType(juce::Justification::centred);
     titleLabel.setFont(juce::FontOptions(18.0f).withStyle("Bold"));
-    titleLabel.setText("No JSFX loaded", juce::dontSendNotification);
+    updateTitleLabel();
 
     addAndMakeVisible(presetLabel);
     presetLabel.setJustificationType(juce::Justification::centred);
@@ -208,6 +231,11 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(AudioPluginAudi
     // Listen to preset cache updates
     processorRef.getPresetCache().onCacheUpdated = [this]() { updatePresetList(); };
 
+    // A restored JSFX compiles in the background and may go live after the editor opens
+    processorRef.onRestoreStateChanged = [this]() { onRestoreStateChanged(); };
+    if (processorRef.isRestoringJSFX())
+        startTimer(restoreProgressIntervalMs);
+
     // If JSFX is already loaded at startup (from setStateInformation), prepare UI
     if (processorRef.getSXInstancePtr() != nullptr)
     {
@@ -248,6 +276,7 @@ AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor()
 {
     // Clear preset cache callback
     processorRef.getPresetCache().onCacheUpdated = nullptr;
+    processorRef.onRestoreStateChanged = nullptr;
 
     // Ensure native JSFX UI is torn down before editor destruction
     destroyJsfxUI();
@@ -477,12 +506,54 @@ void AudioPluginAudioProcessorEditor::onJsfxLoaded()
     );
 }
 
+void AudioPluginAudioProcessorEditor::onRestoreStateChanged()
+{
+    if (processorRef.isRestoringJSFX())
+        startTimer(restoreProgressIntervalMs);
+    else
+        stopTimer();
+
+    if (processorRef.getSXInstancePtr() != nullptr)
+    {
+        onJsfxLoaded();
+        return;
+    }
+
+    // Still compiling, or failed: nothing is loaded, as after an unload
+    destroyJsfxUI();
+    rebuildParameterSliders();
+    viewport.setVisible(true);
+    uiButton.setButtonText("UI");
+    uiButton.setEnabled(false);
+    editButton.setEnabled(false);
+    updateTitleLabel(); // "Loading ..." while compiling
+    resized();
+}
+
+void AudioPluginAudioProcessorEditor::timerCallback()
+{
+    updateTitleLabel();
+    if (!processorRef.isRestoringJSFX())
+        stopTimer();
+}
+
 //==============================================================================
 
 void AudioPluginAudioProcessorEditor::updateTitleLabel()
 {
     juce::String statusText = "No JSFX loaded";
-    if (!processorRef.getCurrentJSFXName().isEmpty())
+    if (processorRef.isRestoringJSFX())
+    {
+        statusText = "Loading " + juce::File(processorRef.getCurrentJSFXPath()).getFileNameWithoutExtension() + "...";
+
+        // Across the whole session, once more than this instance is restoring
+        int numLive = 0;
+        int numRestored = 0;
+        processorRef.getSessionRestoreProgress(numLive, numRestored);
+        if (numRestored > 1)
+            statusText << " (" << numLive << "/" << numRestored << " live)";
+    }
+    else if (!processorRef.getCurrentJSFXName().isEmpty())
         statusText = processorRef.getCurrentJSFXName();
     titleLabel.setText(statusText, juce::dontSendNotification);
 }
@@ -565,9 +636,9 @@ void AudioPluginAudioProcessorEditor::resized()
         int pluginBrowserWidth = 150; // Width for JSFX plugin browser
         int presetBrowserWidth = 150; // Width for preset browser
 
-        // Calculate minimum required width (4 buttons: Unload, Editor, I/O Matrix, About - UI button is hidden)
+        // Calculate minimum required width (6 buttons: Unload, Editor, I/O Matrix, CPU, DSP, About - UI is hidden)
         int minRequired =
-            pluginBrowserWidth + spacing + presetBrowserWidth + spacing + (buttonWidth * 4) + (spacing * 3);
+            pluginBrowserWidth + spacing + presetBrowserWidth + spacing + (buttonWidth * 6) + (spacing * 5);
 
         // If we have extra space, distribute it equally to plugin and preset browsers
         int extraSpace = juce::jmax(0, totalWidth - minRequired);
@@ -620,6 +691,12 @@ void AudioPluginAudioProcessorEditor::resized()
         ioMatrixButton.setBounds(buttonRowArea.removeFromLeft(buttonWidth));
         ioMatrixButton.setVisible(true);
         buttonRowArea.removeFromLeft(spacing);
+        profilerButton.setBounds(buttonRowArea.removeFromLeft(buttonWidth));
+        profilerButton.setVisible(true);
+        buttonRowArea.removeFromLeft(spacing);
+        processingButton.setBounds(buttonRowArea.removeFromLeft(buttonWidth));
+        processingButton.setVisible(true);
+        buttonRowArea.removeFromLeft(spacing);
         aboutButton.setBounds(buttonRowArea.removeFromLeft(buttonWidth));
         aboutButton.setVisible(true);
     }
@@ -631,6 +708,8 @@ void AudioPluginAudioProcessorEditor::resized()
         editButton.setVisible(false);
         uiButton.setVisible(false);
         ioMatrixButton.setVisible(false);
+        profilerButton.setVisible(false);
+        processingButton.setVisible(false);
         aboutButton.setVisible(false);
         presetWindow.setVisible(false);
     }
@@ -840,27 +919,30 @@ void AudioPluginAudioProcessorEditor::loadJSFXFile()
                 // Ensure any native window is closed before reloading a new JSFX
                 destroyJsfxUI();
 
-                // Suspend audio processing during JSFX loading to prevent crashes
-                processorRef.suspendProcessing(true);
-
-                bool loadSuccess = processorRef.loadJSFX(file);
-
-                // Resume audio processing after loading
-                processorRef.suspendProcessing(false);
-
-                if (loadSuccess)
-                {
-                    // Call common code path to update UI
-                    onJsfxLoaded();
-                }
-                else
-                {
-                    juce::AlertWindow::showMessageBoxAsync(
-                        juce::AlertWindow::WarningIcon,
-                        "Error",
-                        "Failed to load JSFX file: " + file.getFullPathName()
-                    );
-                }
+                // Compiles in the background; audio keeps running and crossfades to the new effect
+                processorRef.loadJSFXAsync(
+                    file,
+                    [safeThis = juce::Component::SafePointer<AudioPluginAudioProcessorEditor>(this),
+                     file](bool loadSuccess)
+                    {
+                        if (safeThis == nullptr)
+                            return;
+
+                        if (loadSuccess)
+                        {
+                            // Call common code path to update UI
+                            safeThis->onJsfxLoaded();
+                        }
+                        else
+                        {
+                            juce::AlertWindow::showMessageBoxAsync(
+                                juce::AlertWindow::WarningIcon,
+                                "Error",
+                                "Failed to load JSFX file: " + file.getFullPathName()
+                            );
+                        }
+                    }
+                );
             }
         }
     );
@@ -889,14 +971,9 @@ void AudioPluginAudioProcessorEditor::unloadJSFXFile()
                 // Ensure any native window is closed before unloading JSFX
                 destroyJsfxUI();
 
-                // Suspend audio processing during JSFX unloading to prevent crashes
-                processorRef.suspendProcessing(true);
-
+                // The audio thread fades the effect out; no need to suspend processing
                 processorRef.unloadJSFX();
 
-                // Resume audio processing after unloading
-                processorRef.suspendProcessing(false);
-
                 rebuildParameterSliders();
 
                 // Clear preset browser (PresetLoader will handle clearing APVTS)
@@ -1064,6 +1141,284 @@ void AudioPluginAudioProcessorEditor::toggleIOMatrix()
     ioMatrixButton.setButtonText("Close I/O Matrix");
 }
 
+void AudioPluginAudioProcessorEditor::toggleProfiler()
+{
+    if (profilerWindow && profilerWindow->isVisible())
+    {
+        profilerWindow->setVisible(false);
+        return;
+    }
+
+    if (!profilerWindow)
+    {
+        auto* profilerView = new ProfilerComponent(processorRef.getProfiler(), processorRef.getXrunDetector());
+        auto idealBounds = profilerView->getIdealBounds();
+
+        profilerWindow = std::make_unique<ProfilerWindow>();
+        profilerWindow->setContentOwned(profilerView, true);
+        profilerWindow->centreWithSize(idealBounds.getWidth(), idealBounds.getHeight());
+    }
+
+    profilerWindow->setVisible(true);
+    profilerWindow->toFront(true);
+}
+
+void AudioPluginAudioProcessorEditor::showProcessingMenu()
+{
+    juce::PopupMenu reblockingMenu;
+    const int currentBlockSize = processorRef.getBlockAccumulatorSize();
+    reblockingMenu.addItem(
+        "Off (host blocks)",
+        true,
+        currentBlockSize == 0,
+        [this]() { processorRef.setBlockAccumulatorSize(0); }
+    );
+    for (const int blockSize : {32, 64, 128, 256, 512})
+    {
+        reblockingMenu.addItem(
+            juce::String(blockSize) + " samples",
+            true,
+            currentBlockSize == blockSize,
+            [this, blockSize]() { processorRef.setBlockAccumulatorSize(blockSize); }
+        );
+    }
+
+    juce::PopupMenu tailMenu;
+    const double currentTail = processorRef.getUserTailLengthSeconds();
+    tailMenu.addItem(
+        "Detect from the output",
+        true,
+        currentTail < 0.0,
+        [this]() { processorRef.setTailLengthSeconds(-1.0); }
+    );
+    for (const double seconds : {0.0, 0.5, 1.0, 2.0, 5.0, 10.0})
+    {
+        tailMenu.addItem(
+            juce::String(seconds, 1) + " s",
+            true,
+            std::abs(currentTail - seconds) < 0.001,
+            [this, seconds]() { processorRef.setTailLengthSeconds(seconds); }
+        );
+    }
+
+    juce::PopupMenu splitMenu;
+    const auto currentSplit = processorRef.getSplitMode();
+    const std::pair<SplitMode, const char*> splitModes[] = {
+        {SplitMode::Off, "Off"},
+        {SplitMode::Mono, "One instance per channel"},
+        {SplitMode::Stereo, "One instance per channel pair"},
+    };
+    for (const auto& [mode, name] : splitModes)
+    {
+        splitMenu.addItem(
+            name,
+            true,
+            currentSplit == mode,
+            [this, mode = mode]() { processorRef.setSplitMode(mode); }
+        );
+    }
+    if (currentSplit == SplitMode::Custom)
+        splitMenu.addItem("Custom: " + processorRef.getSplitGroups(), false, true, nullptr);
+
+    juce::PopupMenu oversamplingMenu;
+    const int currentFactor = processorRef.getOversamplingFactor();
+    const bool linearPhase = processorRef.isOversamplingLinearPhase();
+    for (const int factor : {1, 2, 4, 8})
+    {
+        oversamplingMenu.addItem(
+            factor == 1 ? juce::String("Off") : juce::String(factor) + "x",
+            true,
+            currentFactor == factor,
+            [this, factor, linearPhase]() { processorRef.setOversampling(factor, linearPhase); }
+        );
+    }
+    oversamplingMenu.addSeparator();
+    oversamplingMenu.addItem(
+        "Linear phase filters (more latency)",
+        true,
+        linearPhase,
+        [this, currentFactor, linearPhase]() { processorRef.setOversampling(currentFactor, !linearPhase); }
+    );
+
+    juce::PopupMenu menu;
+    menu.addSubMenu("Fixed block size", reblockingMenu);
+    menu.addSubMenu("Oversampling", oversamplingMenu);
+    menu.addSubMenu("Linked split", splitMenu);
+    menu.addSubMenu("Parallel branches", createGraphMenu());
+    menu.addSubMenu("Chain", createChainMenu());
+    menu.addSeparator();
+    const bool sleepOnSilence = processorRef.isSleepOnSilenceEnabled();
+    menu.addItem(
+        "Sleep on silence",
+        true,
+        sleepOnSilence,
+        [this, sleepOnSilence]() { processorRef.setSleepOnSilence(!sleepOnSilence); }
+    );
+    menu.addSubMenu("Tail length", tailMenu);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&processingButton));
+}
+
+juce::PopupMenu AudioPluginAudioProcessorEditor::createChainMenu()
+{
+    juce::PopupMenu chainMenu;
+    const int numStages = processorRef.getNumChainStages();
+
+    chainMenu.addItem(
+        "Add stage...",
+        numStages < PluginConstants::MaxChainStages,
+        false,
+        [this]()
+        {
+            chooseEffectFile(
+                "Select a JSFX to add to the chain...",
+                [this](const juce::File& file)
+                {
+                    if (!processorRef.addChainStage(file))
+                        juce::AlertWindow::showMessageBoxAsync(
+                            juce::AlertWindow::WarningIcon,
+                            "Error",
+                            "Failed to add chain stage: " + file.getFullPathName()
+                        );
+                }
+            );
+        }
+    );
+
+    if (numStages > 0)
+        chainMenu.addSeparator();
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        juce::PopupMenu stageMenu;
+        stageMenu.addItem(
+            "Move up",
+            stage > 0,
+            false,
+            [this, stage]() { processorRef.moveChainStage(stage, stage - 1); }
+        );
+        stageMenu.addItem(
+            "Move down",
+            stage < numStages - 1,
+            false,
+            [this, stage]() { processorRef.moveChainStage(stage, stage + 1); }
+        );
+        stageMenu.addItem("Remove", [this, stage]() { processorRef.removeChainStage(stage); });
+
+        const auto name = processorRef.getChainStageFile(stage).getFileNameWithoutExtension();
+        chainMenu.addSubMenu(juce::String(stage + 1) + ". " + name, stageMenu);
+    }
+
+    chainMenu.addSeparator();
+    const bool pipelined = processorRef.isChainPipelined();
+    chainMenu.addItem(
+        "Run stages in parallel (one block of latency each)",
+        true,
+        pipelined,
+        [this, pipelined]() { processorRef.setChainPipelined(!pipelined); }
+    );
+    chainMenu.addItem("Clear chain", numStages > 0, false, [this]() { processorRef.clearChain(); });
+
+    // Stages have no MIDI callback; say so where they are added
+    chainMenu.addSeparator();
+    chainMenu.addItem("Stages process audio only: MIDI reaches the main JSFX alone", false, false, nullptr);
+
+    return chainMenu;
+}
+
+juce::PopupMenu AudioPluginAudioProcessorEditor::createGraphMenu()
+{
+    // The menu builds the simplest graph: branches fed by the graph input, summed into its output
+    juce::PopupMenu graphMenu;
+    const int numNodes = processorRef.getNumGraphNodes();
+    constexpr int graphIO = JsfxGraph::graphIO;
+
+    graphMenu.addItem(
+        "Add branch...",
+        numNodes < PluginConstants::MaxGraphNodes,
+        false,
+        [this]()
+        {
+            chooseEffectFile(
+                "Select a JSFX to run as a parallel branch...",
+                [this](const juce::File& file)
+                {
+                    const int node = processorRef.addGraphNode(file);
+                    if (node < 0)
+                    {
+                        juce::AlertWindow::showMessageBoxAsync(
+                            juce::AlertWindow::WarningIcon,
+                            "Error",
+                            "Failed to add branch: " + file.getFullPathName()
+                        );
+                        return;
+                    }
+
+                    processorRef.connectGraphNodes(graphIO, node, makeDiagonalMatrix());
+                    processorRef.connectGraphNodes(node, graphIO, makeDiagonalMatrix());
+                }
+            );
+        }
+    );
+
+    if (numNodes > 0)
+        graphMenu.addSeparator();
+
+    for (int node = 0; node < numNodes; ++node)
+    {
+        const auto name = processorRef.getGraphNodeFile(node).getFileNameWithoutExtension();
+        graphMenu.addItem("Remove " + name, [this, node]() { processorRef.removeGraphNode(node); });
+    }
+
+    graphMenu.addSeparator();
+    const bool hasDrySignal = processorRef.hasGraphConnection(graphIO, graphIO);
+    graphMenu.addItem(
+        "Mix in the dry signal",
+        numNodes > 0,
+        hasDrySignal,
+        [this, hasDrySignal]()
+        {
+            if (hasDrySignal)
+                processorRef.disconnectGraphNodes(graphIO, graphIO);
+            else
+                processorRef.connectGraphNodes(graphIO, graphIO, makeDiagonalMatrix());
+        }
+    );
+
+    const bool multithreaded = processorRef.isGraphMultithreaded();
+    graphMenu.addItem(
+        "Run branches on several cores",
+        true,
+        multithreaded,
+        [this, multithreaded]() { processorRef.setGraphMultithreaded(!multithreaded); }
+    );
+    graphMenu.addItem("Clear branches", numNodes > 0, false, [this]() { processorRef.clearGraph(); });
+
+    graphMenu.addSeparator();
+    graphMenu.addItem("Branches process audio only: MIDI reaches the main JSFX alone", false, false, nullptr);
+
+    return graphMenu;
+}
+
+void AudioPluginAudioProcessorEditor::chooseEffectFile(
+    const juce::String& description,
+    std::function<void(const juce::File&)> onChosen
+)
+{
+    auto effectChooser = std::make_unique<PersistentFileChooser>("lastJsfxDirectory", description, "*.jsfx;*.");
+
+    effectChooser->launchAsync(
+        [onChosen](const juce::File& file)
+        {
+            if (file != juce::File{})
+                onChosen(file);
+        }
+    );
+
+    // Kept alive as a member, like the chooser for the main JSFX
+    fileChooser = std::move(effectChooser);
+}
+
 void AudioPluginAudioProcessorEditor::updatePresetList()
 {
     // Trigger preset refresh - PresetWindow will load from APVTS and refresh tree
@@ -45,6 +45,37 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IOMatrixWindow)
 };
 
+//==============================================================================
+// Window for the per-stage CPU profiler; hides on close like the I/O matrix
+class ProfilerWindow : public juce::DocumentWindow
+{
+public:
+    ProfilerWindow()
+        : DocumentWindow("CPU Profiler", juce::Colour(0xff010409), juce::DocumentWindow::closeButton)
+    {
+        setResizable(true, true);
+        setResizeLimits(400, 250, 1200, 800);
+        setUsingNativeTitleBar(true);
+
+        setLookAndFeel(&sharedLookAndFeel->lf);
+    }
+
+    ~ProfilerWindow() override
+    {
+        setLookAndFeel(nullptr);
+    }
+
+    void closeButtonPressed() override
+    {
+        setVisible(false);
+    }
+
+private:
+    juce::SharedResourcePointer<SharedJuceSonicLookAndFeel> sharedLookAndFeel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProfilerWindow)
+};
+
 //==============================================================================
 class ParameterSlider : public juce::Component
 {
@@ -202,6 +233,7 @@ private:
 class AudioPluginAudioProcessorEditor final
     : public juce::AudioProcessorEditor
     , public PersistentState
+    , private juce::Timer
 {
 public:
     explicit AudioPluginAudioProcessorEditor(AudioPluginAudioProcessor&);
@@ -230,12 +262,21 @@ private:
     // Called after JSFX is loaded to update UI and restore state
     void onJsfxLoaded();
 
+    // Called when a session restore starts compiling its JSFX, and when it is live or failed
+    void onRestoreStateChanged();
+
+    // Runs only while restoring: other instances' restores don't notify this editor, so the
+    // session progress in the title is polled
+    void timerCallback() override;
+
     AudioPluginAudioProcessor& processorRef;
 
     juce::TextButton unloadButton{"Unload"};
     juce::TextButton uiButton{"UI"};
     juce::TextButton editButton{"Editor"};
     juce::TextButton ioMatrixButton{"I/O Matrix"};
+    juce::TextButton profilerButton{"CPU"};
+    juce::TextButton processingButton{"DSP"};
     juce::TextButton aboutButton{"About"};
 
     // JsfxPluginWindow embedded as component (minimal UI mode)
@@ -256,6 +297,7 @@ private:
     std::unique_ptr<JsfxLiceComponent> jsfxLiceRenderer;
 
     std::unique_ptr<IOMatrixWindow> ioMatrixWindow;
+    std::unique_ptr<ProfilerWindow> profilerWindow;
     std::unique_ptr<JsfxEditorWindow> jsfxEditorWindow;
     std::unique_ptr<JsfxLiceFullscreenWindow> jsfxLiceFullscreenWindow;
 
@@ -266,6 +308,11 @@ private:
 
     void destroyJsfxUI();
     void toggleIOMatrix();
+    void toggleProfiler();
+    void showProcessingMenu();
+    juce::PopupMenu createChainMenu();
+    juce::PopupMenu createGraphMenu();
+    void chooseEffectFile(const juce::String& description, std::function<void(const juce::File&)> onChosen);
     void toggleLiceFullscreen();
     void showAboutWindow();
     void checkForUpdatesIfNeeded();
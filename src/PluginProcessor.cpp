@@ -4,8 +4,11 @@
 #include "ParameterUtils.h"
 #include "PluginEditor.h"
 #include "FileIO.h"
+#include "InterleaveKernels.h"
+#include "RealtimeSanitizer.h"
 
 #include <algorithm>
+#include <type_traits>
 
 // LICE includes for GFX initialization
 #define EEL_LICE_STANDALONE_NOINITQUIT
@@ -23,16 +26,28 @@ extern void sx_set_midi_ctx(
 // LICE image loader initialization (ensures PNG/JPG/GIF loading works)
 extern "C" void LICE_InitializeImageLoaders();
 
-// Minimal slider automation callback used by JSFX UI when user tweaks sliders
+namespace
+{
+// Stored in pendingSplit to ask the audio thread to stop splitting. Never dereferenced.
+char noSplitRequestTag = 0;
+JsfxSplitGroup* const noSplitRequest = reinterpret_cast<JsfxSplitGroup*>(&noSplitRequestTag);
+
+char noOversamplingRequestTag = 0;
+} // namespace
+
+AudioPluginAudioProcessor::OversamplingState* const AudioPluginAudioProcessor::noOversamplingRequest =
+    reinterpret_cast<AudioPluginAudioProcessor::OversamplingState*>(&noOversamplingRequestTag);
+
+// Slider automation callback: the JSFX UI or slider_automate() in the script changed a slider.
+// May be called from the audio thread, so it only marks the parameter for the next sync.
 static void JsfxSliderAutomateThunk(void* ctx, int parmidx, bool done)
 {
     juce::ignoreUnused(done);
     auto* self = static_cast<AudioPluginAudioProcessor*>(ctx);
     if (!self)
         return;
-    // Optional: notify host/parameter system about user gesture
-    // For now keep it minimal; parameter syncing is handled elsewhere.
-    juce::ignoreUnused(parmidx);
+
+    self->markJsfxParameterChanged(parmidx);
 }
 
 //==============================================================================
@@ -92,9 +107,15 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
         parameterCache[i] = apvts.getParameter(paramID);
     }
 
+    // APVTS changes reach the JSFX through change events instead of per-block polling
+    parameterSync.attachToParameters(parameterCache);
+
     // Initialize preset loader with preset cache
     presetLoader = std::make_unique<PresetLoader>(apvts, presetCache);
 
+    // Empty routing until prepareToPlay knows the bus layout
+    routingState.store(new RoutingState(), std::memory_order_release);
+
     // Start timer for latency updates and parameter sync (30 Hz = ~33ms)
     startTimer(33);
 }
@@ -104,8 +125,21 @@ AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
     // Stop timer first to prevent any callbacks during destruction
     stopTimer();
 
+    // Queued compile jobs bail out early; wait for every job that still references us
+    isShuttingDown.store(true, std::memory_order_release);
+    while (pendingWorkerJobs.load(std::memory_order_acquire) > 0)
+        juce::Thread::sleep(1);
+
+    // Restores still waiting to publish will never report back now
+    for (int i = numPendingRestores.exchange(0, std::memory_order_acq_rel); i > 0; --i)
+        workerPool->endRestore();
+
     // Ensure all JSFX resources are cleaned up
     unloadJSFX();
+    reclaimAudioThreadInstances();
+
+    // Still published to the (stopped) audio thread; retired states go with the reclaimer
+    delete routingState.exchange(nullptr, std::memory_order_acq_rel);
 
     // Arrays don't need explicit clearing - they're automatically cleaned up
 }
@@ -114,24 +148,7 @@ AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
 void AudioPluginAudioProcessor::updateRoutingConfig(const RoutingConfig& newConfig)
 {
     // This is called from the message thread (UI)
-    // Use triple-buffer pattern for lock-free update
-
-    // Get the write buffer index
-    int writeIdx = writeIndex.load(std::memory_order_acquire);
-
-    // Write to the write buffer
-    routingConfigs[writeIdx] = newConfig;
-
-    // Swap write and spare buffer indices
-    // The spare buffer is always the one not being read or written
-    int readIdx = readIndex.load(std::memory_order_acquire);
-    int spareIdx = 3 - readIdx - writeIdx; // 0+1+2=3, so spare = 3-read-write
-
-    // Update write index to point to spare (atomic swap)
-    writeIndex.store(spareIdx, std::memory_order_release);
-
-    // Update read index to point to the buffer we just wrote (atomic swap)
-    readIndex.store(writeIdx, std::memory_order_release);
+    publishRoutingState(newConfig);
 
     // Encode and save routing configuration to APVTS for persistence
     juce::String routingStr;
@@ -159,8 +176,18 @@ void AudioPluginAudioProcessor::updateRoutingConfig(const RoutingConfig& newConf
     apvts.state.setProperty("ioMatrixRouting", routingStr, nullptr);
 }
 
+void AudioPluginAudioProcessor::publishRoutingState(const RoutingConfig& config)
+{
+    auto newState = std::make_unique<RoutingState>();
+    newState->config = config;
+    newState->plan.compile(config);
+
+    // The audio thread may still be routing with the old state until its next block
+    reclaimer.retire(routingState.exchange(newState.release(), std::memory_order_acq_rel));
+}
+
 //==============================================================================
-bool AudioPluginAudioProcessor::loadPresetFromBase64(const juce::String& base64Data)
+bool AudioPluginAudioProcessor::loadPresetFromBase64(const juce::String& base64Data, const juce::String& presetName)
 {
     if (base64Data.isEmpty())
 
@@ -187,10 +214,18 @@ bool AudioPluginAudioProcessor::loadPresetFromBase64(const juce::String& base64D
 
         return false;
 
-    // Use JSFX API to load text state
-    suspendProcessing(true); // Suspend audio processing during state load
+    setCurrentPresetName(presetName);
+
+    if (isPrepared.load(std::memory_order_acquire))
+    {
+        // The audio thread applies it at the start of its next block, and parameter sync
+        // then pushes the whole preset to APVTS in one timer pass
+        presetQueue.submit(instance, stateText.toStdString());
+        return true;
+    }
+
+    // Audio isn't running: apply directly
     JesusonicAPI.sx_loadState(instance, stateText.toRawUTF8());
-    suspendProcessing(false);
 
     // Sync APVTS parameters with the loaded state
     int numParams = JesusonicAPI.sx_getNumParms(instance);
@@ -450,7 +485,7 @@ void AudioPluginAudioProcessor::resetToDefaults()
 
             if (presetData.isNotEmpty())
             {
-                loadPresetFromBase64(presetData);
+                loadPresetFromBase64(presetData, PluginConstants::DefaultPresetName);
                 return;
             }
         }
@@ -506,16 +541,33 @@ void AudioPluginAudioProcessor::refreshPresets()
 
 void AudioPluginAudioProcessor::timerCallback()
 {
-    // Check if latency has changed and update the host
-    int latency = currentJSFXLatency.load(std::memory_order_relaxed);
-    if (latency != getLatencySamples())
-        setLatencySamples(latency);
+    collectAudioThreadResults();
 
     // Push any queued APVTS updates from JSFX parameter changes
     // This is safe to do from timer thread (message thread)
     parameterSync.pushAPVTSUpdatesFromTimer();
 }
 
+void AudioPluginAudioProcessor::collectAudioThreadResults()
+{
+    // Check if latency has changed and update the host
+    int latency = getTotalLatencySamples();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+
+    // Latency set anywhere else is picked up here too; only grows the delay, and only the prepared one
+    if (isUsingDoublePrecision())
+        bypassDelayDouble.reserve(getLatencySamples());
+    else
+        bypassDelay.reserve(getLatencySamples());
+
+    // Free presets the audio thread is done with
+    presetQueue.collectCompleted();
+
+    // Resolve deadline misses against the JSFX and preset they happened with
+    xrunDetector.collect();
+}
+
 //==============================================================================
 const juce::String AudioPluginAudioProcessor::getName() const
 {
@@ -551,7 +603,7 @@ bool AudioPluginAudioProcessor::isMidiEffect() const
 
 double AudioPluginAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return silenceGate.getReportedTailSeconds();
 }
 
 int AudioPluginAudioProcessor::getNumPrograms()
@@ -585,35 +637,47 @@ void AudioPluginAudioProcessor::changeProgramName(int index, const juce::String&
 void AudioPluginAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     // Clean up previous audio state
-    bypassDelayLine.reset();
     tempBuffer.clear();
+    fadeBuffer.clear();
 
-    // Initialize audio state for new configuration
+    // Initialize audio state for new configuration.
+    // The JSFX may run in accumulated blocks larger than the host's, so size for either.
     lastSampleRate = sampleRate;
-    tempBuffer.setSize(1, samplesPerBlock * getTotalNumInputChannels());
+    const int maxJsfxBlockSize = juce::jmax(samplesPerBlock, PluginConstants::MaxAccumulatorBlockSize);
+    tempBuffer.setSize(1, maxJsfxBlockSize * getTotalNumInputChannels());
+    fadeBuffer.setSize(1, maxJsfxBlockSize * getTotalNumInputChannels());
+
+    // The accumulator starts empty; the audio thread applies the requested block size on the next block
+    const int accumulatorChannels = juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    const int accumulatorMidiBytes = 2 * MidiEventArena::MaxBytes;
+    const int maxAccumulatorBlockSize = PluginConstants::MaxAccumulatorBlockSize;
+    if (isUsingDoublePrecision())
+        blockAccumulatorDouble.prepare(accumulatorChannels, maxAccumulatorBlockSize, accumulatorMidiBytes);
+    else
+        blockAccumulator.prepare(accumulatorChannels, maxAccumulatorBlockSize, accumulatorMidiBytes);
+    activeAccumulatorBlockSize.store(0, std::memory_order_relaxed);
+
+    // Bypass delay sized for the latency reported now; the timer grows it if the latency outgrows it.
+    // MIDI-only effects have no channels and get no delay.
+    const int bypassChannels = juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    if (isUsingDoublePrecision())
+        bypassDelayDouble.prepare(bypassChannels, samplesPerBlock, getLatencySamples());
+    else
+        bypassDelay.prepare(bypassChannels, samplesPerBlock, getLatencySamples());
 
-    // Prepare delay line for bypass (max 10 seconds of latency should be more than enough)
-    // Only prepare if we have audio channels (MIDI-only effects won't have channels)
-    int numChannels = getTotalNumInputChannels();
-    if (numChannels > 0)
-    {
-        juce::dsp::ProcessSpec spec;
-        spec.sampleRate = sampleRate;
-        spec.maximumBlockSize = samplesPerBlock;
-        spec.numChannels = static_cast<uint32_t>(numChannels);
-        bypassDelayLine.prepare(spec);
-        bypassDelayLine.setMaximumDelayInSamples(static_cast<int>(sampleRate * 10.0));
-    }
+    bypassFadeLength = juce::jmax(1, juce::roundToInt(PluginConstants::BypassCrossfadeMs * 0.001 * sampleRate));
+    bypassFadePosition = 0;
 
     // Update parameter sync manager with new sample rate
     parameterSync.setSampleRate(sampleRate);
+    silenceGate.prepare(sampleRate);
 
     // Mark that prepareToPlay has been called
     isPrepared.store(true, std::memory_order_release);
 
     // If flag is set (from setStateInformation), load the JSFX now
     // This handles case where setStateInformation was called before prepareToPlay
-    if (!sxInstance && needsForcePushApvtsToJsfx.load(std::memory_order_acquire))
+    if (!sxInstance && !isRestoringJSFX() && needsForcePushApvtsToJsfx.load(std::memory_order_acquire))
     {
         auto jsfxPath = getCurrentJSFXPath();
         if (jsfxPath.isNotEmpty())
@@ -622,7 +686,7 @@ void AudioPluginAudioProcessor::prepareToPlay(double sampleRate, int samplesPerB
             if (jsfxFile.existsAsFile())
             {
                 DBG("prepareToPlay: Loading JSFX from restored state: " + jsfxPath);
-                loadJSFX(jsfxFile);
+                restoreJSFX(jsfxFile);
                 // Note: needsForcePushApvtsToJsfx flag will be handled in processBlock
             }
             else
@@ -652,34 +716,61 @@ void AudioPluginAudioProcessor::prepareToPlay(double sampleRate, int samplesPerB
     int juceSidechains = (getBusCount(true) > 1) ? getBus(true, 1)->getNumberOfChannels() : 0;
 
     // Check if routing needs initialization (channel counts are 0)
-    bool needsInit = (routingConfigs[0].numJuceInputs == 0 || routingConfigs[0].numJuceOutputs == 0);
+    const auto& currentConfig = routingState.load(std::memory_order_acquire)->config;
+    bool needsInit = (currentConfig.numJuceInputs == 0 || currentConfig.numJuceOutputs == 0);
 
     if (needsInit)
     {
-        // Initialize all routing configs with current bus layout and diagonal (1:1) routing
-        for (int i = 0; i < 3; ++i)
-        {
-            routingConfigs[i].numJuceInputs = juceInputs;
-            routingConfigs[i].numJuceSidechains = juceSidechains;
-            routingConfigs[i].numJuceOutputs = juceOutputs;
-            routingConfigs[i].numJsfxInputs = juceInputs + juceSidechains;
-            routingConfigs[i].numJsfxSidechains = 0; // Not used in current implementation
-            routingConfigs[i].numJsfxOutputs = juceOutputs;
-            routingConfigs[i].setDiagonal();
-        }
+        // Initialize routing with current bus layout and diagonal (1:1) routing
+        RoutingConfig config;
+        config.numJuceInputs = juceInputs;
+        config.numJuceSidechains = juceSidechains;
+        config.numJuceOutputs = juceOutputs;
+        config.numJsfxInputs = juceInputs + juceSidechains;
+        config.numJsfxSidechains = 0; // Not used in current implementation
+        config.numJsfxOutputs = juceOutputs;
+        config.setDiagonal();
+        publishRoutingState(config);
 
         DBG("Routing matrix initialized with diagonal (1:1) routing: "
             << juceInputs
             << " JUCE inputs + "
             << juceSidechains
             << " sidechains -> "
-            << routingConfigs[0].numJsfxInputs
+            << config.numJsfxInputs
             << " JSFX channels -> "
-            << routingConfigs[0].numJsfxOutputs
+            << config.numJsfxOutputs
             << " JSFX outputs -> "
-            << routingConfigs[0].numJuceOutputs
+            << config.numJuceOutputs
             << " JUCE outputs");
     }
+
+    // Split and chain buffers are sized for the block size, and copies for the sample rate
+    lastSamplesPerBlock = samplesPerBlock;
+
+    std::vector<SX_Instance*> detachedInstances;
+    for (const auto& stage : chainStages)
+        detachedInstances.push_back(stage.instance);
+    for (const auto& node : graphNodes)
+        detachedInstances.push_back(node.instance);
+
+    for (auto* instance : detachedInstances)
+    {
+        JesusonicAPI.sx_extended(instance, JSFX_EXT_SET_SRATE, (void*)(intptr_t)sampleRate, nullptr);
+        JesusonicAPI.sx_updateHostNch(instance, getTotalNumInputChannels());
+    }
+
+    if (!chainStages.empty())
+        publishChain();
+    if (!graphNodes.empty())
+        publishGraph();
+
+    // Oversamplers are sized for the block size
+    if (oversamplingFactor > 1)
+        publishOversampling();
+
+    if (splitMode != SplitMode::Off)
+        rebuildSplitGroup();
 }
 
 void AudioPluginAudioProcessor::releaseResources()
@@ -687,6 +778,9 @@ void AudioPluginAudioProcessor::releaseResources()
     // Mark as not prepared when resources are released
     isPrepared.store(false, std::memory_order_release);
 
+    // The audio thread holds nothing until its next block; don't hold up reclamation meanwhile
+    reclaimer.goOffline();
+
     // Note: Don't clean up here - releaseResources is not guaranteed to be called!
     // All cleanup happens at the start of prepareToPlay() instead.
 }
@@ -730,289 +824,1481 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported(const BusesLayout& layout
     return true;
 }
 
+bool AudioPluginAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ScopedNoDenormals noDenormals;
+    processBlockWithBypass(buffer, midiMessages, false);
+}
 
-    // TODO: Add MIDI Program Change support
-    // To implement preset loading via MIDI Program Change:
-    // 1. Iterate through midiMessages before passing to JSFX
-    // 2. Check for isProgramChange() messages
-    // 3. Get program number (0-127)
-    // 4. Map program number to preset base64 data (from LibraryBrowser's ValueTree)
-    // 5. Call loadPresetFromBase64(presetData) from message thread via MessageManager::callAsync
-    //    (Never call directly from audio thread - it updates UI parameters!)
-    // Example:
-    //   for (auto metadata : midiMessages)
-    //   {
-    //       auto msg = metadata.getMessage();
-    //       if (msg.isProgramChange())
-    //       {
-    //           int programNum = msg.getProgramChangeNumber();
-    //           juce::MessageManager::callAsync([this, programNum]()
-    //           {
-    //               auto presetData = getPresetDataForProgram(programNum);
-    //               loadPresetFromBase64(presetData);
-    //           });
-    //       }
-    //   }
+void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockWithBypass(buffer, midiMessages, false);
+}
 
-    // Early return if no JSFX instance is loaded
-    if (!sxInstance)
+template <typename FloatType>
+void AudioPluginAudioProcessor::processBlockAccumulated(
+    juce::AudioBuffer<FloatType>& buffer,
+    juce::MidiBuffer& midiMessages
+)
+{
+    auto& accumulator = getBlockAccumulator<FloatType>();
+
+    // Apply a changed block size between blocks; the timer reports the new latency
+    const int requestedBlockSize = requestedAccumulatorBlockSize.load(std::memory_order_relaxed);
+    if (requestedBlockSize != accumulator.getBlockSize())
     {
-        // Clear buffers and return - can't process without JSFX
-        buffer.clear();
-        midiMessages.clear();
-        return;
+        accumulator.setBlockSize(requestedBlockSize);
+        activeAccumulatorBlockSize.store(accumulator.getBlockSize(), std::memory_order_relaxed);
     }
 
-    // If we need to force push APVTS to JSFX (after state restoration), do it now
-    if (needsForcePushApvtsToJsfx.load(std::memory_order_acquire))
-    {
-        DBG("processBlock: Force pushing APVTS to JSFX after state restoration");
+    // Passes the host block straight through when the accumulator is off
+    accumulator.process(
+        buffer,
+        midiMessages,
+        [this](juce::AudioBuffer<FloatType>& block, juce::MidiBuffer& blockMidi)
+        { processBlockInternal(block, blockMidi); }
+    );
+}
 
-        for (int i = 0; i < numActiveParams; ++i)
-        {
-            if (i < static_cast<int>(parameterCache.size()) && parameterCache[i])
-            {
-                float normalizedValue = parameterCache[i]->getValue();
-                double actualValue = ParameterUtils::normalizedToActualValue(sxInstance, i, normalizedValue);
-                JesusonicAPI.sx_setParmVal(sxInstance, i, actualValue, 0);
-            }
-        }
+int AudioPluginAudioProcessor::getTotalLatencySamples() const
+{
+    return currentJSFXLatency.load(std::memory_order_relaxed)
+         + currentGraphLatency.load(std::memory_order_relaxed)
+         + currentChainLatency.load(std::memory_order_relaxed)
+         + activeAccumulatorBlockSize.load(std::memory_order_relaxed);
+}
 
-        needsForcePushApvtsToJsfx.store(false, std::memory_order_release);
-        DBG("processBlock: Finished force push and cleared flag");
-    }
+void AudioPluginAudioProcessor::setSleepOnSilence(bool shouldSleep)
+{
+    silenceGate.setEnabled(shouldSleep);
+    apvts.state.setProperty(sleepOnSilenceID, shouldSleep, nullptr);
+}
 
-    // Setup MIDI routing: input from host, output accumulator
-    currentMidiInputBuffer = &midiMessages;
-    midiInputIterator = std::make_unique<juce::MidiBuffer::Iterator>(midiMessages); // Initialize iterator at start
-    currentMidiOutputBuffer.clear();
+void AudioPluginAudioProcessor::setTailLengthSeconds(double seconds)
+{
+    silenceGate.setTailSeconds(seconds);
+    apvts.state.setProperty(tailLengthSecondsID, silenceGate.getTailSeconds(), nullptr);
+}
 
-    int numSamples = buffer.getNumSamples();
-    int mainChannels = buffer.getNumChannels();
+void AudioPluginAudioProcessor::setBlockAccumulatorSize(int numSamples)
+{
+    // Below 16 samples there's nothing to gain over running the host block directly
+    const int blockSize = numSamples < 16 ? 0 : juce::jmin(numSamples, PluginConstants::MaxAccumulatorBlockSize);
 
-    // Get sidechain buffer if available (bus index 1)
-    // Check if sidechain bus exists first to avoid assertion
-    bool hasSidechainBus = (getBusCount(true) > 1);
-    auto sidechainBuffer = hasSidechainBus ? getBusBuffer(buffer, true, 1) : juce::AudioBuffer<float>();
-    int sidechainChannels = sidechainBuffer.getNumChannels();
+    requestedAccumulatorBlockSize.store(blockSize, std::memory_order_relaxed);
+    apvts.state.setProperty(blockAccumulatorSizeID, blockSize, nullptr);
+}
 
-    // Total channels to send to JSFX (main + sidechain, capped at JSFX max)
-    // For MIDI instruments with 0 inputs, use the output channel count instead
-    int inputChannelCount = mainChannels + sidechainChannels;
-    if (inputChannelCount == 0 && getBusCount(false) > 0)
-    {
-        // MIDI instrument - use output bus channel count
-        inputChannelCount = getBus(false, 0)->getNumberOfChannels();
-    }
-    int totalJsfxChannels = juce::jmin(inputChannelCount, PluginConstants::JsfxMaxChannels);
+void AudioPluginAudioProcessor::setSplitMode(SplitMode mode, const juce::String& customGroups)
+{
+    splitMode = mode;
+    splitGroups = customGroups;
+    apvts.state.setProperty(splitModeID, static_cast<int>(mode), nullptr);
+    apvts.state.setProperty(splitGroupsID, customGroups, nullptr);
 
-    // Allocate temp buffer for interleaved audio: [main inputs][sidechain inputs]
-    tempBuffer.setSize(1, numSamples * totalJsfxChannels, false, false, true);
-    auto* tempPtr = tempBuffer.getWritePointer(0);
+    rebuildSplitGroup();
+}
 
-    // Get current routing configuration (lock-free read)
-    int routingIdx = readIndex.load(std::memory_order_acquire);
-    const auto& routing = routingConfigs[routingIdx];
+void AudioPluginAudioProcessor::setOversampling(int factor, bool linearPhase)
+{
+    oversamplingFactor = JsfxOversampler::isValidFactor(factor) ? factor : 1;
+    oversamplingLinearPhase = linearPhase;
+    apvts.state.setProperty(oversamplingFactorID, oversamplingFactor, nullptr);
+    apvts.state.setProperty(oversamplingLinearPhaseID, linearPhase, nullptr);
 
-    // Clear temp buffer first
-    std::fill(tempPtr, tempPtr + numSamples * totalJsfxChannels, 0.0);
+    publishOversampling();
 
-    // Apply INPUT routing matrix: JUCE inputs -> JSFX channels
-    for (int sample = 0; sample < numSamples; ++sample)
-    {
-        for (int juceIn = 0; juceIn < mainChannels && juceIn < routing.numJuceInputs; ++juceIn)
-        {
-            float inputSample = buffer.getReadPointer(juceIn)[sample];
+    // Split copies are compiled at the JSFX rate
+    if (splitMode != SplitMode::Off)
+        rebuildSplitGroup();
+}
 
-            for (int jsfxCh = 0; jsfxCh < totalJsfxChannels && jsfxCh < routing.numJsfxInputs; ++jsfxCh)
-                if (routing.inputRouting[juceIn][jsfxCh])
-                    tempPtr[sample * totalJsfxChannels + jsfxCh] += inputSample;
-        }
-    }
+void AudioPluginAudioProcessor::publishOversampling()
+{
+    OversamplingState* state = noOversamplingRequest;
+    oversamplingLatency = 0;
 
-    // Apply SIDECHAIN routing matrix: JUCE sidechain -> JSFX channels
-    for (int sample = 0; sample < numSamples; ++sample)
+    if (oversamplingFactor > 1 && getTotalNumInputChannels() > 0)
     {
-        for (int juceSc = 0; juceSc < sidechainChannels && juceSc < routing.numJuceSidechains; ++juceSc)
-        {
-            float scSample = sidechainBuffer.getReadPointer(juceSc)[sample];
-
-            for (int jsfxCh = 0; jsfxCh < totalJsfxChannels && jsfxCh < routing.numJsfxSidechains; ++jsfxCh)
-                if (routing.sidechainRouting[juceSc][jsfxCh])
-                    tempPtr[sample * totalJsfxChannels + jsfxCh] += scSample;
-        }
+        const int numChannels = getTotalNumInputChannels();
+        const int maxBlockSize = juce::jmax(lastSamplesPerBlock, PluginConstants::MaxAccumulatorBlockSize);
+
+        state = new OversamplingState();
+        state->main =
+            std::make_unique<JsfxOversampler>(numChannels, oversamplingFactor, maxBlockSize, oversamplingLinearPhase);
+        state->fading =
+            std::make_unique<JsfxOversampler>(numChannels, oversamplingFactor, maxBlockSize, oversamplingLinearPhase);
+        oversamplingLatency = state->main->getLatencySamples();
     }
 
-    // Two-way parameter synchronization between APVTS and JSFX
-    // This handles:
-    // - APVTS -> JSFX (user moves UI slider or host automation)
-    // - JSFX -> APVTS (JSFX script changes parameter internally)
-    // - Conflict resolution (APVTS takes precedence)
-    parameterSync.updateFromAudioThread(sxInstance, numSamples);
-
-    // Get transport info from host
-    double tempo = 120.0;
-    int timeSigNumerator = 4;
-    int timeSigDenominator = 4;
-    double playState = 1.0; // 0=stopped, 1=playing, 5=recording
-    double playPositionSeconds = 0.0;
-    double playPositionBeats = 0.0;
+    // A state the audio thread never picked up is still ours to free
+    auto* superseded = pendingOversampling.exchange(state, std::memory_order_acq_rel);
+    if (superseded && superseded != noOversamplingRequest)
+        reclaimer.retire(superseded);
 
-    if (auto* ph = getPlayHead())
-    {
-        if (auto posInfo = ph->getPosition())
-        {
-            if (auto bpm = posInfo->getBpm())
-                tempo = *bpm;
+    // The JSFX reports its latency at its own rate; the timer picks up later changes
+    const int jsfxLatency = sxInstance ? JesusonicAPI.sx_getCurrentLatency(sxInstance) : 0;
+    currentJSFXLatency.store(jsfxLatency / oversamplingFactor + oversamplingLatency, std::memory_order_relaxed);
+    setLatencySamples(getTotalLatencySamples());
+}
 
-            if (auto timeSig = posInfo->getTimeSignature())
-            {
-                timeSigNumerator = timeSig->numerator;
-                timeSigDenominator = timeSig->denominator;
-            }
+//==============================================================================
+bool AudioPluginAudioProcessor::addChainStage(const juce::File& jsfxFile)
+{
+    if (!appendChainStage(jsfxFile))
+        return false;
 
-            if (auto ppqPos = posInfo->getPpqPosition())
-                playPositionBeats = *ppqPos;
+    publishChain();
+    storeChainInState();
+    return true;
+}
 
-            if (auto timeInSeconds = posInfo->getTimeInSeconds())
-                playPositionSeconds = *timeInSeconds;
+void AudioPluginAudioProcessor::removeChainStage(int index)
+{
+    if (!juce::isPositiveAndBelow(index, getNumChainStages()))
+        return;
 
-            // Determine play state
-            playState = 0.0; // stopped
-            if (posInfo->getIsPlaying())
-                playState = 1.0; // playing
-            if (posInfo->getIsRecording())
-                playState = 5.0; // recording (1 | 4)
-        }
-    }
+    auto* instance = chainStages[static_cast<size_t>(index)].instance;
+    chainStages.erase(chainStages.begin() + index);
 
-    JesusonicAPI.sx_processSamples(
-        sxInstance,
-        tempBuffer.getWritePointer(0),
-        buffer.getNumSamples(),
-        totalJsfxChannels,            // Use total JSFX channels including sidechain
-        (int)(getSampleRate() + 0.5), // Cast to int, matching vstframe.cpp
-        tempo,
-        timeSigNumerator,
-        timeSigDenominator,
-        playState,
-        playPositionSeconds,
-        playPositionBeats,
-        1.0, // lastWet (always 100% wet)
-        1.0, // currentWet (always 100% wet)
-        0
-    );
+    // Published first, so the audio thread is past the stage by the time it's destroyed
+    publishChain();
+    retireInstance(instance);
+    storeChainInState();
+}
 
-    // Update latency atomically for the timer to read (some JSFX can have dynamic latency)
-    currentJSFXLatency.store(JesusonicAPI.sx_getCurrentLatency(sxInstance), std::memory_order_relaxed);
+void AudioPluginAudioProcessor::moveChainStage(int fromIndex, int toIndex)
+{
+    const int numStages = getNumChainStages();
+    if (!juce::isPositiveAndBelow(fromIndex, numStages) || !juce::isPositiveAndBelow(toIndex, numStages))
+        return;
 
-    // Apply OUTPUT routing matrix: JSFX channels -> JUCE outputs
-    // Clear output buffer first
-    buffer.clear();
+    const auto stage = chainStages[static_cast<size_t>(fromIndex)];
+    chainStages.erase(chainStages.begin() + fromIndex);
+    chainStages.insert(chainStages.begin() + toIndex, stage);
 
-    for (int sample = 0; sample < numSamples; ++sample)
-    {
-        for (int jsfxOut = 0; jsfxOut < totalJsfxChannels && jsfxOut < routing.numJsfxOutputs; ++jsfxOut)
-        {
-            float jsfxSample = tempPtr[sample * totalJsfxChannels + jsfxOut];
+    publishChain();
+    storeChainInState();
+}
 
-            for (int juceOut = 0; juceOut < mainChannels && juceOut < routing.numJuceOutputs; ++juceOut)
-                if (routing.outputRouting[jsfxOut][juceOut])
-                    buffer.getWritePointer(juceOut)[sample] += jsfxSample;
-        }
-    }
+void AudioPluginAudioProcessor::clearChain()
+{
+    auto removed = std::move(chainStages);
+    chainStages.clear();
 
-    // Transfer MIDI output from JSFX back to host
-    midiMessages.clear();
-    midiMessages.addEvents(currentMidiOutputBuffer, 0, numSamples, 0);
+    publishChain();
+    for (auto& stage : removed)
+        retireInstance(stage.instance);
 
-    // Clear MIDI input pointer to prevent dangling reference
-    currentMidiInputBuffer = nullptr;
+    storeChainInState();
 }
 
-void AudioPluginAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+juce::File AudioPluginAudioProcessor::getChainStageFile(int index) const
 {
-    juce::ignoreUnused(midiMessages);
-
-    // Introduce the same latency as the JSFX plugin to maintain timing alignment
-    // Only apply delay if we have audio channels and latency is configured
-    int latencySamples = getLatencySamples();
-    if (latencySamples > 0 && buffer.getNumChannels() > 0)
-    {
-        bypassDelayLine.setDelay(static_cast<float>(latencySamples));
+    if (!juce::isPositiveAndBelow(index, getNumChainStages()))
+        return {};
 
-        // Process each channel through the delay line
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-        {
-            auto* channelData = buffer.getWritePointer(channel);
-            juce::dsp::AudioBlock<float> block(&channelData, 1, buffer.getNumSamples());
-            juce::dsp::ProcessContextReplacing<float> context(block);
-            bypassDelayLine.process(context);
-        }
-    }
-    // If no latency or no audio channels, just pass through unchanged (MIDI will pass through automatically)
+    return chainStages[static_cast<size_t>(index)].file;
 }
 
-//==============================================================================
-bool AudioPluginAudioProcessor::hasEditor() const
+void AudioPluginAudioProcessor::setChainPipelined(bool shouldPipeline)
 {
-    return true; // (change this to false if you choose to not supply an editor)
+    chainPipelined = shouldPipeline;
+    apvts.state.setProperty(chainPipelinedID, shouldPipeline, nullptr);
+    publishChain();
 }
 
-juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor()
+bool AudioPluginAudioProcessor::appendChainStage(const juce::File& jsfxFile)
 {
-    return new AudioPluginAudioProcessorEditor(*this);
+    if (getNumChainStages() >= PluginConstants::MaxChainStages)
+        return false;
+
+    auto stage = compileDetachedEffect(jsfxFile, {}, lastSampleRate, getTotalNumInputChannels());
+    if (!stage.instance)
+        return false;
+
+    chainStages.push_back(stage);
+    return true;
 }
 
-//==============================================================================
-void AudioPluginAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
+AudioPluginAudioProcessor::DetachedEffect AudioPluginAudioProcessor::compileDetachedEffect(
+    const juce::File& jsfxFile,
+    const juce::String& stateText,
+    double sampleRate,
+    int numChannels
+)
 {
-    // If the editor is open, save its current size to the state tree BEFORE serializing
-    // This ensures window size is persisted correctly on shutdown
-    if (auto* editor = getActiveEditor())
+    DetachedEffect effect{jsfxFile, nullptr, stateText};
+    if (!jsfxFile.existsAsFile())
+        return effect;
+
+    effect.instance = createDetachedInstance(jsfxFile, sampleRate, numChannels);
+    if (!effect.instance)
     {
-        if (auto* pluginEditor = dynamic_cast<AudioPluginAudioProcessorEditor*>(editor))
-            pluginEditor->saveEditorState();
+        DBG("compileDetachedEffect: Failed to create instance for " + jsfxFile.getFullPathName());
+        return effect;
     }
 
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    // Not published yet, so the state can be loaded (or taken, for a new effect) right here
+    if (stateText.isNotEmpty())
+    {
+        JesusonicAPI.sx_loadState(effect.instance, stateText.toRawUTF8());
+    }
+    else
+    {
+        int stateLength = 0;
+        if (const char* savedState = JesusonicAPI.sx_saveState(effect.instance, &stateLength))
+            effect.stateText = juce::String(savedState, static_cast<size_t>(juce::jmax(0, stateLength)));
+    }
+
+    return effect;
 }
 
-void AudioPluginAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+void AudioPluginAudioProcessor::publishChain()
 {
-    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+    std::unique_ptr<JsfxChain> newChain;
 
-    if (xmlState != nullptr)
+    if (!chainStages.empty())
     {
-        if (xmlState->hasTagName(apvts.state.getType()))
+        newChain = std::make_unique<JsfxChain>();
+        for (const auto& stage : chainStages)
+            newChain->stages.push_back(stage.instance);
+
+        newChain->pipelined = chainPipelined;
+        newChain->numChannels = getTotalNumInputChannels();
+        newChain->capacitySamples = juce::jmax(lastSamplesPerBlock, PluginConstants::MaxAccumulatorBlockSize);
+
+        if (newChain->pipelined)
         {
-            // Restore the state tree (parameters and properties)
-            apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+            newChain->preparePipeline();
+            ensureRealtimePool();
+        }
+    }
 
-            // Check if there's a valid JSFX path to restore
-            auto jsfxPath = getCurrentJSFXPath();
-            DBG("setStateInformation: Found JSFX path in state: " + jsfxPath);
+    auto* superseded = chainState.exchange(newChain.release(), std::memory_order_acq_rel);
+    if (superseded)
+        reclaimer.retire([superseded] { delete superseded; });
+}
 
-            if (jsfxPath.isNotEmpty())
-            {
-                juce::File jsfxFile(jsfxPath);
-                if (jsfxFile.existsAsFile())
-                {
-                    // Set flag to force push APVTS to JSFX
+void AudioPluginAudioProcessor::storeChainInState()
+{
+    // From the state each stage was created with: published stages belong to the audio thread
+    auto chainTree = apvts.state.getOrCreateChildWithName(chainTreeType, nullptr);
+    chainTree.removeAllChildren(nullptr);
+
+    for (const auto& stage : chainStages)
+    {
+        juce::ValueTree stageTree(chainStageType);
+        stageTree.setProperty(effectPathID, stage.file.getFullPathName(), nullptr);
+        stageTree.setProperty(effectStateID, stage.stateText, nullptr);
+        chainTree.appendChild(stageTree, nullptr);
+    }
+}
+
+void AudioPluginAudioProcessor::restoreChainFromState()
+{
+    std::vector<DetachedEffect> stages;
+    for (const auto& stageTree : apvts.state.getChildWithName(chainTreeType))
+    {
+        stages.push_back(
+            {juce::File(stageTree.getProperty(effectPathID).toString()),
+             nullptr,
+             stageTree.getProperty(effectStateID).toString()}
+        );
+    }
+
+    const bool pipelined = static_cast<bool>(apvts.state.getProperty(chainPipelinedID, false));
+    const auto generation = ++chainRestoreGeneration;
+    const double sampleRate = lastSampleRate;
+    const int numChannels = getTotalNumInputChannels();
+
+    // Offline renders have no message loop to hand the stages back through: compile them here
+    if (isNonRealtime())
+    {
+        for (auto& stage : stages)
+            stage = compileDetachedEffect(stage.file, stage.stateText, sampleRate, numChannels);
+
+        installRestoredChain(std::move(stages), pipelined);
+        return;
+    }
+
+    juce::WeakReference<AudioPluginAudioProcessor> weakThis(this);
+
+    // The destructor waits for this counter, so the job may safely use `this`
+    pendingWorkerJobs.fetch_add(1, std::memory_order_acq_rel);
+
+    workerPool->pool.addJob(
+        [this, weakThis, stages, pipelined, generation, sampleRate, numChannels]() mutable
+        {
+            for (auto& stage : stages)
+            {
+                if (isShuttingDown.load(std::memory_order_acquire)
+                    || generation != chainRestoreGeneration.load(std::memory_order_acquire))
+                    break;
+
+                stage = compileDetachedEffect(stage.file, stage.stateText, sampleRate, numChannels);
+            }
+
+            juce::MessageManager::callAsync(
+                [weakThis, stages, pipelined, generation]() mutable
+                {
+                    auto* self = weakThis.get();
+                    if (self == nullptr || generation != self->chainRestoreGeneration.load(std::memory_order_acquire))
+                    {
+                        for (auto& stage : stages)
+                            destroyInstance(stage.instance);
+                        return;
+                    }
+
+                    self->installRestoredChain(std::move(stages), pipelined);
+                }
+            );
+
+            pendingWorkerJobs.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    );
+}
+
+void AudioPluginAudioProcessor::installRestoredChain(std::vector<DetachedEffect> stages, bool pipelined)
+{
+    clearChain();
+    chainPipelined = pipelined;
+
+    for (auto& stage : stages)
+    {
+        if (!stage.instance)
+        {
+            DBG("installRestoredChain: Skipping chain stage " + stage.file.getFullPathName());
+            continue;
+        }
+
+        // Compiled for the rate and layout of the time the restore started
+        JesusonicAPI.sx_extended(stage.instance, JSFX_EXT_SET_SRATE, (void*)(intptr_t)lastSampleRate, nullptr);
+        JesusonicAPI.sx_updateHostNch(stage.instance, getTotalNumInputChannels());
+        chainStages.push_back(stage);
+    }
+
+    publishChain();
+    storeChainInState();
+}
+
+//==============================================================================
+int AudioPluginAudioProcessor::addGraphNode(const juce::File& jsfxFile)
+{
+    if (!appendGraphNode(jsfxFile))
+        return -1;
+
+    publishGraph();
+    storeGraphInState();
+    return getNumGraphNodes() - 1;
+}
+
+void AudioPluginAudioProcessor::removeGraphNode(int index)
+{
+    if (!juce::isPositiveAndBelow(index, getNumGraphNodes()))
+        return;
+
+    auto* instance = graphNodes[static_cast<size_t>(index)].instance;
+    graphNodes.erase(graphNodes.begin() + index);
+
+    // Drop the node's edges and renumber the ones after it
+    std::vector<JsfxGraph::EdgeDescription> remaining;
+    for (auto edge : graphEdges)
+    {
+        if (edge.source == index || edge.destination == index)
+            continue;
+
+        if (edge.source > index)
+            --edge.source;
+        if (edge.destination > index)
+            --edge.destination;
+
+        remaining.push_back(edge);
+    }
+    graphEdges = std::move(remaining);
+
+    // Published first, so the audio thread is past the node by the time it's destroyed
+    publishGraph();
+    retireInstance(instance);
+    storeGraphInState();
+}
+
+bool AudioPluginAudioProcessor::connectGraphNodes(int source, int destination, const RoutingConfig::Matrix& matrix)
+{
+    // One edge per node pair; connecting again replaces its matrix
+    auto edges = graphEdges;
+    auto existing = std::find_if(
+        edges.begin(),
+        edges.end(),
+        [&](const auto& edge) { return edge.source == source && edge.destination == destination; }
+    );
+
+    if (existing != edges.end())
+    {
+        existing->matrix = matrix;
+    }
+    else
+    {
+        JsfxGraph::EdgeDescription edge;
+        edge.source = source;
+        edge.destination = destination;
+        edge.matrix = matrix;
+        edges.push_back(edge);
+    }
+
+    if (!JsfxGraph::isValid(getNumGraphNodes(), edges))
+    {
+        DBG("connectGraphNodes: Rejected edge " << source << " -> " << destination << " (missing node or cycle)");
+        return false;
+    }
+
+    graphEdges = std::move(edges);
+    publishGraph();
+    storeGraphInState();
+    return true;
+}
+
+void AudioPluginAudioProcessor::disconnectGraphNodes(int source, int destination)
+{
+    const auto numEdges = graphEdges.size();
+    graphEdges.erase(
+        std::remove_if(
+            graphEdges.begin(),
+            graphEdges.end(),
+            [&](const auto& edge) { return edge.source == source && edge.destination == destination; }
+        ),
+        graphEdges.end()
+    );
+
+    if (graphEdges.size() == numEdges)
+        return;
+
+    publishGraph();
+    storeGraphInState();
+}
+
+bool AudioPluginAudioProcessor::hasGraphConnection(int source, int destination) const
+{
+    return std::any_of(
+        graphEdges.begin(),
+        graphEdges.end(),
+        [&](const auto& edge) { return edge.source == source && edge.destination == destination; }
+    );
+}
+
+void AudioPluginAudioProcessor::clearGraph()
+{
+    auto removed = std::move(graphNodes);
+    graphNodes.clear();
+    graphEdges.clear();
+
+    publishGraph();
+    for (auto& node : removed)
+        retireInstance(node.instance);
+
+    storeGraphInState();
+}
+
+juce::File AudioPluginAudioProcessor::getGraphNodeFile(int index) const
+{
+    if (!juce::isPositiveAndBelow(index, getNumGraphNodes()))
+        return {};
+
+    return graphNodes[static_cast<size_t>(index)].file;
+}
+
+void AudioPluginAudioProcessor::setGraphMultithreaded(bool shouldUseThreads)
+{
+    if (shouldUseThreads && !graphNodes.empty())
+        ensureRealtimePool();
+
+    graphMultithreaded.store(shouldUseThreads, std::memory_order_relaxed);
+    apvts.state.setProperty(graphMultithreadedID, shouldUseThreads, nullptr);
+}
+
+bool AudioPluginAudioProcessor::appendGraphNode(const juce::File& jsfxFile)
+{
+    if (getNumGraphNodes() >= PluginConstants::MaxGraphNodes)
+        return false;
+
+    auto node = compileDetachedEffect(jsfxFile, {}, lastSampleRate, getTotalNumInputChannels());
+    if (!node.instance)
+        return false;
+
+    graphNodes.push_back(node);
+    return true;
+}
+
+void AudioPluginAudioProcessor::publishGraph()
+{
+    std::vector<SX_Instance*> instances;
+    for (const auto& node : graphNodes)
+        instances.push_back(node.instance);
+
+    // Without nodes, or before an edge reaches graphIO, nothing is published and audio passes the graph by
+    const int capacity = juce::jmax(lastSamplesPerBlock, PluginConstants::MaxAccumulatorBlockSize);
+    auto newGraph = JsfxGraph::create(instances, graphEdges, getTotalNumInputChannels(), capacity);
+
+    if (newGraph && graphMultithreaded.load(std::memory_order_relaxed))
+        ensureRealtimePool();
+
+    reclaimer.retire(graphState.exchange(newGraph.release(), std::memory_order_acq_rel));
+}
+
+void AudioPluginAudioProcessor::storeGraphInState()
+{
+    // Node state as the node was created, like the chain's
+    auto graphTree = apvts.state.getOrCreateChildWithName(graphTreeType, nullptr);
+    graphTree.removeAllChildren(nullptr);
+
+    for (const auto& node : graphNodes)
+    {
+        juce::ValueTree nodeTree(graphNodeType);
+        nodeTree.setProperty(effectPathID, node.file.getFullPathName(), nullptr);
+        nodeTree.setProperty(effectStateID, node.stateText, nullptr);
+        graphTree.appendChild(nodeTree, nullptr);
+    }
+
+    // Edge matrices as "source:destination" channel pairs
+    for (const auto& edge : graphEdges)
+    {
+        juce::StringArray connections;
+        for (int from = 0; from < PluginConstants::MaxChannels; ++from)
+            for (int to = 0; to < PluginConstants::MaxChannels; ++to)
+                if (edge.matrix[from][to])
+                    connections.add(juce::String(from) + ":" + juce::String(to));
+
+        juce::ValueTree edgeTree(graphEdgeType);
+        edgeTree.setProperty(graphEdgeSourceID, edge.source, nullptr);
+        edgeTree.setProperty(graphEdgeDestinationID, edge.destination, nullptr);
+        edgeTree.setProperty(graphEdgeConnectionsID, connections.joinIntoString(" "), nullptr);
+        graphTree.appendChild(edgeTree, nullptr);
+    }
+}
+
+void AudioPluginAudioProcessor::restoreGraphFromState()
+{
+    setGraphMultithreaded(static_cast<bool>(apvts.state.getProperty(graphMultithreadedID, true)));
+
+    std::vector<DetachedEffect> nodes;
+    std::vector<JsfxGraph::EdgeDescription> savedEdges;
+    for (const auto& child : apvts.state.getChildWithName(graphTreeType))
+    {
+        if (child.hasType(graphNodeType))
+        {
+            nodes.push_back(
+                {juce::File(child.getProperty(effectPathID).toString()),
+                 nullptr,
+                 child.getProperty(effectStateID).toString()}
+            );
+            continue;
+        }
+
+        if (!child.hasType(graphEdgeType))
+            continue;
+
+        JsfxGraph::EdgeDescription edge;
+        edge.source = static_cast<int>(child.getProperty(graphEdgeSourceID, -2));
+        edge.destination = static_cast<int>(child.getProperty(graphEdgeDestinationID, -2));
+
+        const auto connections = child.getProperty(graphEdgeConnectionsID).toString();
+        for (const auto& pair : juce::StringArray::fromTokens(connections, " ", {}))
+        {
+            const int from = pair.upToFirstOccurrenceOf(":", false, false).getIntValue();
+            const int to = pair.fromFirstOccurrenceOf(":", false, false).getIntValue();
+            if (juce::isPositiveAndBelow(from, PluginConstants::MaxChannels)
+                && juce::isPositiveAndBelow(to, PluginConstants::MaxChannels))
+                edge.matrix[from][to] = true;
+        }
+
+        savedEdges.push_back(edge);
+    }
+
+    const auto generation = ++graphRestoreGeneration;
+    const double sampleRate = lastSampleRate;
+    const int numChannels = getTotalNumInputChannels();
+
+    // Offline renders have no message loop to hand the nodes back through: compile them here
+    if (isNonRealtime())
+    {
+        for (auto& node : nodes)
+            node = compileDetachedEffect(node.file, node.stateText, sampleRate, numChannels);
+
+        installRestoredGraph(std::move(nodes), std::move(savedEdges));
+        return;
+    }
+
+    juce::WeakReference<AudioPluginAudioProcessor> weakThis(this);
+
+    // The destructor waits for this counter, so the job may safely use `this`
+    pendingWorkerJobs.fetch_add(1, std::memory_order_acq_rel);
+
+    workerPool->pool.addJob(
+        [this, weakThis, nodes, savedEdges, generation, sampleRate, numChannels]() mutable
+        {
+            for (auto& node : nodes)
+            {
+                if (isShuttingDown.load(std::memory_order_acquire)
+                    || generation != graphRestoreGeneration.load(std::memory_order_acquire))
+                    break;
+
+                node = compileDetachedEffect(node.file, node.stateText, sampleRate, numChannels);
+            }
+
+            juce::MessageManager::callAsync(
+                [weakThis, nodes, savedEdges, generation]() mutable
+                {
+                    auto* self = weakThis.get();
+                    if (self == nullptr || generation != self->graphRestoreGeneration.load(std::memory_order_acquire))
+                    {
+                        for (auto& node : nodes)
+                            destroyInstance(node.instance);
+                        return;
+                    }
+
+                    self->installRestoredGraph(std::move(nodes), std::move(savedEdges));
+                }
+            );
+
+            pendingWorkerJobs.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    );
+}
+
+void AudioPluginAudioProcessor::installRestoredGraph(
+    std::vector<DetachedEffect> nodes,
+    std::vector<JsfxGraph::EdgeDescription> savedEdges
+)
+{
+    clearGraph();
+
+    // Node indices in the edges refer to the saved nodes; ones that fail to load are left out
+    std::vector<int> restoredIndex;
+    for (auto& node : nodes)
+    {
+        if (!node.instance)
+        {
+            DBG("installRestoredGraph: Skipping graph node " + node.file.getFullPathName());
+            restoredIndex.push_back(-2);
+            continue;
+        }
+
+        // Compiled for the rate and layout of the time the restore started
+        JesusonicAPI.sx_extended(node.instance, JSFX_EXT_SET_SRATE, (void*)(intptr_t)lastSampleRate, nullptr);
+        JesusonicAPI.sx_updateHostNch(node.instance, getTotalNumInputChannels());
+        graphNodes.push_back(node);
+        restoredIndex.push_back(getNumGraphNodes() - 1);
+    }
+
+    auto mapIndex = [&](int savedIndex)
+    {
+        if (savedIndex == JsfxGraph::graphIO)
+            return JsfxGraph::graphIO;
+
+        return juce::isPositiveAndBelow(savedIndex, static_cast<int>(restoredIndex.size()))
+                 ? restoredIndex[static_cast<size_t>(savedIndex)]
+                 : -2;
+    };
+
+    for (auto edge : savedEdges)
+    {
+        edge.source = mapIndex(edge.source);
+        edge.destination = mapIndex(edge.destination);
+        if (edge.source != -2 && edge.destination != -2)
+            graphEdges.push_back(edge);
+    }
+
+    if (!JsfxGraph::isValid(getNumGraphNodes(), graphEdges))
+        graphEdges.clear();
+
+    publishGraph();
+    storeGraphInState();
+}
+
+template <typename FloatType>
+void AudioPluginAudioProcessor::processBlockInternal(
+    juce::AudioBuffer<FloatType>& buffer,
+    juce::MidiBuffer& midiMessages
+)
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    // TODO: Add MIDI Program Change support
+    // To implement preset loading via MIDI Program Change:
+    // 1. Iterate through midiMessages before passing to JSFX
+    // 2. Check for isProgramChange() messages
+    // 3. Get program number (0-127)
+    // 4. Map program number to preset base64 data (from LibraryBrowser's ValueTree)
+    // 5. Call loadPresetFromBase64(presetData) from message thread via MessageManager::callAsync
+    //    (Never call directly from audio thread - it updates UI parameters!)
+    // Example:
+    //   for (auto metadata : midiMessages)
+    //   {
+    //       auto msg = metadata.getMessage();
+    //       if (msg.isProgramChange())
+    //       {
+    //           int programNum = msg.getProgramChangeNumber();
+    //           juce::MessageManager::callAsync([this, programNum]()
+    //           {
+    //               auto presetData = getPresetDataForProgram(programNum);
+    //               loadPresetFromBase64(presetData);
+    //           });
+    //       }
+    //   }
+
+    // Nothing loaded during the previous block is used past this point
+    reclaimer.quiescentPoint();
+
+    profiler.beginBlock(buffer.getNumSamples(), getSampleRate());
+
+    // Pick up a newly published JSFX before touching any instance state.
+    // Oversampling changes first, so an instance adopted now starts its crossfade at the new rate.
+    adoptOversampling();
+    adoptPublishedInstance();
+    adoptSplitGroup();
+
+    // Graph and chain snapshots for this block (valid until the next quiescent point)
+    auto* graph = graphState.load(std::memory_order_acquire);
+    auto* chain = chainState.load(std::memory_order_acquire);
+
+    // Early return if no JSFX instance is loaded
+    if (!audioInstance && !fadingInstance && !graph && !chain)
+    {
+        // Clear buffers and return - can't process without JSFX
+        buffer.clear();
+        midiMessages.clear();
+        profiler.endBlock();
+        return;
+    }
+
+    // Linked-split copies only follow the instance they were made for
+    JsfxSplitGroup* linkedSplit = (audioSplit && audioSplit->owner == audioInstance) ? audioSplit : nullptr;
+    SX_Instance* const* linkedCopies = linkedSplit ? linkedSplit->copies.data() : nullptr;
+    const int numLinkedCopies = linkedSplit ? static_cast<int>(linkedSplit->copies.size()) : 0;
+    parameterSync.setLinkedInstances(linkedCopies, numLinkedCopies);
+
+    if (linkedSplit && !linkedSplit->parametersMirrored)
+    {
+        // The copies were made from an earlier snapshot of the running instance; catch them up
+        for (int i = 0; i < numActiveParams; ++i)
+        {
+            double minVal, maxVal, step;
+            const double value = JesusonicAPI.sx_getParmVal(audioInstance, i, &minVal, &maxVal, &step);
+
+            for (int copy = 0; copy < numLinkedCopies; ++copy)
+                JesusonicAPI.sx_setParmVal(linkedCopies[copy], i, value, 0);
+        }
+
+        linkedSplit->parametersMirrored = true;
+    }
+
+    // If we need to force push APVTS to JSFX (after state restoration), do it now
+    if (audioInstance && needsForcePushApvtsToJsfx.load(std::memory_order_acquire))
+    {
+        for (int i = 0; i < numActiveParams; ++i)
+        {
+            if (i < static_cast<int>(parameterCache.size()) && parameterCache[i])
+            {
+                float normalizedValue = parameterCache[i]->getValue();
+                double actualValue = ParameterUtils::normalizedToActualValue(audioInstance, i, normalizedValue);
+                JesusonicAPI.sx_setParmVal(audioInstance, i, actualValue, 0);
+
+                for (int copy = 0; copy < numLinkedCopies; ++copy)
+                    JesusonicAPI.sx_setParmVal(linkedCopies[copy], i, actualValue, 0);
+            }
+        }
+
+        needsForcePushApvtsToJsfx.store(false, std::memory_order_release);
+    }
+
+    // Apply the newest preset loaded on the message thread; the preset wins over any
+    // concurrent APVTS change, and reaches APVTS in one batch from the timer
+    const bool presetApplied = presetQueue.applyPending(audioInstance, linkedCopies, numLinkedCopies);
+    if (presetApplied)
+        parameterSync.adoptJsfxState(audioInstance);
+
+    // Instance hand-over, forced parameter pushes and presets count as parameter sync
+    profiler.lap(ProcessProfiler::Stage::ParameterSync);
+
+    int numSamples = buffer.getNumSamples();
+
+    // Setup MIDI routing: host input copied into the input arena, JSFX output accumulated in the output arena
+    midiInputArena.fillFrom(midiMessages, 0);
+    midiOutputArena.clear();
+    currentMidiInput = &midiInputArena;
+    currentMidiOutput = &midiOutputArena;
+    profiler.lap(ProcessProfiler::Stage::Midi);
+
+    int mainChannels = buffer.getNumChannels();
+
+    // Get sidechain buffer if available (bus index 1)
+    // Check if sidechain bus exists first to avoid assertion
+    bool hasSidechainBus = (getBusCount(true) > 1);
+    auto sidechainBuffer = hasSidechainBus ? getBusBuffer(buffer, true, 1) : juce::AudioBuffer<FloatType>();
+    int sidechainChannels = sidechainBuffer.getNumChannels();
+
+    // Total channels to send to JSFX (main + sidechain, capped at JSFX max)
+    // For MIDI instruments with 0 inputs, use the output channel count instead
+    int inputChannelCount = mainChannels + sidechainChannels;
+    if (inputChannelCount == 0 && getBusCount(false) > 0)
+    {
+        // MIDI instrument - use output bus channel count
+        inputChannelCount = getBus(false, 0)->getNumberOfChannels();
+    }
+    int totalJsfxChannels = juce::jmin(inputChannelCount, PluginConstants::JsfxMaxChannels);
+
+    // Allocate temp buffer for interleaved audio: [main inputs][sidechain inputs]
+    tempBuffer.setSize(1, numSamples * totalJsfxChannels, false, false, true);
+    auto* tempPtr = tempBuffer.getWritePointer(0);
+
+    // Get current compiled routing plan (lock-free read, valid until the next quiescent point)
+    const auto& routing = routingState.load(std::memory_order_acquire)->plan;
+
+    if (routing.identityInputChannels >= 0)
+    {
+        // Fast path for diagonal routing: convert straight into the interleaved buffer.
+        // Unrouted JSFX channels are zero-filled by the kernel, so no separate clear pass is needed.
+        int numIdentity = juce::jmin(routing.identityInputChannels, mainChannels, totalJsfxChannels);
+        InterleaveKernels::interleave(
+            buffer.getArrayOfReadPointers(),
+            numIdentity,
+            tempPtr,
+            totalJsfxChannels,
+            numSamples
+        );
+    }
+    else
+    {
+        // Clear temp buffer first
+        std::fill(tempPtr, tempPtr + numSamples * totalJsfxChannels, 0.0);
+
+        // Apply INPUT routing: JUCE inputs -> JSFX channels (active connections only)
+        RoutingPlan::applyToInterleaved(
+            routing.input,
+            buffer.getArrayOfReadPointers(),
+            mainChannels,
+            tempPtr,
+            totalJsfxChannels,
+            numSamples
+        );
+
+        // Apply SIDECHAIN routing: JUCE sidechain -> JSFX channels
+        if (sidechainChannels > 0)
+        {
+            RoutingPlan::applyToInterleaved(
+                routing.sidechain,
+                sidechainBuffer.getArrayOfReadPointers(),
+                sidechainChannels,
+                tempPtr,
+                totalJsfxChannels,
+                numSamples
+            );
+        }
+    }
+
+    // While a hot-swap crossfade runs, the outgoing instance gets its own copy of the routed input
+    const bool isCrossfading = fadingInstance != nullptr && crossfadeSamplesRemaining > 0;
+    double* fadePtr = nullptr;
+    if (isCrossfading)
+    {
+        fadeBuffer.setSize(1, numSamples * totalJsfxChannels, false, false, true);
+        fadePtr = fadeBuffer.getWritePointer(0);
+        std::copy(tempPtr, tempPtr + numSamples * totalJsfxChannels, fadePtr);
+    }
+
+    // Idle JSFX sleep: while the routed input and the effect's tail are silent, the JSFX isn't run
+    const bool sleepOnSilence = silenceGate.isEnabled();
+    const bool inputIsSilent = sleepOnSilence
+                            && midiInputArena.getNumEvents() == 0
+                            && SilenceGate::isSilent(tempPtr, numSamples * totalJsfxChannels);
+    profiler.lap(ProcessProfiler::Stage::InputRouting);
+
+    // Two-way parameter synchronization between APVTS and JSFX
+    // This handles:
+    // - APVTS -> JSFX (user moves UI slider or host automation)
+    // - JSFX -> APVTS (JSFX script changes parameter internally)
+    // - Conflict resolution (APVTS takes precedence)
+    parameterSync.updateFromAudioThread(audioInstance, numSamples);
+    profiler.lap(ProcessProfiler::Stage::ParameterSync);
+
+    // Get transport info from host
+    double tempo = 120.0;
+    int timeSigNumerator = 4;
+    int timeSigDenominator = 4;
+    double playState = 1.0; // 0=stopped, 1=playing, 5=recording
+    double playPositionSeconds = 0.0;
+    double playPositionBeats = 0.0;
+
+    if (auto* ph = getPlayHead())
+    {
+        if (auto posInfo = ph->getPosition())
+        {
+            if (auto bpm = posInfo->getBpm())
+                tempo = *bpm;
+
+            if (auto timeSig = posInfo->getTimeSignature())
+            {
+                timeSigNumerator = timeSig->numerator;
+                timeSigDenominator = timeSig->denominator;
+            }
+
+            if (auto ppqPos = posInfo->getPpqPosition())
+                playPositionBeats = *ppqPos;
+
+            if (auto timeInSeconds = posInfo->getTimeInSeconds())
+                playPositionSeconds = *timeInSeconds;
+
+            // Determine play state
+            playState = 0.0; // stopped
+            if (posInfo->getIsPlaying())
+                playState = 1.0; // playing
+            if (posInfo->getIsRecording())
+                playState = 5.0; // recording (1 | 4)
+        }
+    }
+
+    profiler.lap(ProcessProfiler::Stage::Transport);
+
+    // Besides its input, a JSFX reacts to parameters, presets and the transport starting
+    // (sequencers, tempo-synced LFOs), so any of those wakes it before deciding to sleep
+    const bool transportIsPlaying = playState != 0.0;
+    if (presetApplied
+        || parameterSync.getNumChangesInLastUpdate() > 0
+        || parameterSync.hasActiveRamps()
+        || (transportIsPlaying && !transportWasPlaying))
+        silenceGate.wake();
+    transportWasPlaying = transportIsPlaying;
+
+    const bool isSleeping = audioInstance != nullptr && !isCrossfading && silenceGate.shouldSkip(inputIsSilent);
+
+    // Independent JSFX runs go to the realtime pool once one was started, else they run here in turn
+    RealtimeThreadPool* const threadPool = realtimePool.load(std::memory_order_acquire);
+    auto parallelFor = [threadPool](int numTasks, auto& task)
+    {
+        if (threadPool)
+            threadPool->parallelFor(numTasks, task);
+        else
+            for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+                task(taskIndex);
+    };
+
+    // Processes `length` interleaved frames for the part of the block that starts at startSample (in host
+    // samples); transport is offset to match. Oversampled frames run at timeScale times the host rate.
+    // The caller points the MIDI callback at the same range (currentMidiBlockStart/Size).
+    auto processInstance = [&](
+        SX_Instance* instance,
+        double* interleaved,
+        int numChannels,
+        int startSample,
+        int length,
+        int timeScale
+    )
+    {
+        const double offsetSeconds = startSample / getSampleRate();
+
+        JesusonicAPI.sx_processSamples(
+            instance,
+            interleaved,
+            length,
+            numChannels,                              // Total JSFX channels including sidechain, or a split slice's
+            (int)(getSampleRate() * timeScale + 0.5), // Cast to int, matching vstframe.cpp
+            tempo,
+            timeSigNumerator,
+            timeSigDenominator,
+            playState,
+            playPositionSeconds + offsetSeconds,
+            playPositionBeats + offsetSeconds * tempo / 60.0,
+            1.0, // lastWet (always 100% wet)
+            1.0, // currentWet (always 100% wet)
+            0
+        );
+    };
+
+    // Linked-split: every slice of the channels runs on its own copy of the JSFX, in parallel
+    JsfxSplitGroup* split = (linkedSplit && linkedSplit->numChannels == totalJsfxChannels) ? linkedSplit : nullptr;
+
+    // `length` frames at timeScale times the host rate, for the part of the block from startSample on
+    auto processSplit = [&](double* frames, int startSample, int length, int timeScale)
+    {
+        // Chunks end on host sample boundaries, so MIDI positions stay exact
+        const int chunkSize = split->capacitySamples - split->capacitySamples % timeScale;
+
+        for (int chunkOffset = 0; chunkOffset < length; chunkOffset += chunkSize)
+        {
+            const int chunkLength = juce::jmin(chunkSize, length - chunkOffset);
+            const int chunkStart = startSample + chunkOffset / timeScale;
+            double* chunk = frames + static_cast<size_t>(chunkOffset) * static_cast<size_t>(totalJsfxChannels);
+
+            // Only slice 0 runs the instance that has the MIDI callback
+            currentMidiBlockStart = chunkStart;
+            currentMidiBlockSize = chunkLength / timeScale;
+
+            auto processSlice = [&](int sliceIndex)
+            {
+                juce::ScopedNoDenormals sliceNoDenormals;
+
+                auto& slice = split->slices[static_cast<size_t>(sliceIndex)];
+                double* sliceData = slice.buffer.getWritePointer(0);
+
+                // Slices write disjoint channels of the shared interleaved buffer
+                for (int sample = 0; sample < chunkLength; ++sample)
+                    std::copy_n(
+                        chunk + sample * totalJsfxChannels + slice.firstChannel,
+                        slice.numChannels,
+                        sliceData + sample * slice.numChannels
+                    );
+
+                processInstance(slice.instance, sliceData, slice.numChannels, chunkStart, chunkLength, timeScale);
+
+                for (int sample = 0; sample < chunkLength; ++sample)
+                    std::copy_n(
+                        sliceData + sample * slice.numChannels,
+                        slice.numChannels,
+                        chunk + sample * totalJsfxChannels + slice.firstChannel
+                    );
+            };
+
+            parallelFor(static_cast<int>(split->slices.size()), processSlice);
+        }
+    };
+
+    // Oversampling around the main JSFX, while the oversampler matches this block's channel layout
+    JsfxOversampler* oversampler = nullptr;
+    JsfxOversampler* fadingOversampler = nullptr;
+    if (audioOversampling && audioOversampling->main->getNumChannels() == totalJsfxChannels)
+    {
+        oversampler = audioOversampling->main.get();
+        fadingOversampler = audioOversampling->fading.get();
+    }
+
+    const int timeScale = oversampler ? oversampler->getFactor() : 1;
+    currentMidiTimeScale = timeScale;
+
+    // Calls run(jsfxFrames, chunkStart, chunkLength) over [startSample, startSample + length) of the block, in
+    // runs the oversampler can hold. jsfxFrames is the upsampled run, filtered back down after run() returns.
+    auto forEachJsfxRun = [&](JsfxOversampler* os, double* block, int startSample, int length, auto&& run)
+    {
+        const int chunkSize = os ? os->getMaxBlockSize() : length;
+
+        for (int offset = 0; offset < length; offset += chunkSize)
+        {
+            const int chunkLength = juce::jmin(chunkSize, length - offset);
+            double* chunk = block + static_cast<size_t>(startSample + offset) * static_cast<size_t>(totalJsfxChannels);
+
+            run(os ? os->upsample(chunk, chunkLength) : chunk, startSample + offset, chunkLength);
+
+            if (os)
+                os->downsample(chunk, chunkLength);
+        }
+    };
+
+    // Runs the main JSFX (or its split copies) over [startSample, startSample + length) of the block
+    auto runMainInstance = [&](int startSample, int length)
+    {
+        forEachJsfxRun(
+            oversampler,
+            tempPtr,
+            startSample,
+            length,
+            [&](double* jsfxFrames, int chunkStart, int chunkLength)
+            {
+                if (split)
+                {
+                    processSplit(jsfxFrames, chunkStart, chunkLength * timeScale, timeScale);
+                }
+                else
+                {
+                    currentMidiBlockStart = chunkStart;
+                    currentMidiBlockSize = chunkLength;
+                    processInstance(
+                        audioInstance,
+                        jsfxFrames,
+                        totalJsfxChannels,
+                        chunkStart,
+                        chunkLength * timeScale,
+                        timeScale
+                    );
+                }
+            }
+        );
+    };
+
+    auto processMainInstance = [&]()
+    {
+        if (isSleeping)
+        {
+            // The output would be silence anyway
+            std::fill(tempPtr, tempPtr + numSamples * totalJsfxChannels, 0.0);
+        }
+        else if (audioInstance)
+        {
+            // Smoothed parameters: while ramps are active, run the JSFX in sub-blocks and move the
+            // ramps before each one. Once they settle, the rest of the block is processed in one call.
+            const int smoothingBlockSize = parameterSync.getSmoothingBlockSize();
+            int startSample = 0;
+
+            while (startSample < numSamples)
+            {
+                int length = numSamples - startSample;
+
+                if (parameterSync.hasActiveRamps())
+                {
+                    if (smoothingBlockSize > 0)
+                        length = juce::jmin(length, smoothingBlockSize);
+
+                    parameterSync.advanceRamps(audioInstance, length);
+                }
+
+                runMainInstance(startSample, length);
+                startSample += length;
+            }
+
+            // Update latency atomically for the timer to read (some JSFX can have dynamic latency).
+            // An oversampled JSFX reports it at its own rate.
+            const int latencySamples = JesusonicAPI.sx_getCurrentLatency(audioInstance) / timeScale
+                                     + (oversampler ? oversampler->getLatencySamples() : 0);
+            currentJSFXLatency.store(latencySamples, std::memory_order_relaxed);
+
+            // MIDI output counts as output, so generators keep running
+            const bool outputIsSilent = sleepOnSilence
+                                     && midiOutputArena.getNumEvents() == 0
+                                     && SilenceGate::isSilent(tempPtr, numSamples * totalJsfxChannels);
+            silenceGate.blockProcessed(inputIsSilent, outputIsSilent, numSamples, latencySamples);
+        }
+        else if (fadingInstance)
+        {
+            // Unloading: the outgoing instance fades to silence
+            std::fill(tempPtr, tempPtr + numSamples * totalJsfxChannels, 0.0);
+        }
+
+        // Without a main JSFX, the graph and chain get the routed input as it is
+    };
+
+    // JSFX chain: pipelined only in fixed-size blocks, where one block of delay per stage is a constant latency
+    const int chainStageCount = chain ? static_cast<int>(chain->stages.size()) : 0;
+    const bool pipelineChain = chain
+                            && numSamples == activeAccumulatorBlockSize.load(std::memory_order_relaxed)
+                            && chain->canPipeline(numSamples, totalJsfxChannels);
+
+    if (pipelineChain)
+    {
+        chain->beginPipelineBlock(numSamples);
+
+        // Every stage works on what the stage before it made last block, so they can all run at once
+        auto processPipelineTask = [&](int task)
+        {
+            juce::ScopedNoDenormals taskNoDenormals;
+
+            if (task == 0)
+                processMainInstance();
+            else
+                processInstance(
+                    chain->stages[static_cast<size_t>(task - 1)],
+                    chain->getPipelineInput(task - 1),
+                    totalJsfxChannels,
+                    0,
+                    numSamples,
+                    1
+                );
+        };
+
+        parallelFor(chainStageCount + 1, processPipelineTask);
+    }
+    else
+    {
+        processMainInstance();
+    }
+
+    if (isCrossfading)
+    {
+        // Host MIDI belongs to the incoming instance only; the outgoing one may still send (e.g. note-offs)
+        currentMidiInput = nullptr;
+        forEachJsfxRun(
+            fadingOversampler,
+            fadePtr,
+            0,
+            numSamples,
+            [&](double* jsfxFrames, int chunkStart, int chunkLength)
+            {
+                currentMidiBlockStart = chunkStart;
+                currentMidiBlockSize = chunkLength;
+                processInstance(
+                    fadingInstance,
+                    jsfxFrames,
+                    totalJsfxChannels,
+                    chunkStart,
+                    chunkLength * timeScale,
+                    timeScale
+                );
+            }
+        );
+
+        // Linear crossfade; both instances see the same input, so their outputs are largely correlated
+        const double fadeStep = 1.0 / crossfadeLengthSamples;
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const double outgoingGain = juce::jmax(0, crossfadeSamplesRemaining - sample) * fadeStep;
+            double* frame = tempPtr + sample * totalJsfxChannels;
+            const double* outgoingFrame = fadePtr + sample * totalJsfxChannels;
+
+            for (int ch = 0; ch < totalJsfxChannels; ++ch)
+                frame[ch] += outgoingGain * (outgoingFrame[ch] - frame[ch]);
+        }
+
+        crossfadeSamplesRemaining = juce::jmax(0, crossfadeSamplesRemaining - numSamples);
+    }
+
+    if (graph && graph->getNumChannels() == totalJsfxChannels)
+    {
+        auto processNode = [&](SX_Instance* instance, double* interleaved, int numChannels, int length)
+        { processInstance(instance, interleaved, numChannels, 0, length, 1); };
+
+        const bool useThreads = graphMultithreaded.load(std::memory_order_relaxed);
+        graph->process(tempPtr, numSamples, useThreads ? threadPool : nullptr, processNode);
+        currentGraphLatency.store(graph->getLatencySamples(), std::memory_order_relaxed);
+    }
+    else
+    {
+        currentGraphLatency.store(0, std::memory_order_relaxed);
+    }
+
+    if (chain)
+    {
+        if (pipelineChain)
+            chain->advancePipeline(tempPtr, numSamples);
+        else
+            for (auto* stage : chain->stages)
+                processInstance(stage, tempPtr, totalJsfxChannels, 0, numSamples, 1);
+
+        int chainLatency = pipelineChain ? chain->getPipelineLatency() : 0;
+        for (auto* stage : chain->stages)
+            chainLatency += JesusonicAPI.sx_getCurrentLatency(stage);
+
+        currentChainLatency.store(chainLatency, std::memory_order_relaxed);
+    }
+    else
+    {
+        currentChainLatency.store(0, std::memory_order_relaxed);
+    }
+
+    // Crossfade finished: hand the outgoing instance back for destruction off the audio thread
+    if (fadingInstance && crossfadeSamplesRemaining == 0 && retireFromAudioThread(fadingInstance))
+        fadingInstance = nullptr;
+
+    // Everything from the main JSFX through the graph and chain
+    profiler.lap(ProcessProfiler::Stage::Jsfx);
+
+    // Apply OUTPUT routing: JSFX channels -> JUCE outputs
+    if (routing.identityOutputChannels >= 0)
+    {
+        // Fast path for diagonal routing: overwrite the routed outputs, clear only the rest
+        int numIdentity = juce::jmin(routing.identityOutputChannels, totalJsfxChannels, mainChannels);
+        InterleaveKernels::deinterleave(
+            tempPtr,
+            totalJsfxChannels,
+            buffer.getArrayOfWritePointers(),
+            numIdentity,
+            numSamples
+        );
+
+        for (int ch = numIdentity; ch < mainChannels; ++ch)
+            buffer.clear(ch, 0, numSamples);
+    }
+    else
+    {
+        // Clear output buffer first
+        buffer.clear();
+
+        RoutingPlan::applyFromInterleaved(
+            routing.output,
+            tempPtr,
+            totalJsfxChannels,
+            buffer.getArrayOfWritePointers(),
+            mainChannels,
+            numSamples
+        );
+    }
+
+    profiler.lap(ProcessProfiler::Stage::OutputRouting);
+
+    // Transfer MIDI output from JSFX back to host
+    midiMessages.clear();
+    midiOutputArena.copyTo(midiMessages);
+
+    // The callback only has arenas to work with while sx_processSamples runs
+    currentMidiInput = nullptr;
+    currentMidiOutput = nullptr;
+
+    profiler.lap(ProcessProfiler::Stage::Midi);
+    profiler.endBlock();
+
+    XrunDetector::BlockInfo blockInfo;
+    blockInfo.numSamples = numSamples;
+    blockInfo.sampleRate = getSampleRate();
+    blockInfo.numMidiEvents = midiInputArena.getNumEvents() + midiOutputArena.getNumEvents();
+    blockInfo.numParameterChanges = parameterSync.getNumChangesInLastUpdate();
+    blockInfo.numRampingParameters = parameterSync.getNumActiveRamps();
+    blockInfo.presetApplied = presetApplied;
+    xrunDetector.checkBlock(profiler, blockInfo);
+}
+
+void AudioPluginAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockWithBypass(buffer, midiMessages, true);
+}
+
+void AudioPluginAudioProcessor::processBlockBypassed(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockWithBypass(buffer, midiMessages, true);
+}
+
+template <typename FloatType>
+void AudioPluginAudioProcessor::processBlockWithBypass(
+    juce::AudioBuffer<FloatType>& buffer,
+    juce::MidiBuffer& midiMessages,
+    bool bypassed
+)
+{
+    const RealtimeSanitizer::ScopedRealtimeRegion realtimeRegion;
+
+    auto& delay = [this]() -> BypassDelay<FloatType>&
+    {
+        if constexpr (std::is_same_v<FloatType, double>)
+            return bypassDelayDouble;
+        else
+            return bypassDelay;
+    }();
+
+    // Fed on every block, so the delayed input lines up with the reported latency as soon as bypass starts
+    const int latencySamples = getLatencySamples();
+    delay.push(buffer);
+
+    const int targetPosition = bypassed ? bypassFadeLength : 0;
+    if (bypassFadePosition == targetPosition)
+    {
+        if (!bypassed)
+        {
+            processBlockAccumulated(buffer, midiMessages);
+            return;
+        }
+
+        // What the accumulator held from before the bypass would otherwise play after it ends
+        if (!accumulatorFlushed)
+        {
+            getBlockAccumulator<FloatType>().reset();
+            accumulatorFlushed = true;
+        }
+
+        // Bypassed blocks still count as quiescent points, so reclamation keeps going.
+        // MIDI passes through unchanged.
+        reclaimer.quiescentPoint();
+        delay.read(buffer, latencySamples);
+        return;
+    }
+
+    // Bypass is switching: the JSFX keeps running while the delayed input fades in or out
+    accumulatorFlushed = false;
+    const int numSamples = buffer.getNumSamples();
+    const auto& delayed = delay.readDelayed(numSamples, latencySamples);
+    processBlockAccumulated(buffer, midiMessages);
+
+    const int direction = bypassed ? 1 : -1;
+    const FloatType fadeStep = FloatType(1) / static_cast<FloatType>(bypassFadeLength);
+    const int fadeSamples = juce::jmin(numSamples, delayed.getNumSamples());
+    const int numChannels = juce::jmin(buffer.getNumChannels(), delayed.getNumChannels());
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const FloatType* dry = delayed.getReadPointer(channel);
+        FloatType* output = buffer.getWritePointer(channel);
+
+        for (int sample = 0; sample < fadeSamples; ++sample)
+        {
+            const int position = juce::jlimit(0, bypassFadeLength, bypassFadePosition + direction * (sample + 1));
+            const FloatType dryGain = static_cast<FloatType>(position) * fadeStep;
+            output[sample] += dryGain * (dry[sample] - output[sample]);
+        }
+    }
+
+    bypassFadePosition = juce::jlimit(0, bypassFadeLength, bypassFadePosition + direction * numSamples);
+}
+
+//==============================================================================
+bool AudioPluginAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor()
+{
+    return new AudioPluginAudioProcessorEditor(*this);
+}
+
+//==============================================================================
+void AudioPluginAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
+{
+    // If the editor is open, save its current size to the state tree BEFORE serializing
+    // This ensures window size is persisted correctly on shutdown
+    if (auto* editor = getActiveEditor())
+    {
+        if (auto* pluginEditor = dynamic_cast<AudioPluginAudioProcessorEditor*>(editor))
+            pluginEditor->saveEditorState();
+    }
+
+    auto state = apvts.copyState();
+    std::unique_ptr<juce::XmlElement> xml(state.createXml());
+    copyXmlToBinary(*xml, destData);
+}
+
+void AudioPluginAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+{
+    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+
+    if (xmlState != nullptr)
+    {
+        if (xmlState->hasTagName(apvts.state.getType()))
+        {
+            // Restore the state tree (parameters and properties)
+            apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+
+            // Re-blocking is part of the session (it changes the reported latency)
+            setBlockAccumulatorSize(static_cast<int>(apvts.state.getProperty(blockAccumulatorSizeID, 0)));
+            setSleepOnSilence(static_cast<bool>(apvts.state.getProperty(sleepOnSilenceID, false)));
+            setTailLengthSeconds(static_cast<double>(apvts.state.getProperty(tailLengthSecondsID, -1.0)));
+            setSplitMode(
+                static_cast<SplitMode>(juce::jlimit(0, 3, static_cast<int>(apvts.state.getProperty(splitModeID, 0)))),
+                apvts.state.getProperty(splitGroupsID, "").toString()
+            );
+            setOversampling(
+                static_cast<int>(apvts.state.getProperty(oversamplingFactorID, 1)),
+                static_cast<bool>(apvts.state.getProperty(oversamplingLinearPhaseID, false))
+            );
+            restoreChainFromState();
+            restoreGraphFromState();
+
+            // Check if there's a valid JSFX path to restore
+            auto jsfxPath = getCurrentJSFXPath();
+            DBG("setStateInformation: Found JSFX path in state: " + jsfxPath);
+
+            if (jsfxPath.isNotEmpty())
+            {
+                juce::File jsfxFile(jsfxPath);
+                if (jsfxFile.existsAsFile())
+                {
+                    // Set flag to force push APVTS to JSFX
                     // This prevents loadJSFX from initializing APVTS with JSFX defaults
                     needsForcePushApvtsToJsfx.store(true, std::memory_order_release);
 
                     // Check if prepareToPlay has already been called
                     if (isPrepared.load(std::memory_order_acquire))
                     {
-                        // prepareToPlay was already called, load JSFX now
-                        DBG("  prepareToPlay already called, loading JSFX immediately");
-                        loadJSFX(jsfxFile);
+                        // prepareToPlay was already called, load JSFX now (in the background)
+                        DBG("  prepareToPlay already called, restoring JSFX now");
+                        restoreJSFX(jsfxFile);
                         // Flag will be handled in processBlock to force push APVTS
                     }
                     else
@@ -1044,9 +2330,8 @@ void AudioPluginAudioProcessor::restoreRoutingFromString(const juce::String& rou
     if (parts.size() != 3)
         return; // Invalid format
 
-    // Get current routing config to read channel counts
-    int currentRead = readIndex.load(std::memory_order_acquire);
-    const auto& currentConfig = routingConfigs[currentRead];
+    // Get current routing config to read channel counts (the message thread is the only writer)
+    const auto& currentConfig = routingState.load(std::memory_order_acquire)->config;
 
     // If channel counts are not initialized yet, skip restoration
     // prepareToPlay() will initialize them and this will be called again
@@ -1130,33 +2415,177 @@ bool AudioPluginAudioProcessor::loadJSFX(const juce::File& jsfxFile)
     if (!jsfxFile.existsAsFile())
         return false;
 
+    // Supersede any async load that is still compiling
+    ++loadGeneration;
+
+    SX_Instance* newInstance = compileJSFX(jsfxFile, getJsfxSampleRate(), getTotalNumInputChannels());
+    if (!newInstance)
+        return false;
+
+    publishJSFX(newInstance, jsfxFile);
+    return true;
+}
+
+void AudioPluginAudioProcessor::loadJSFXAsync(const juce::File& jsfxFile, std::function<void(bool success)> onLoaded)
+{
+    loadJSFXInBackground(jsfxFile, std::move(onLoaded), false);
+}
+
+void AudioPluginAudioProcessor::loadJSFXInBackground(
+    const juce::File& jsfxFile,
+    std::function<void(bool success)> onLoaded,
+    bool reportSuperseded
+)
+{
+    if (!jsfxFile.existsAsFile())
+    {
+        if (onLoaded)
+            onLoaded(false);
+        return;
+    }
+
+    const auto generation = ++loadGeneration;
+    const double sampleRate = getJsfxSampleRate();
+    const int numChannels = getTotalNumInputChannels();
+    juce::WeakReference<AudioPluginAudioProcessor> weakThis(this);
+
+    // The destructor waits for this counter, so the job may safely use `this`
+    pendingWorkerJobs.fetch_add(1, std::memory_order_acq_rel);
+
+    workerPool->pool.addJob(
+        [this, weakThis, jsfxFile, generation, sampleRate, numChannels, onLoaded, reportSuperseded]()
+        {
+            // Don't bother compiling if we're going away or a newer load was requested meanwhile
+            SX_Instance* newInstance = nullptr;
+            if (!isShuttingDown.load(std::memory_order_acquire)
+                && generation == loadGeneration.load(std::memory_order_acquire))
+                newInstance = compileJSFX(jsfxFile, sampleRate, numChannels);
+
+            juce::MessageManager::callAsync(
+                [weakThis, jsfxFile, generation, newInstance, onLoaded, reportSuperseded]()
+                {
+                    auto* self = weakThis.get();
+                    if (self == nullptr)
+                    {
+                        // Processor was deleted while we were compiling
+                        destroyInstance(newInstance);
+                        return;
+                    }
+
+                    // A newer load (sync or async) has been requested since: drop this result
+                    if (generation != self->loadGeneration.load(std::memory_order_acquire))
+                    {
+                        self->retireInstance(newInstance);
+                        if (reportSuperseded && onLoaded)
+                            onLoaded(false);
+                        return;
+                    }
+
+                    if (newInstance)
+                        self->publishJSFX(newInstance, jsfxFile);
+
+                    if (onLoaded)
+                        onLoaded(newInstance != nullptr);
+                }
+            );
+
+            pendingWorkerJobs.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    );
+}
+
+void AudioPluginAudioProcessor::restoreJSFX(const juce::File& jsfxFile)
+{
+    // An offline render can't start on silence: its first blocks must already be processed
+    if (isNonRealtime())
+    {
+        loadJSFX(jsfxFile);
+        return;
+    }
+
+    // setStateInformation() may come from a host thread, but unloading and the editor's
+    // notification belong to the message thread
+    if (!juce::MessageManager::getInstance()->isThisTheMessageThread())
+    {
+        juce::WeakReference<AudioPluginAudioProcessor> weakThis(this);
+        juce::MessageManager::callAsync(
+            [weakThis, jsfxFile]()
+            {
+                if (auto* self = weakThis.get())
+                    self->restoreJSFX(jsfxFile);
+            }
+        );
+        return;
+    }
+
+    // Silent until the restored JSFX is live: the running one would otherwise be driven by
+    // parameters restored for the incoming effect
+    if (sxInstance)
+    {
+        unloadJSFX();
+        apvts.state.setProperty(jsfxPathParamID, jsfxFile.getFullPathName(), nullptr);
+    }
+
+    numPendingRestores.fetch_add(1, std::memory_order_acq_rel);
+    workerPool->beginRestore();
+
+    if (onRestoreStateChanged)
+        onRestoreStateChanged();
+
+    // Called exactly once, also when superseded, so the restore counts always balance.
+    // Not at all if the processor is deleted first; the destructor settles the counts then.
+    loadJSFXInBackground(
+        jsfxFile,
+        [this](bool)
+        {
+            // Loaded, failed or superseded alike: this restore is no longer pending
+            workerPool->endRestore();
+            if (numPendingRestores.fetch_sub(1, std::memory_order_acq_rel) == 1 && onRestoreStateChanged)
+                onRestoreStateChanged();
+        },
+        true
+    );
+}
+
+void AudioPluginAudioProcessor::getSessionRestoreProgress(int& numLive, int& numRestored) const
+{
+    workerPool->getRestoreProgress(numLive, numRestored);
+}
+
+SX_Instance* AudioPluginAudioProcessor::compileJSFX(const juce::File& jsfxFile, double sampleRate, int numChannels)
+{
     // Create new instance from source directory (allows live updates and dependency resolution)
     juce::File sourceDir = jsfxFile.getParentDirectory();
     juce::String fileName = jsfxFile.getFileName();
 
-    DBG("loadJSFX called with:");
+    DBG("compileJSFX called with:");
     DBG("  File: " + jsfxFile.getFullPathName());
     DBG("  Source dir: " + sourceDir.getFullPathName());
     DBG("  Filename: " + fileName);
 
-    // Check if file contains @gfx section
-    juce::String fileContent = jsfxFile.loadFileAsString();
-    bool fileHasGfxSection = fileContent.contains("@gfx");
-    int gfxPosition = fileContent.indexOf("@gfx");
-    DBG("  File contains @gfx: " + juce::String(fileHasGfxSection ? "YES" : "NO"));
-    if (fileHasGfxSection)
-        DBG("  @gfx position in file: " + juce::String(gfxPosition));
-    DBG("  File size: " + juce::String(jsfxFile.getSize()) + " bytes");
-    DBG("  First 200 chars: " + fileContent.substring(0, 200).replace("\n", "\\n").replace("\r", "\\r"));
+#if JUCE_DEBUG
+    // From the shared cache: read once however many instances load this file
+    if (auto script = fileCache->getScriptInfo(jsfxFile))
+    {
+        DBG("  File contains @gfx: " + juce::String(script->hasGfx ? "YES" : "NO"));
+        DBG("  File size: " + juce::String(jsfxFile.getSize()) + " bytes");
+    }
+#endif
 
     bool wantWak = false;
-    SX_Instance* newInstance =
-        JesusonicAPI.sx_createInstance(sourceDir.getFullPathName().toRawUTF8(), fileName.toRawUTF8(), &wantWak);
+    SX_Instance* newInstance = nullptr;
+    {
+        // Only creation (preprocessing and compiling) touches the compiler's shared state; @init
+        // runs in the instance's own VM, so restores of many instances overlap from there on
+        const juce::ScopedLock lifecycleLock(workerPool->instanceLifecycleLock);
+        newInstance =
+            JesusonicAPI.sx_createInstance(sourceDir.getFullPathName().toRawUTF8(), fileName.toRawUTF8(), &wantWak);
+    }
 
     if (!newInstance)
     {
         DBG("ERROR: Failed to create JSFX instance");
-        return false;
+        return nullptr;
     }
 
     DBG("JSFX instance created successfully");
@@ -1167,40 +2596,42 @@ bool AudioPluginAudioProcessor::loadJSFX(const juce::File& jsfxFile)
     sx_set_host_ctx(newInstance, this, JsfxSliderAutomateThunk);
 
     // 2. Set sample rate
-    JesusonicAPI.sx_extended(newInstance, JSFX_EXT_SET_SRATE, (void*)(intptr_t)lastSampleRate, nullptr);
+    JesusonicAPI.sx_extended(newInstance, JSFX_EXT_SET_SRATE, (void*)(intptr_t)sampleRate, nullptr);
 
     // 3. Set up MIDI context
     sx_set_midi_ctx(newInstance, &midiSendRecvCallback, this);
 
-    // 4. Update host channel count (-1 = use current bus layout)
-    JesusonicAPI.sx_updateHostNch(newInstance, getTotalNumInputChannels());
+    // 4. Update host channel count
+    JesusonicAPI.sx_updateHostNch(newInstance, numChannels);
 
     // Note: Do NOT call sx_processSamples with NULL buffer here!
-    // The JSFX @init section will be triggered automatically on the first real
-    // call to sx_processSamples during audio processing.
+    // Run @init now instead, so it doesn't land on the audio thread's first block after the swap.
+    // m_init_mutex stays held through the GFX setup below.
+    if (newInstance->m_need_init)
+    {
+        newInstance->m_mutex.Enter();
+        newInstance->m_init_mutex.Enter();
+        if (newInstance->m_need_init)
+            newInstance->on_slider_change();
+        newInstance->m_mutex.Leave();
+    }
+    else
+    {
+        newInstance->m_init_mutex.Enter();
+    }
 
-    // Initialize JSFX graphics (@gfx section) before swapping
+    // Initialize JSFX graphics (@gfx section) before publishing
     // This ensures the LICE state and framebuffer are ready when the UI accesses it
     if (newInstance->gfx_hasCode())
     {
+        // LICE keeps process-wide state (fonts, caches)
+        const juce::ScopedLock lifecycleLock(workerPool->instanceLifecycleLock);
+
         DBG("Initializing GFX for JSFX...");
         auto* liceState = newInstance->m_lice_state;
         if (liceState)
         {
             DBG("  LICE state exists");
-            // If JSFX needs initialization, call on_slider_change()
-            if (newInstance->m_need_init)
-            {
-                newInstance->m_mutex.Enter();
-                newInstance->m_init_mutex.Enter();
-                if (newInstance->m_need_init)
-                    newInstance->on_slider_change();
-                newInstance->m_mutex.Leave();
-            }
-            else
-            {
-                newInstance->m_init_mutex.Enter();
-            }
 
             // Setup framebuffer with JSFX's requested dimensions or default (400x300)
             // Check if JSFX specified dimensions via gfx(width, height) in @init
@@ -1224,42 +2655,33 @@ bool AudioPluginAudioProcessor::loadJSFX(const juce::File& jsfxFile)
                 // Trigger initial @gfx execution
                 newInstance->gfx_runCode(0);
             }
-
-            newInstance->m_init_mutex.Leave();
         }
     }
 
-    int latencySamples = JesusonicAPI.sx_getCurrentLatency(newInstance);
+    newInstance->m_init_mutex.Leave();
 
-    // Atomically swap instances while audio thread is suspended
-    // Both loadJSFX and JsfxLiceComponent run on message thread, so no contention there
-    suspendProcessing(true);
-    SX_Instance* oldInstance = sxInstance;
-    sxInstance = newInstance;
-    suspendProcessing(false);
+    return newInstance;
+}
 
-    // Destroy old instance after swap
-    if (oldInstance)
-    {
-        JesusonicAPI.sx_destroyInstance(oldInstance);
-        parameterSync.reset();
-    }
+void AudioPluginAudioProcessor::publishJSFX(SX_Instance* newInstance, const juce::File& jsfxFile)
+{
+    // Parameter sync keeps following the old instance until the audio thread adopts the new
+    // one together with its binding, built below
+    sxInstance = newInstance;
 
     // Update state and parameters
     apvts.state.setProperty(jsfxPathParamID, jsfxFile.getFullPathName(), nullptr);
+    setCurrentPresetName({});
 
     // Check if we should initialize with JSFX defaults or preserve APVTS state
     bool shouldInitWithJsfxDefaults = !needsForcePushApvtsToJsfx.load(std::memory_order_acquire);
 
+    // The new instance isn't visible to the audio thread yet, so no need to suspend processing
     if (shouldInitWithJsfxDefaults)
     {
         // Normal case: Initialize BOTH APVTS and JSFX with JSFX default values
         DBG("Initializing APVTS with JSFX defaults...");
-
-        // Suspend processing to ensure atomic initialization
-        suspendProcessing(true);
         updateParameterMapping(true);
-        suspendProcessing(false);
     }
     else
     {
@@ -1269,8 +2691,16 @@ bool AudioPluginAudioProcessor::loadJSFX(const juce::File& jsfxFile)
         updateParameterMapping(false);
     }
 
+    // Fully initialised - hand it to the audio thread, which crossfades from the old one
+    publishToAudioThread(newInstance, parameterSync.createBinding(newInstance, numActiveParams));
+
+    // The new instance runs unsplit until its copies are ready
+    rebuildSplitGroup();
+
+    // Reported at the JSFX's own rate, so scaled back to the host's when oversampled
+    int latencySamples = JesusonicAPI.sx_getCurrentLatency(newInstance) / oversamplingFactor + oversamplingLatency;
     currentJSFXLatency.store(latencySamples, std::memory_order_relaxed);
-    setLatencySamples(latencySamples);
+    setLatencySamples(getTotalLatencySamples());
 
     // Get effect name and author
     const char* description = sxInstance->m_description.Get();
@@ -1284,13 +2714,406 @@ bool AudioPluginAudioProcessor::loadJSFX(const juce::File& jsfxFile)
                                                                 : jsfxFile.getFileNameWithoutExtension();
     }
 
-    currentJSFXAuthor = JsfxHelper::parseJSFXAuthor(jsfxFile);
+    const auto script = fileCache->getScriptInfo(jsfxFile);
+    currentJSFXAuthor = script ? script->author : juce::String("Unknown");
 
     // Trigger preset refresh
     if (presetLoader)
         presetLoader->requestRefresh(jsfxFile.getFullPathName());
+}
 
-    return true;
+void AudioPluginAudioProcessor::publishToAudioThread(
+    SX_Instance* instance,
+    std::unique_ptr<ParameterSyncManager::Binding> sync
+)
+{
+    auto handoff = std::make_unique<InstanceHandoff>();
+    handoff->instance = instance;
+    handoff->sync = std::move(sync);
+
+    // If the audio thread never picked up the previously published instance, it's still ours to destroy
+    auto* previous = pendingInstance.exchange(handoff.release(), std::memory_order_acq_rel);
+    if (std::unique_ptr<InstanceHandoff> superseded{previous})
+        retireInstance(superseded->instance);
+
+    // Presets still queued for the previous instance must not reach this one
+    presetQueue.submitBarrier(instance);
+}
+
+void AudioPluginAudioProcessor::setCurrentPresetName(const juce::String& presetName)
+{
+    currentPresetName = presetName;
+    xrunDetector.setContext(getCurrentJSFXPath(), currentPresetName);
+}
+
+void AudioPluginAudioProcessor::adoptPublishedInstance()
+{
+    // Retry handing back an outgoing instance or binding if the retire queue was full last time
+    if (fadingInstance && crossfadeSamplesRemaining == 0 && retireFromAudioThread(fadingInstance))
+        fadingInstance = nullptr;
+
+    if (retiredHandoff && retireHandoffFromAudioThread(retiredHandoff))
+        retiredHandoff = nullptr;
+
+    // Let a running crossfade finish before starting the next one
+    if (fadingInstance || retiredHandoff || pendingInstance.load(std::memory_order_relaxed) == nullptr)
+        return;
+
+    auto* incoming = pendingInstance.exchange(nullptr, std::memory_order_acq_rel);
+    if (incoming == nullptr)
+        return;
+
+    fadingInstance = audioInstance;
+    audioInstance = incoming->instance;
+    incoming->instance = nullptr;
+
+    // Sync follows the new instance from this block on; the hand-off now carries the old binding
+    parameterSync.bind(incoming->sync);
+    if (!retireHandoffFromAudioThread(incoming))
+        retiredHandoff = incoming;
+
+    silenceGate.reset();
+
+    const double fadeMs = instanceCrossfadeMs.load(std::memory_order_relaxed);
+    const int fadeLength = juce::roundToInt(fadeMs * 0.001 * getSampleRate());
+    crossfadeLengthSamples = juce::jmax(1, fadeLength);
+    crossfadeSamplesRemaining = (fadingInstance != nullptr) ? juce::jmax(0, fadeLength) : 0;
+
+    // The outgoing instance keeps its filter history; the incoming one starts from silence
+    if (audioOversampling)
+    {
+        std::swap(audioOversampling->main, audioOversampling->fading);
+        audioOversampling->main->reset();
+    }
+}
+
+bool AudioPluginAudioProcessor::retireFromAudioThread(SX_Instance* instance)
+{
+    return reclaimer.retireFromAudioThread(
+        instance,
+        [](void* retired) { destroyInstance(static_cast<SX_Instance*>(retired)); }
+    );
+}
+
+bool AudioPluginAudioProcessor::retireHandoffFromAudioThread(InstanceHandoff* handoff)
+{
+    return reclaimer.retireFromAudioThread(
+        handoff,
+        [](void* retired) { delete static_cast<InstanceHandoff*>(retired); }
+    );
+}
+
+void AudioPluginAudioProcessor::retireInstance(SX_Instance* instance)
+{
+    if (instance)
+        reclaimer.retire([instance] { destroyInstance(instance); });
+}
+
+void AudioPluginAudioProcessor::destroyInstance(SX_Instance* instance)
+{
+    if (!instance)
+        return;
+
+    juce::SharedResourcePointer<JsfxWorkerPool> pool;
+    const juce::ScopedLock lifecycleLock(pool->instanceLifecycleLock);
+    JesusonicAPI.sx_destroyInstance(instance);
+}
+
+void AudioPluginAudioProcessor::reclaimAudioThreadInstances()
+{
+    if (std::unique_ptr<InstanceHandoff> pending{pendingInstance.exchange(nullptr, std::memory_order_acq_rel)})
+        destroyInstance(pending->instance);
+
+    delete retiredHandoff;
+    retiredHandoff = nullptr;
+
+    destroyInstance(audioInstance);
+    destroyInstance(fadingInstance);
+    audioInstance = nullptr;
+    fadingInstance = nullptr;
+    crossfadeSamplesRemaining = 0;
+
+    auto* pendingGroup = pendingSplit.exchange(nullptr, std::memory_order_acq_rel);
+    if (pendingGroup != noSplitRequest)
+        destroySplitGroup(pendingGroup);
+
+    destroySplitGroup(audioSplit);
+    audioSplit = nullptr;
+
+    auto* pendingOversamplers = pendingOversampling.exchange(nullptr, std::memory_order_acq_rel);
+    if (pendingOversamplers != noOversamplingRequest)
+        delete pendingOversamplers;
+
+    delete audioOversampling;
+    audioOversampling = nullptr;
+
+    delete chainState.exchange(nullptr, std::memory_order_acq_rel);
+    for (auto& stage : chainStages)
+        destroyInstance(stage.instance);
+    chainStages.clear();
+
+    delete graphState.exchange(nullptr, std::memory_order_acq_rel);
+    for (auto& node : graphNodes)
+        destroyInstance(node.instance);
+    graphNodes.clear();
+    graphEdges.clear();
+}
+
+//==============================================================================
+void AudioPluginAudioProcessor::rebuildSplitGroup()
+{
+    // The snapshot below reads the running instance; prepareToPlay() and setStateInformation()
+    // may come from a host thread while audio runs, so those rebuild from the message thread
+    if (!isNonRealtime() && !juce::MessageManager::getInstance()->isThisTheMessageThread())
+    {
+        ++splitGeneration;
+        juce::WeakReference<AudioPluginAudioProcessor> weakThis(this);
+        juce::MessageManager::callAsync(
+            [weakThis]()
+            {
+                if (auto* self = weakThis.get())
+                    self->rebuildSplitGroup();
+            }
+        );
+        return;
+    }
+
+    // Supersedes any group still being built
+    const auto generation = ++splitGeneration;
+    const int numChannels = getTotalNumInputChannels();
+    const auto sliceSizes = JsfxSplitGroup::computeSliceSizes(splitMode, splitGroups, numChannels);
+
+    if (!sxInstance || sliceSizes.empty() || isShuttingDown.load(std::memory_order_acquire))
+    {
+        publishSplitGroup(nullptr);
+        return;
+    }
+
+    // The copies run alongside the owner on the realtime pool
+    ensureRealtimePool();
+
+    // Copies start from the owner's current state; later changes are mirrored by the audio thread
+    int stateLength = 0;
+    const char* stateText = JesusonicAPI.sx_saveState(sxInstance, &stateLength);
+    std::string state;
+    if (stateText && stateLength > 0)
+        state.assign(stateText, static_cast<size_t>(stateLength));
+
+    const juce::File jsfxFile(getCurrentJSFXPath());
+    SX_Instance* const owner = sxInstance;
+    const double sampleRate = getJsfxSampleRate();
+    const int capacity = juce::jmax(lastSamplesPerBlock, PluginConstants::MaxAccumulatorBlockSize);
+
+    // Offline renders have no message loop to hand a group back through, and no audio thread
+    // running meanwhile: build it right here, as restoreJSFX() loads the JSFX
+    if (isNonRealtime())
+    {
+        publishSplitGroup(
+            buildSplitGroup(generation, sliceSizes, state, jsfxFile, owner, sampleRate, numChannels, capacity)
+        );
+        return;
+    }
+
+    juce::WeakReference<AudioPluginAudioProcessor> weakThis(this);
+
+    // The destructor waits for this counter, so the job may safely use `this`
+    pendingWorkerJobs.fetch_add(1, std::memory_order_acq_rel);
+
+    workerPool->pool.addJob(
+        [this, weakThis, generation, sliceSizes, state, jsfxFile, owner, sampleRate, numChannels, capacity]()
+        {
+            auto* group =
+                buildSplitGroup(generation, sliceSizes, state, jsfxFile, owner, sampleRate, numChannels, capacity);
+
+            juce::MessageManager::callAsync(
+                [weakThis, generation, owner, group]()
+                {
+                    auto* self = weakThis.get();
+                    if (self == nullptr)
+                    {
+                        destroySplitGroup(group);
+                        return;
+                    }
+
+                    // Superseded by a newer rebuild, or built for an instance that is no longer current
+                    if (generation != self->splitGeneration.load(std::memory_order_acquire)
+                        || owner != self->sxInstance)
+                    {
+                        destroySplitGroup(group);
+                        return;
+                    }
+
+                    self->publishSplitGroup(group);
+                }
+            );
+
+            pendingWorkerJobs.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    );
+}
+
+JsfxSplitGroup* AudioPluginAudioProcessor::buildSplitGroup(
+    juce::uint32 generation,
+    const std::vector<int>& sliceSizes,
+    const std::string& state,
+    const juce::File& jsfxFile,
+    SX_Instance* owner,
+    double sampleRate,
+    int numChannels,
+    int capacity
+)
+{
+    auto* group = new JsfxSplitGroup();
+    group->owner = owner;
+    group->numChannels = numChannels;
+    group->capacitySamples = capacity;
+
+    int firstChannel = 0;
+    for (size_t i = 0; i < sliceSizes.size(); ++i)
+    {
+        if (isShuttingDown.load(std::memory_order_acquire)
+            || generation != splitGeneration.load(std::memory_order_acquire))
+        {
+            destroySplitGroup(group);
+            return nullptr;
+        }
+
+        JsfxSplitGroup::Slice slice;
+        slice.firstChannel = firstChannel;
+        slice.numChannels = sliceSizes[i];
+        slice.instance = owner;
+        slice.buffer.setSize(1, capacity * slice.numChannels);
+        firstChannel += slice.numChannels;
+
+        if (i > 0)
+        {
+            slice.instance = createDetachedInstance(jsfxFile, sampleRate, slice.numChannels);
+            if (!slice.instance)
+            {
+                DBG("buildSplitGroup: Failed to create linked instance " + juce::String((int)i));
+                destroySplitGroup(group);
+                return nullptr;
+            }
+
+            if (!state.empty())
+                JesusonicAPI.sx_loadState(slice.instance, state.c_str());
+
+            group->copies.push_back(slice.instance);
+        }
+
+        group->slices.push_back(std::move(slice));
+    }
+
+    return group;
+}
+
+void AudioPluginAudioProcessor::ensureRealtimePool()
+{
+    std::call_once(
+        realtimePoolStarted,
+        [this]()
+        {
+            realtimePoolReference = std::make_unique<juce::SharedResourcePointer<RealtimeThreadPool>>();
+            realtimePool.store(&realtimePoolReference->get(), std::memory_order_release);
+        }
+    );
+}
+
+void AudioPluginAudioProcessor::publishSplitGroup(JsfxSplitGroup* group)
+{
+    // A group the audio thread never picked up is still ours to free
+    auto* superseded = pendingSplit.exchange(group ? group : noSplitRequest, std::memory_order_acq_rel);
+    if (superseded && superseded != noSplitRequest)
+        reclaimer.retire([superseded] { destroySplitGroup(superseded); });
+}
+
+void AudioPluginAudioProcessor::adoptOversampling()
+{
+    // A running crossfade keeps the rate both instances were started at
+    if (pendingOversampling.load(std::memory_order_relaxed) == nullptr
+        || (fadingInstance && crossfadeSamplesRemaining > 0))
+        return;
+
+    // The outgoing state goes back first; if the retire queue is full, try again next block
+    if (audioOversampling
+        && !reclaimer.retireFromAudioThread(
+            audioOversampling,
+            [](void* retired) { delete static_cast<OversamplingState*>(retired); }
+        ))
+        return;
+
+    auto* incoming = pendingOversampling.exchange(nullptr, std::memory_order_acq_rel);
+    audioOversampling = (incoming == noOversamplingRequest) ? nullptr : incoming;
+}
+
+void AudioPluginAudioProcessor::adoptSplitGroup()
+{
+    if (pendingSplit.load(std::memory_order_relaxed) == nullptr)
+        return;
+
+    // The outgoing group goes back first; if the retire queue is full, try again next block
+    if (audioSplit
+        && !reclaimer.retireFromAudioThread(
+            audioSplit,
+            [](void* retired) { destroySplitGroup(static_cast<JsfxSplitGroup*>(retired)); }
+        ))
+        return;
+
+    auto* incoming = pendingSplit.exchange(nullptr, std::memory_order_acq_rel);
+    audioSplit = (incoming == noSplitRequest) ? nullptr : incoming;
+}
+
+SX_Instance* AudioPluginAudioProcessor::createDetachedInstance(
+    const juce::File& jsfxFile,
+    double sampleRate,
+    int numChannels
+)
+{
+    juce::SharedResourcePointer<JsfxWorkerPool> pool;
+    const juce::ScopedLock lifecycleLock(pool->instanceLifecycleLock);
+
+    bool wantWak = false;
+    SX_Instance* instance = JesusonicAPI.sx_createInstance(
+        jsfxFile.getParentDirectory().getFullPathName().toRawUTF8(),
+        jsfxFile.getFileName().toRawUTF8(),
+        &wantWak
+    );
+
+    if (!instance)
+        return nullptr;
+
+    // No host or MIDI context: copies don't automate sliders and only the owner sees MIDI
+    JesusonicAPI.sx_extended(instance, JSFX_EXT_SET_SRATE, (void*)(intptr_t)sampleRate, nullptr);
+    JesusonicAPI.sx_updateHostNch(instance, numChannels);
+
+    // Run @init here rather than on the audio thread
+    if (instance->m_need_init)
+    {
+        instance->m_mutex.Enter();
+        instance->m_init_mutex.Enter();
+        if (instance->m_need_init)
+            instance->on_slider_change();
+        instance->m_init_mutex.Leave();
+        instance->m_mutex.Leave();
+    }
+
+    return instance;
+}
+
+void AudioPluginAudioProcessor::destroySplitGroup(JsfxSplitGroup* group)
+{
+    if (!group)
+        return;
+
+    for (auto* copy : group->copies)
+        destroyInstance(copy);
+
+    delete group;
+}
+
+void AudioPluginAudioProcessor::setInstanceCrossfadeMs(double milliseconds)
+{
+    instanceCrossfadeMs.store(juce::jmax(0.0, milliseconds), std::memory_order_relaxed);
 }
 
 void AudioPluginAudioProcessor::unloadJSFX()
@@ -1298,21 +3121,17 @@ void AudioPluginAudioProcessor::unloadJSFX()
     if (!sxInstance)
         return;
 
-    // Atomically clear instance while audio thread is suspended
-    // Both unloadJSFX and JsfxLiceComponent run on message thread, so no contention there
-    suspendProcessing(true);
-    SX_Instance* oldInstance = sxInstance;
+    // The audio thread fades the running instance out, retires it and stops syncing it
+    ++loadGeneration;
     sxInstance = nullptr;
-    suspendProcessing(false);
-
-    // Destroy old instance and reset state
-    JesusonicAPI.sx_destroyInstance(oldInstance);
-    parameterSync.reset();
+    publishToAudioThread(nullptr, nullptr);
+    rebuildSplitGroup();
 
     currentJSFXLatency.store(0, std::memory_order_relaxed);
-    setLatencySamples(0);
+    setLatencySamples(getTotalLatencySamples());
 
     apvts.state.setProperty(jsfxPathParamID, "", nullptr);
+    setCurrentPresetName({});
     currentJSFXName.clear();
     currentJSFXAuthor.clear();
     numActiveParams = 0;
@@ -1450,13 +3269,11 @@ void AudioPluginAudioProcessor::updateParameterMapping(bool initializeWithJsfxDe
             }
         }
     }
-
-    // Initialize the parameter sync manager with current state
-    parameterSync.initialize(parameterCache, sxInstance, numActiveParams, lastSampleRate);
 }
 
 //==============================================================================
 // MIDI callback for JSFX - called during sx_processSamples
+// Realtime safe: events are read from and written to the preallocated arenas only.
 double AudioPluginAudioProcessor::midiSendRecvCallback(
     void* ctx,
     int action,
@@ -1467,91 +3284,105 @@ double AudioPluginAudioProcessor::midiSendRecvCallback(
 )
 {
     auto* processor = static_cast<AudioPluginAudioProcessor*>(ctx);
-    if (!processor)
+    if (!processor || !msg1 || !msg23 || !ts)
         return 0.0;
 
-    juce::ignoreUnused(midibus); // Not handling multi-bus MIDI yet
-
-    if (action == 0x100) // JSFX sends MIDI out (to host)
-    {
-        // Protocol: JSFX needs buffer to write MIDI output
-        // 1. JSFX calls us with required length in msg1
-        // 2. We allocate buffer and return pointer via msg23
-        // 3. We return from callback
-        // 4. JSFX writes MIDI data to buffer
-        // 5. JSFX function returns (but we've already returned from callback!)
-        //
-        // Problem: We can't add to output buffer after JSFX writes since callback already returned.
-        // Solution: JSFX actually expects us to just provide a buffer. The _midi_send_str function
-        // immediately writes after our callback returns, so the data is there.
-        // But we can't process it in this callback context.
-        //
-        // Workaround: Check REAPER source or other hosts... Actually, I think the pattern is:
-        // We provide a persistent buffer, JSFX writes to it, and we process it later.
-        // But that's complex. Let me try a simpler approach: Pre-allocate buffer and process
-        // it immediately after return using a flag.
-
-        if (!msg1 || !msg23 || !ts)
-            return 0.0;
+    // JSFX midi_bus: selects the output bus on send, reports the event's bus on receive
+    const int bus = midibus ? juce::roundToInt(*midibus) : 0;
+
+    // JSFX timestamps are relative to the current sx_processSamples call, which may be a sub-block,
+    // and count oversampled frames when the JSFX runs oversampled
+    const int blockStart = processor->currentMidiBlockStart;
+    const int timeScale = processor->currentMidiTimeScale;
+    const int blockEnd = blockStart + processor->currentMidiBlockSize;
+    const int lastSample = juce::jmax(0, processor->currentMidiBlockSize - 1);
 
-        int length = static_cast<int>(*msg1);
-        if (length <= 0 || length > 8192) // Sanity check
+    if (action == 0x100) // JSFX sends a buffer (midisend_buf/midisend_str, including sysex)
+    {
+        // Protocol: *msg1 holds the length and we return a buffer through *msg23.
+        // JSFX writes the message into it after we return, so we reserve the space in
+        // the output arena now and the bytes are read once sx_processSamples returns.
+        auto* output = processor->currentMidiOutput;
+        const int length = static_cast<int>(*msg1);
+        if (!output || length <= 0 || length > PluginConstants::MidiMaxSysExBytes)
             return 0.0;
 
-        // Allocate buffer for JSFX to write to
-        processor->midiTempBuffer.resize(length);
-        unsigned char* buffer = processor->midiTempBuffer.data();
+        const int sampleOffset = blockStart + juce::jlimit(0, lastSample, static_cast<int>(*ts) / timeScale);
+        auto* buffer = output->reserve(sampleOffset, bus, length);
+        if (!buffer)
+            return 0.0;
 
-        // Return buffer pointer to JSFX
         *reinterpret_cast<unsigned char**>(msg23) = buffer;
+        return 1.0;
+    }
+    else if (action == -0x100) // JSFX receives a buffer (midirecv_buf/midirecv_str, including sysex)
+    {
+        auto* input = processor->currentMidiInput;
+        const auto* event = input ? input->readNext(blockEnd) : nullptr;
+        if (!event)
+            return 0.0;
 
-        // Return success - JSFX will now write to buffer
-        // NOTE: After this returns, JSFX writes to buffer, but we can't process it here.
-        // This is a fundamental design issue with the callback API.
-        // For now, returning 0 to indicate we can't handle output yet.
-        // TODO: Implement proper buffering mechanism
-        return 0.0; // Disabled for now - need better implementation
+        // Mirror of the send protocol: length in *msg1, pointer to the bytes in *msg23
+        *ts = static_cast<double>(juce::jmax(0, event->sampleOffset - blockStart) * timeScale);
+        *msg1 = static_cast<double>(event->size);
+        *reinterpret_cast<const unsigned char**>(msg23) = input->getData(*event);
+        if (midibus)
+            *midibus = static_cast<double>(event->bus);
+        return 1.0;
     }
-    else if (action < 0) // JSFX requests next MIDI event (action < 0 per VST2 implementation)
+    else if (action < 0) // JSFX requests next short MIDI event (midirecv, per VST2 implementation)
     {
-        // Match VST2 implementation: Iterate through MIDI buffer sequentially
         // JSFX calls this repeatedly to get all MIDI events one by one
         // Returns timestamp in *ts, status in *msg1, data bytes in *msg23
-
-        if (!processor->currentMidiInputBuffer || !processor->midiInputIterator || !msg1 || !msg23 || !ts)
+        auto* input = processor->currentMidiInput;
+        if (!input)
             return 0.0;
 
-        // Get next MIDI message from iterator
-        juce::MidiMessage message;
-        int samplePosition;
-
-        if (processor->midiInputIterator->getNextEvent(message, samplePosition))
+        while (const auto* event = input->readNext(blockEnd))
         {
-            // Return MIDI data in JSFX format:
-            // *ts = sample position (deltaFrames)
-            // *msg1 = status byte
-            // *msg23 = data bytes packed as (data1 + (data2 << 8))
-
-            *ts = static_cast<double>(samplePosition);
+            const auto* rawData = input->getData(*event);
 
-            const uint8_t* rawData = message.getRawData();
-            int numBytes = message.getRawDataSize();
+            // Sysex doesn't fit msg1/msg23; only the buffer variant can receive it
+            if (MidiEventArena::isSysEx(rawData, event->size))
+                continue;
 
-            if (numBytes >= 1)
-            {
-                *msg1 = static_cast<double>(rawData[0]); // Status byte
+            *ts = static_cast<double>(juce::jmax(0, event->sampleOffset - blockStart) * timeScale);
+            *msg1 = static_cast<double>(rawData[0]); // Status byte
 
-                int data1 = (numBytes >= 2) ? rawData[1] : 0;
-                int data2 = (numBytes >= 3) ? rawData[2] : 0;
-                *msg23 = static_cast<double>(data1 + (data2 << 8));
+            int data1 = (event->size >= 2) ? rawData[1] : 0;
+            int data2 = (event->size >= 3) ? rawData[2] : 0;
+            *msg23 = static_cast<double>(data1 + (data2 << 8));
 
-                return 1.0; // Success - event available
-            }
+            if (midibus)
+                *midibus = static_cast<double>(event->bus);
+            return 1.0; // Success - event available
         }
 
         // No more MIDI events
         return 0.0;
     }
+    else if (action > 0) // JSFX sends a short MIDI event (midisend)
+    {
+        auto* output = processor->currentMidiOutput;
+        if (!output)
+            return 0.0;
+
+        const int status = static_cast<int>(*msg1) & 0xff;
+        const int packedData = static_cast<int>(*msg23);
+        const juce::uint8 message[3] = {
+            static_cast<juce::uint8>(status),
+            static_cast<juce::uint8>(packedData & 0x7f),
+            static_cast<juce::uint8>((packedData >> 8) & 0x7f)
+        };
+
+        // Status bytes without a valid length (e.g. stray sysex bytes) are dropped
+        const int length = juce::MidiMessage::getMessageLengthFromFirstByte(message[0]);
+        if (status < 0x80 || length < 1 || length > 3)
+            return 0.0;
+
+        const int sampleOffset = blockStart + juce::jlimit(0, lastSample, static_cast<int>(*ts) / timeScale);
+        return output->add(sampleOffset, bus, message, length) ? 1.0 : 0.0;
+    }
 
     return 0.0;
 }
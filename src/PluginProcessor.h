@@ -3,62 +3,38 @@
 #include <jsfx.h>
 //
 
+#include "BlockAccumulator.h"
+#include "BypassDelay.h"
+#include "JsfxChain.h"
+#include "JsfxGraph.h"
 #include "JsfxHelper.h"
+#include "JsfxOversampler.h"
+#include "JsfxSplitGroup.h"
+#include "JsfxFileCache.h"
+#include "JsfxWorkerPool.h"
+#include "MidiEventArena.h"
 #include "ParameterSyncManager.h"
 #include <Config.h>
+#include "DeferredReclaimer.h"
+#include "PresetApplyQueue.h"
+#include "RealtimeThreadPool.h"
 #include "PresetCache.h"
 #include "PresetLoader.h"
+#include "ProcessProfiler.h"
 #include "ReaperPresetConverter.h"
+#include "RoutingPlan.h"
+#include "SilenceGate.h"
+#include "XrunDetector.h"
 
 #include <atomic>
+#include <mutex>
+#include <type_traits>
 #include <juce_audio_utils/juce_audio_utils.h>
 #include <juce_data_structures/juce_data_structures.h>
 #include <juce_dsp/juce_dsp.h>
 
 extern jsfxAPI JesusonicAPI;
 
-//==============================================================================
-// Lock-free routing configuration for realtime-safe communication
-struct RoutingConfig
-{
-    // Routing matrices stored as flat arrays
-    // Input: JUCE input channels -> JSFX channels (rows = JUCE, cols = JSFX)
-    std::array<std::array<bool, PluginConstants::MaxChannels>, PluginConstants::MaxChannels> inputRouting{};
-
-    // Sidechain: JUCE sidechain channels -> JSFX channels (rows = JUCE SC, cols = JSFX)
-    std::array<std::array<bool, PluginConstants::MaxChannels>, PluginConstants::MaxChannels> sidechainRouting{};
-
-    // Output: JSFX channels -> JUCE output channels (rows = JSFX, cols = JUCE)
-    std::array<std::array<bool, PluginConstants::MaxChannels>, PluginConstants::MaxChannels> outputRouting{};
-
-    int numJuceInputs = 0;
-    int numJuceSidechains = 0;
-    int numJuceOutputs = 0;
-    int numJsfxInputs = 0;
-    int numJsfxSidechains = 0;
-    int numJsfxOutputs = 0;
-
-    // Initialize with 1:1 diagonal routing
-    void setDiagonal()
-    {
-        // Clear all
-        for (auto& row : inputRouting)
-            row.fill(false);
-        for (auto& row : sidechainRouting)
-            row.fill(false);
-        for (auto& row : outputRouting)
-            row.fill(false);
-
-        // Set diagonals
-        for (int i = 0; i < juce::jmin(numJuceInputs, numJsfxInputs); ++i)
-            inputRouting[i][i] = true;
-        for (int i = 0; i < juce::jmin(numJuceSidechains, numJsfxSidechains); ++i)
-            sidechainRouting[i][i] = true;
-        for (int i = 0; i < juce::jmin(numJsfxOutputs, numJuceOutputs); ++i)
-            outputRouting[i][i] = true;
-    }
-};
-
 //==============================================================================
 class AudioPluginAudioProcessor final
     : public juce::AudioProcessor
@@ -77,8 +53,12 @@ public:
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
     void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using AudioProcessor::processBlock;
+    void processBlockBypassed(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // JSFX processes in double, so hosts with a 64-bit mix engine can skip both conversions
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -113,11 +93,156 @@ public:
         return sxInstance;
     }
 
+    // Compiles and publishes on the calling (message) thread; used for offline state restoration
     bool loadJSFX(const juce::File& jsfxFile);
+
+    // Compiles on a worker thread and hot-swaps the running instance when ready.
+    // onLoaded is called on the message thread, unless a newer load supersedes this one.
+    void loadJSFXAsync(const juce::File& jsfxFile, std::function<void(bool success)> onLoaded);
+
     void unloadJSFX();
 
+    // Session restore compiles the JSFX on the shared worker pool, so a host opening many
+    // instances compiles them side by side; the plugin outputs silence until it is live.
+    // True while the restored JSFX is still compiling (message thread).
+    bool isRestoringJSFX() const
+    {
+        return numPendingRestores.load(std::memory_order_acquire) > 0;
+    }
+
+    // Across every instance in the process: restored JSFX now live, out of those restored
+    // since the last time none were compiling. Equal when the session is ready.
+    void getSessionRestoreProgress(int& numLive, int& numRestored) const;
+
+    // Called on the message thread when a restore starts, and when its JSFX is live or
+    // failed to load; isRestoringJSFX() tells which
+    std::function<void()> onRestoreStateChanged;
+
+    // Length of the crossfade between the outgoing and incoming JSFX on a hot-swap
+    void setInstanceCrossfadeMs(double milliseconds);
+
+    double getInstanceCrossfadeMs() const
+    {
+        return instanceCrossfadeMs.load(std::memory_order_relaxed);
+    }
+
+    // Opt-in re-blocking for tiny host buffers: the JSFX runs in fixed blocks of this many
+    // samples, adding the same amount of latency. 0 (default) processes host blocks directly.
+    void setBlockAccumulatorSize(int numSamples);
+
+    int getBlockAccumulatorSize() const
+    {
+        return requestedAccumulatorBlockSize.load(std::memory_order_relaxed);
+    }
+
+    // Linked-split: run copies of the JSFX on slices of the channels, in parallel.
+    // customGroups lists channel counts per copy for SplitMode::Custom, e.g. "2,2,4".
+    void setSplitMode(SplitMode mode, const juce::String& customGroups = {});
+
+    SplitMode getSplitMode() const
+    {
+        return splitMode;
+    }
+
+    juce::String getSplitGroups() const
+    {
+        return splitGroups;
+    }
+
+    // Oversampling: the main JSFX runs at factor (1, 2, 4 or 8) times the host rate. Linear phase uses FIR
+    // filters with more latency, otherwise IIR. The chain and graph stay at the host rate. Message thread.
+    void setOversampling(int factor, bool linearPhase);
+
+    int getOversamplingFactor() const
+    {
+        return oversamplingFactor;
+    }
+
+    bool isOversamplingLinearPhase() const
+    {
+        return oversamplingLinearPhase;
+    }
+
+    // JSFX chain: further effects run in order after the main JSFX, inside this plugin instance.
+    // Stages have no host parameters; their state is saved with the session. Message thread.
+    bool addChainStage(const juce::File& jsfxFile);
+    void removeChainStage(int index);
+    void moveChainStage(int fromIndex, int toIndex);
+    void clearChain();
+    juce::File getChainStageFile(int index) const;
+
+    int getNumChainStages() const
+    {
+        return static_cast<int>(chainStages.size());
+    }
+
+    // Pipelined chains run the main JSFX and every stage on its own core, each stage one block
+    // behind the one before it. Takes effect while the block accumulator gives fixed-size blocks.
+    void setChainPipelined(bool shouldPipeline);
+
+    bool isChainPipelined() const
+    {
+        return chainPipelined;
+    }
+
+    // JSFX graph: a small DAG of further effects, run after the main JSFX and before the chain.
+    // Edges route channels through a matrix; JsfxGraph::graphIO as an endpoint is the graph's input
+    // (source) or output (destination). Independent branches run in parallel. Until an edge reaches
+    // the graph output, the graph is left out and audio passes it by. Message thread.
+    int addGraphNode(const juce::File& jsfxFile);
+    void removeGraphNode(int index);
+    bool connectGraphNodes(int source, int destination, const RoutingConfig::Matrix& matrix);
+    void disconnectGraphNodes(int source, int destination);
+    bool hasGraphConnection(int source, int destination) const;
+    void clearGraph();
+    juce::File getGraphNodeFile(int index) const;
+
+    int getNumGraphNodes() const
+    {
+        return static_cast<int>(graphNodes.size());
+    }
+
+    // When off, every graph node runs on the audio thread in a fixed order (e.g. to compare offline renders)
+    void setGraphMultithreaded(bool shouldUseThreads);
+
+    bool isGraphMultithreaded() const
+    {
+        return graphMultithreaded.load(std::memory_order_relaxed);
+    }
+
+    // Sleep on silence (off by default): the JSFX isn't run while its input and tail are silent.
+    // A negative tail length detects the tail from the output; it's also what the host is told.
+    void setSleepOnSilence(bool shouldSleep);
+    void setTailLengthSeconds(double seconds);
+
+    bool isSleepOnSilenceEnabled() const
+    {
+        return silenceGate.isEnabled();
+    }
+
+    double getUserTailLengthSeconds() const
+    {
+        return silenceGate.getTailSeconds();
+    }
+
     juce::String getCurrentJSFXPath() const;
 
+    // Per-stage processBlock timings; copy the counters out from any thread
+    const ProcessProfiler& getProfiler() const
+    {
+        return profiler;
+    }
+
+    // What the timer picks up from the audio thread: reports latency changes to the host and frees
+    // presets and xrun records it is done with. Offline callers without a message loop call it themselves.
+    void collectAudioThreadResults();
+
+    // Blocks that overran their real-time budget (message thread; collected by the timer)
+    XrunDetector& getXrunDetector()
+    {
+        return xrunDetector;
+    }
+
     juce::String getCurrentJSFXName() const
     {
         return currentJSFXName;
@@ -141,6 +266,23 @@ public:
     juce::String getJSFXParameterDisplayText(int index, double value) const;
     bool isJSFXParameterVisible(int index) const;
 
+    // Sub-block size for smoothed parameter ramps in samples; 0 disables smoothing (any thread)
+    void setParameterSmoothingBlockSize(int numSamples)
+    {
+        parameterSync.setSmoothingBlockSize(numSamples);
+    }
+
+    int getParameterSmoothingBlockSize() const
+    {
+        return parameterSync.getSmoothingBlockSize();
+    }
+
+    // Called by the JSFX slider automation callback (any thread)
+    void markJsfxParameterChanged(int index)
+    {
+        parameterSync.markJsfxChanged(index);
+    }
+
     juce::AudioProcessorValueTreeState& getAPVTS()
     {
         return apvts;
@@ -154,13 +296,18 @@ public:
     // Update routing configuration from UI (called from message thread)
     void updateRoutingConfig(const RoutingConfig& newConfig);
 
+    // Restore routing from the encoded string saved in the state ("in,sidechain,out" bit rows).
+    // Needs the channel counts from prepareToPlay().
+    void restoreRoutingFromString(const juce::String& routingStr);
+
     // Preset loading (works with or without editor)
     // Call this from:
     // - Editor UI when user selects preset from LibraryBrowser
     // - processBlock() when handling MIDI Program Change messages
     // - Host automation/preset recall
     // - Any other preset loading scenario
-    bool loadPresetFromBase64(const juce::String& base64Data);
+    // presetName only labels the preset in diagnostics (deadline-miss log)
+    bool loadPresetFromBase64(const juce::String& base64Data, const juce::String& presetName = {});
 
     // Get current JSFX state as base64 encoded string
     juce::String getCurrentStateAsBase64() const;
@@ -182,8 +329,129 @@ public:
     void refreshPresets();
 
 private:
-    // Helper to restore routing from encoded string
-    void restoreRoutingFromString(const juce::String& routingStr);
+    // Shared implementation of the float and double processBlock overloads
+    template <typename FloatType>
+    void processBlockAccumulated(juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages);
+
+    template <typename FloatType>
+    BlockAccumulator<FloatType>& getBlockAccumulator() noexcept
+    {
+        if constexpr (std::is_same_v<FloatType, double>)
+            return blockAccumulatorDouble;
+        else
+            return blockAccumulator;
+    }
+
+    // JSFX, graph and chain latency plus the block accumulator's
+    int getTotalLatencySamples() const;
+
+    template <typename FloatType>
+    void processBlockInternal(juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages);
+
+    template <typename FloatType>
+    void processBlockWithBypass(juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages, bool bypassed);
+
+    //==============================================================================
+    // JSFX instance lifecycle
+
+    // A compiled instance (null to fade out to no instance) with the parameter sync binding
+    // built for it, so the audio thread switches both over at once
+    struct InstanceHandoff
+    {
+        SX_Instance* instance = nullptr;
+        std::unique_ptr<ParameterSyncManager::Binding> sync;
+    };
+
+    // As loadJSFXAsync; when reportSuperseded, onLoaded(false) is also called if a newer load wins
+    void loadJSFXInBackground(
+        const juce::File& jsfxFile,
+        std::function<void(bool success)> onLoaded,
+        bool reportSuperseded
+    );
+    // Session restore: in the background, or synchronously when rendering offline
+    void restoreJSFX(const juce::File& jsfxFile);
+    // Thread-agnostic: only uses its arguments, so it can run on a worker thread
+    SX_Instance* compileJSFX(const juce::File& jsfxFile, double sampleRate, int numChannels);
+    // Message thread: make a compiled instance current and hand it to the audio thread
+    void publishJSFX(SX_Instance* newInstance, const juce::File& jsfxFile);
+    void publishToAudioThread(SX_Instance* instance, std::unique_ptr<ParameterSyncManager::Binding> sync);
+    void setCurrentPresetName(const juce::String& presetName);
+    // Audio thread: adopt a newly published instance and start the crossfade
+    void adoptPublishedInstance();
+    bool retireFromAudioThread(SX_Instance* instance);
+    bool retireHandoffFromAudioThread(InstanceHandoff* handoff);
+    // Any non-realtime thread: destroy once the audio thread can no longer see the instance
+    void retireInstance(SX_Instance* instance);
+    static void destroyInstance(SX_Instance* instance);
+    // Only valid once the audio thread has stopped (destructor)
+    void reclaimAudioThreadInstances();
+
+    // Linked-split groups: built on a worker for the current instance, adopted by the audio thread.
+    // The owner's state is snapshotted on the message thread (or inline when rendering offline).
+    void rebuildSplitGroup();
+    JsfxSplitGroup* buildSplitGroup(
+        juce::uint32 generation,
+        const std::vector<int>& sliceSizes,
+        const std::string& state,
+        const juce::File& jsfxFile,
+        SX_Instance* owner,
+        double sampleRate,
+        int numChannels,
+        int capacity
+    );
+    void publishSplitGroup(JsfxSplitGroup* group);
+    void adoptSplitGroup();
+    static void destroySplitGroup(JsfxSplitGroup* group);
+
+    // Starts the shared realtime pool if this instance hasn't yet (any thread but the audio thread)
+    void ensureRealtimePool();
+
+    // Oversamplers for the main JSFX: built on the message thread, adopted by the audio thread
+    void publishOversampling();
+    void adoptOversampling();
+
+    // Rate the main JSFX (and its split copies) runs at, including oversampling. Message thread.
+    double getJsfxSampleRate() const
+    {
+        return lastSampleRate * oversamplingFactor;
+    }
+
+    // Instance without host or MIDI callbacks, for split copies, chain stages and graph nodes (any thread).
+    // None of them sees MIDI.
+    static SX_Instance* createDetachedInstance(const juce::File& jsfxFile, double sampleRate, int numChannels);
+
+    // A chain stage or graph node. The session saves the state it was added or restored with:
+    // once published, the instance belongs to the audio thread.
+    struct DetachedEffect
+    {
+        juce::File file;
+        SX_Instance* instance = nullptr;
+        juce::String stateText;
+    };
+
+    // Compiles the effect and loads stateText into it, or takes a new effect's initial state (any thread)
+    static DetachedEffect compileDetachedEffect(
+        const juce::File& jsfxFile,
+        const juce::String& stateText,
+        double sampleRate,
+        int numChannels
+    );
+
+    // JSFX chain: the message thread edits chainStages and publishes a new snapshot. Restored
+    // stages are compiled on a worker and installed from the message thread.
+    bool appendChainStage(const juce::File& jsfxFile);
+    void publishChain();
+    void storeChainInState();
+    void restoreChainFromState();
+    void installRestoredChain(std::vector<DetachedEffect> stages, bool pipelined);
+
+    // JSFX graph: the message thread edits graphNodes/graphEdges and publishes a new snapshot.
+    // Restored like the chain; saved edges refer to the saved node order.
+    bool appendGraphNode(const juce::File& jsfxFile);
+    void publishGraph();
+    void storeGraphInState();
+    void restoreGraphFromState();
+    void installRestoredGraph(std::vector<DetachedEffect> nodes, std::vector<JsfxGraph::EdgeDescription> savedEdges);
 
     //==============================================================================
     void timerCallback() override;
@@ -192,6 +460,25 @@ private:
     void updateParameterMapping(bool initializeWithJsfxDefaults = false);
 
     static constexpr const char* jsfxPathParamID = "jsfxFilePath";
+    static constexpr const char* blockAccumulatorSizeID = "blockAccumulatorSize";
+    static constexpr const char* sleepOnSilenceID = "sleepOnSilence";
+    static constexpr const char* tailLengthSecondsID = "tailLengthSeconds";
+    static constexpr const char* splitModeID = "splitMode";
+    static constexpr const char* splitGroupsID = "splitGroups";
+    static constexpr const char* oversamplingFactorID = "oversamplingFactor";
+    static constexpr const char* oversamplingLinearPhaseID = "oversamplingLinearPhase";
+    static constexpr const char* chainPipelinedID = "chainPipelined";
+    static constexpr const char* chainTreeType = "JsfxChain";
+    static constexpr const char* chainStageType = "Stage";
+    static constexpr const char* graphMultithreadedID = "graphMultithreaded";
+    static constexpr const char* graphTreeType = "JsfxGraph";
+    static constexpr const char* graphNodeType = "Node";
+    static constexpr const char* graphEdgeType = "Edge";
+    static constexpr const char* graphEdgeSourceID = "source";
+    static constexpr const char* graphEdgeDestinationID = "destination";
+    static constexpr const char* graphEdgeConnectionsID = "connections";
+    static constexpr const char* effectPathID = "path";
+    static constexpr const char* effectStateID = "state";
 
     struct ParameterRange
     {
@@ -204,21 +491,120 @@ private:
     std::array<juce::RangedAudioParameter*, PluginConstants::MaxParameters> parameterCache;
     std::array<ParameterRange, PluginConstants::MaxParameters> parameterRanges;
 
+    // Message thread view of the current JSFX (UI, parameter queries, presets)
     SX_Instance* sxInstance = nullptr;
     juce::AudioBuffer<double> tempBuffer;
 
+    // Lock-free instance hand-off: the message thread stores a hand-off here and the audio
+    // thread exchanges it out at the start of a block. Whoever takes a pointer out of the slot owns it.
+    std::atomic<InstanceHandoff*> pendingInstance{nullptr};
+
+    // Owned by the audio thread: the running instance and the one being faded out
+    SX_Instance* audioInstance = nullptr;
+    SX_Instance* fadingInstance = nullptr;
+    InstanceHandoff* retiredHandoff = nullptr; // Carries the replaced binding; retried if the retire queue was full
+    int crossfadeLengthSamples = 0;
+    int crossfadeSamplesRemaining = 0;
+    juce::AudioBuffer<double> fadeBuffer; // Interleaved buffer for the outgoing instance
+    std::atomic<double> instanceCrossfadeMs{PluginConstants::InstanceCrossfadeMs};
+
+    // Background compilation and destruction
+    juce::SharedResourcePointer<JsfxWorkerPool> workerPool;
+    std::atomic<juce::uint32> loadGeneration{0}; // Bumped per load so superseded async loads are discarded
+    std::atomic<int> pendingWorkerJobs{0};       // Jobs that reference this processor
+    std::atomic<bool> isShuttingDown{false};
+    std::atomic<int> numPendingRestores{0}; // Restores queued or compiling, each counted in workerPool too
+
+    // Sources and metadata read once per file for all instances
+    juce::SharedResourcePointer<JsfxFileCache> fileCache;
+
+    // Linked-split: the message thread stores a group (or noSplitRequest) in pendingSplit, the
+    // audio thread exchanges it into audioSplit. Whoever takes a group out of the slot owns it.
+    SplitMode splitMode = SplitMode::Off; // Message thread
+    juce::String splitGroups;             // Message thread
+    std::atomic<juce::uint32> splitGeneration{0};
+    std::atomic<JsfxSplitGroup*> pendingSplit{nullptr};
+    JsfxSplitGroup* audioSplit = nullptr;
+
+    // Realtime helper threads for split copies, pipelined chains and threaded graphs: shared across
+    // the process, and only started once this instance first runs something in parallel
+    std::once_flag realtimePoolStarted;
+    std::unique_ptr<juce::SharedResourcePointer<RealtimeThreadPool>> realtimePoolReference;
+    std::atomic<RealtimeThreadPool*> realtimePool{nullptr}; // Read by the audio thread
+    int lastSamplesPerBlock = 0;
+
+    // Oversampling, handed over like the split group (noOversamplingRequest switches it off). The
+    // outgoing instance of a crossfade keeps filtering through its own oversampler.
+    struct OversamplingState
+    {
+        std::unique_ptr<JsfxOversampler> main;
+        std::unique_ptr<JsfxOversampler> fading;
+    };
+
+    int oversamplingFactor = 1;           // Message thread
+    bool oversamplingLinearPhase = false; // Message thread
+    int oversamplingLatency = 0;          // Message thread: filter latency at the host rate
+    // Stored in pendingOversampling to ask the audio thread to stop oversampling. Never dereferenced.
+    static OversamplingState* const noOversamplingRequest;
+    std::atomic<OversamplingState*> pendingOversampling{nullptr};
+    OversamplingState* audioOversampling = nullptr;
+
+    // JSFX chain. Stage instances are owned here; the audio thread reads the published snapshot,
+    // which is valid until its next quiescent point, like the routing state.
+    std::vector<DetachedEffect> chainStages; // Message thread
+    bool chainPipelined = false;             // Message thread
+    std::atomic<juce::uint32> chainRestoreGeneration{0};
+    std::atomic<JsfxChain*> chainState{nullptr};
+    std::atomic<int> currentChainLatency{0}; // Audio thread -> timer (latency reporting)
+
+    // JSFX graph, published like the chain. Node instances are owned here.
+    std::vector<DetachedEffect> graphNodes;             // Message thread
+    std::vector<JsfxGraph::EdgeDescription> graphEdges; // Message thread
+    std::atomic<juce::uint32> graphRestoreGeneration{0};
+    std::atomic<JsfxGraph*> graphState{nullptr};
+    std::atomic<bool> graphMultithreaded{true};
+    std::atomic<int> currentGraphLatency{0}; // Audio thread -> timer (latency reporting)
+
+    // Frees instances and routing states once the audio thread can no longer see them.
+    // Declared after workerPool so it is destroyed first.
+    DeferredReclaimer reclaimer;
+
+    // Decoded presets, applied by the audio thread at the start of the next block
+    PresetApplyQueue presetQueue;
+
     juce::String currentJSFXName;
     juce::String currentJSFXAuthor;
+    juce::String currentPresetName; // Last preset loaded since the JSFX, empty if none
     juce::String jsfxRootDir;
     int numActiveParams = 0;
     double lastSampleRate = 44100.0;
 
     std::atomic<int> currentJSFXLatency{0};
-    juce::dsp::DelayLine<float> bypassDelayLine;
+
+    // Fixed-size re-blocking; only the one matching the host's precision is allocated
+    BlockAccumulator<float> blockAccumulator;
+    BlockAccumulator<double> blockAccumulatorDouble;
+    std::atomic<int> requestedAccumulatorBlockSize{0}; // Message thread -> audio thread
+    std::atomic<int> activeAccumulatorBlockSize{0};    // Audio thread -> timer (latency reporting)
+
+    // Skips the JSFX while input and tail are silent
+    SilenceGate silenceGate;
+    bool transportWasPlaying = false; // Audio thread, to wake the JSFX when the transport starts
+
+    // Host bypass: input delayed by the reported latency, crossfaded with the processed signal on toggles.
+    // Only the delay matching the host's precision is allocated.
+    BypassDelay<float> bypassDelay{reclaimer};
+    BypassDelay<double> bypassDelayDouble{reclaimer};
+    int bypassFadeLength = 1;        // Samples
+    int bypassFadePosition = 0;      // Audio thread: 0 is processing, bypassFadeLength is bypassed
+    bool accumulatorFlushed = false; // Audio thread: the accumulator was emptied during this bypass
 
     // Two-way parameter synchronization between APVTS and JSFX
     ParameterSyncManager parameterSync;
 
+    ProcessProfiler profiler;
+    XrunDetector xrunDetector;
+
     // Flag to force push APVTS to JSFX on first processBlock (set by setStateInformation)
     std::atomic<bool> needsForcePushApvtsToJsfx{false};
 
@@ -231,20 +617,30 @@ private:
     // Async preset loader
     std::unique_ptr<PresetLoader> presetLoader;
 
-    // Lock-free routing configuration (triple buffer pattern)
-    RoutingConfig routingConfigs[3]; // Triple buffer for lock-free updates
-    std::atomic<int> readIndex{0};   // Index used by audio thread (processBlock)
-    std::atomic<int> writeIndex{1};  // Index used by UI thread for writing
-    // Third buffer (index 2) is the swap buffer
+    // Lock-free routing configuration
+    // The message thread builds a new state and swaps it in; the old one is retired through
+    // the reclaimer, so the audio thread can use the state it loaded for the whole block.
+    struct RoutingState
+    {
+        RoutingConfig config;
+        RoutingPlan plan; // Compiled connection lists for config
+    };
+
+    std::atomic<RoutingState*> routingState{nullptr};
+    void publishRoutingState(const RoutingConfig& config);
 
     // MIDI support
     static double midiSendRecvCallback(void* ctx, int action, double* ts, double* msg1, double* msg23, double* midibus);
-    juce::MidiBuffer* currentMidiInputBuffer = nullptr;            // Set during processBlock
-    std::unique_ptr<juce::MidiBuffer::Iterator> midiInputIterator; // Iterator for reading MIDI sequentially
-    juce::MidiBuffer currentMidiOutputBuffer;                      // Accumulated during processBlock
-    std::vector<unsigned char> midiTempBuffer;                     // Temp storage for MIDI messages
+    MidiEventArena midiInputArena;               // Host MIDI for the current block
+    MidiEventArena midiOutputArena;              // JSFX MIDI output for the current block
+    MidiEventArena* currentMidiInput = nullptr;  // Set during processBlock; null for the outgoing instance
+    MidiEventArena* currentMidiOutput = nullptr; // Set during processBlock
+    int currentMidiBlockStart = 0; // Sub-block being processed, in samples from the start of the host block
+    int currentMidiBlockSize = 0;
+    int currentMidiTimeScale = 1; // Oversampling factor of the instance running, for MIDI timestamps
 
     // Note: Global properties management moved to PersistentFileChooser utility
 
+    JUCE_DECLARE_WEAK_REFERENCEABLE(AudioPluginAudioProcessor)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioPluginAudioProcessor)
 };
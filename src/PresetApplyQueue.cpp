@@ -0,0 +1,187 @@
+#include "PresetApplyQueue.h"
+
+PresetApplyQueue::~PresetApplyQueue()
+{
+    auto freeAll = [](juce::AbstractFifo& fifo, std::array<Command*, fifoSize>& slots)
+    {
+        const auto scope = fifo.read(fifo.getNumReady());
+        scope.forEach([&slots](int index) { delete slots[static_cast<size_t>(index)]; });
+    };
+
+    freeAll(submittedFifo, submitted);
+    freeAll(completedFifo, completed);
+    delete held;
+
+    for (int i = 0; i < numUnreturned; ++i)
+        delete unreturned[static_cast<size_t>(i)];
+}
+
+void PresetApplyQueue::submit(SX_Instance* target, const std::string& stateText)
+{
+    auto command = std::make_unique<Command>();
+    command->target = target;
+    parse(*command, stateText, target != nullptr ? JesusonicAPI.sx_getNumParms(target) : 0);
+    push(std::move(command));
+}
+
+void PresetApplyQueue::submitBarrier(SX_Instance* newInstance)
+{
+    auto command = std::make_unique<Command>();
+    command->target = newInstance;
+    push(std::move(command));
+}
+
+void PresetApplyQueue::parse(Command& command, const std::string& stateText, int numParams)
+{
+    // One token per slider, a number or "-" for an unused slider, then the preset name
+    // (quoted when it has spaces)
+    juce::StringArray tokens;
+    tokens.addTokens(juce::String(stateText), " \t\r\n", "\"'`");
+
+    const int maxValues = juce::jlimit(0, PluginConstants::MaxParameters, numParams);
+    int numSliderTokens = 0;
+
+    for (const auto& token : tokens)
+    {
+        const bool isUnused = token == "-";
+        if (!isUnused && (token.isEmpty() || !token.containsOnly("0123456789.-+eE")))
+            break;
+
+        if (numSliderTokens < maxValues)
+        {
+            command.values[static_cast<size_t>(numSliderTokens)] = isUnused ? 0.0 : token.getDoubleValue();
+            command.hasValue[static_cast<size_t>(numSliderTokens)] = !isUnused;
+        }
+
+        ++numSliderTokens;
+    }
+
+    // Anything after the name is data for the script's @serialize section, which only the JSFX can read
+    if (numSliderTokens > 0 && tokens.size() <= numSliderTokens + 1)
+    {
+        command.numValues = juce::jmin(numSliderTokens, maxValues);
+        return;
+    }
+
+    command.numValues = 0;
+    command.stateText = stateText;
+}
+
+void PresetApplyQueue::push(std::unique_ptr<Command> command)
+{
+    const auto scope = submittedFifo.write(numInFlight < capacity ? 1 : 0);
+
+    // Queue full (audio thread not keeping up or stopped): keep only the newest, it supersedes the rest anyway
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+    {
+        deferred = std::move(command);
+        return;
+    }
+
+    auto* raw = command.release();
+    scope.forEach([this, raw](int index) { submitted[static_cast<size_t>(index)] = raw; });
+    ++numInFlight;
+}
+
+int PresetApplyQueue::collectCompleted()
+{
+    int numApplied = 0;
+
+    {
+        const auto scope = completedFifo.read(completedFifo.getNumReady());
+        scope.forEach(
+            [this, &numApplied](int index)
+            {
+                std::unique_ptr<Command> command(completed[static_cast<size_t>(index)]);
+                if (command->applied)
+                    ++numApplied;
+                --numInFlight;
+            }
+        );
+    }
+
+    if (deferred != nullptr && numInFlight < capacity)
+        push(std::move(deferred));
+
+    return numApplied;
+}
+
+bool PresetApplyQueue::applyPending(
+    SX_Instance* runningInstance,
+    SX_Instance* const* linkedInstances,
+    int numLinkedInstances
+) noexcept
+{
+    // Commands the completed FIFO had no room for last time
+    while (numUnreturned > 0 && complete(unreturned[static_cast<size_t>(numUnreturned - 1)]))
+        --numUnreturned;
+
+    // Only the newest command matters; everything before it is handed straight back
+    Command* newest = held;
+    held = nullptr;
+
+    {
+        const auto scope = submittedFifo.read(submittedFifo.getNumReady());
+        scope.forEach(
+            [this, &newest](int index)
+            {
+                if (newest != nullptr && !complete(newest))
+                    unreturned[static_cast<size_t>(numUnreturned++)] = newest;
+                newest = submitted[static_cast<size_t>(index)];
+            }
+        );
+    }
+
+    if (newest == nullptr)
+        return false;
+
+    if (newest->target != runningInstance)
+    {
+        // Its instance hasn't been adopted yet
+        held = newest;
+        return false;
+    }
+
+    if (runningInstance != nullptr && newest->numValues > 0)
+    {
+        for (int i = 0; i < newest->numValues; ++i)
+        {
+            if (!newest->hasValue[static_cast<size_t>(i)])
+                continue;
+
+            const double value = newest->values[static_cast<size_t>(i)];
+            JesusonicAPI.sx_setParmVal(runningInstance, i, value, 0);
+
+            for (int copy = 0; copy < numLinkedInstances; ++copy)
+                JesusonicAPI.sx_setParmVal(linkedInstances[copy], i, value, 0);
+        }
+
+        newest->applied = true;
+    }
+    else if (runningInstance != nullptr && !newest->stateText.empty())
+    {
+        // Serialized script data: only the JSFX can parse it
+        JesusonicAPI.sx_loadState(runningInstance, newest->stateText.c_str());
+
+        for (int i = 0; i < numLinkedInstances; ++i)
+            JesusonicAPI.sx_loadState(linkedInstances[i], newest->stateText.c_str());
+
+        newest->applied = true;
+    }
+
+    const bool applied = newest->applied;
+    if (!complete(newest))
+        unreturned[static_cast<size_t>(numUnreturned++)] = newest;
+
+    return applied;
+}
+
+bool PresetApplyQueue::complete(Command* command) noexcept
+{
+    const auto scope = completedFifo.write(1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+        return false;
+
+    scope.forEach([this, command](int index) { completed[static_cast<size_t>(index)] = command; });
+    return true;
+}
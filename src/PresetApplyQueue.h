@@ -0,0 +1,111 @@
+#pragma once
+
+#include <Config.h>
+
+#include <jsfx.h>
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <memory>
+#include <string>
+
+extern jsfxAPI JesusonicAPI;
+
+/**
+ * Lock-free hand-off of decoded presets from the message thread to the audio thread.
+ *
+ * The message thread decodes a preset and parses its slider values when it is
+ * submitted, so the audio thread only writes numbers into the instance. A state
+ * that carries more than slider values and a preset name (data the script stores
+ * with @serialize) can only be read back by the JSFX itself; it is kept as text
+ * and applied with sx_loadState() instead.
+ *
+ * processBlock calls
+ * applyPending() at the start of the block. Only the newest command is applied.
+ * Older ones still queued are skipped, since rapid preset stepping only needs the
+ * last one. Commands travel back through a second FIFO and are freed on the
+ * message thread, never on the audio thread.
+ *
+ * A command only applies to the instance it was decoded for. If that instance
+ * is still waiting to be adopted by the audio thread (behind a crossfade), the
+ * command is held until it is. Publishing a new instance submits a barrier, so a
+ * held command can never land on a different instance that happens to reuse the
+ * same address.
+ */
+class PresetApplyQueue
+{
+public:
+    struct Command
+    {
+        SX_Instance* target = nullptr; // Instance the state was decoded for
+        bool applied = false;          // Set by the audio thread
+
+        // Slider values by parameter index; hasValue is false where the state has "-" (slider unused).
+        // numValues is 0 for a barrier.
+        int numValues = 0;
+        std::array<double, PluginConstants::MaxParameters> values{};
+        std::array<bool, PluginConstants::MaxParameters> hasValue{};
+
+        // The whole state, only when the values don't cover it
+        std::string stateText;
+    };
+
+    PresetApplyQueue() = default;
+
+    /** Frees every command. The audio callback must have stopped. */
+    ~PresetApplyQueue();
+
+    //==============================================================================
+    /** Message thread: parse a decoded preset and queue it for the audio thread. */
+    void submit(SX_Instance* target, const std::string& stateText);
+
+    /** Message thread: discard queued presets for any instance other than newInstance. */
+    void submitBarrier(SX_Instance* newInstance);
+
+    /**
+     * Message thread (timer): free commands the audio thread is done with and
+     * submit one that was deferred because the queue was full.
+     * Returns the number of presets applied since the last call.
+     */
+    int collectCompleted();
+
+    //==============================================================================
+    /**
+     * Audio thread: apply the newest queued preset if it targets the running instance.
+     * The preset also goes to linkedInstances (linked-split copies of the running instance).
+     * Realtime safe. Returns true if a preset was applied.
+     */
+    bool applyPending(
+        SX_Instance* runningInstance,
+        SX_Instance* const* linkedInstances = nullptr,
+        int numLinkedInstances = 0
+    ) noexcept;
+
+private:
+    void push(std::unique_ptr<Command> command);
+    bool complete(Command* command) noexcept;
+    static void parse(Command& command, const std::string& stateText, int numParams);
+
+    // Commands in flight at once. An AbstractFifo of size n holds n - 1 items, so the FIFOs get one more slot.
+    static constexpr int capacity = 32;
+    static constexpr int fifoSize = capacity + 1;
+
+    // Message thread -> audio thread
+    juce::AbstractFifo submittedFifo{fifoSize};
+    std::array<Command*, fifoSize> submitted{};
+
+    // Audio thread -> message thread. At most `capacity` commands are in flight, so this can't fill up;
+    // should a write fail anyway, the command waits in `unreturned` rather than being freed here.
+    juce::AbstractFifo completedFifo{fifoSize};
+    std::array<Command*, fifoSize> completed{};
+
+    int numInFlight = 0;               // Message thread
+    std::unique_ptr<Command> deferred; // Message thread, newest command waiting for space
+    Command* held = nullptr;           // Audio thread, waiting for its instance to be adopted
+
+    // Audio thread: completed commands the FIFO had no room for, returned on the next call
+    std::array<Command*, capacity> unreturned{};
+    int numUnreturned = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetApplyQueue)
+};
@@ -4,7 +4,6 @@ PresetLoader::PresetLoader(juce::AudioProcessorValueTreeState& apvts_, PresetCac
     : juce::Thread("PresetLoader")
     , apvts(apvts_)
     , presetCache(cache)
-    , converter(std::make_unique<ReaperPresetConverter>())
 {
     // Start the background thread (will wait for requests)
     startThread(juce::Thread::Priority::low);
@@ -101,8 +100,8 @@ void PresetLoader::loadPresetsInBackground()
         return;
     }
 
-    // Phase 2: Load and parse files (uses global file I/O)
-    // The ReaperPresetConverter internally handles file reading
+    // Phase 2: Load and parse files, through the process-wide cache so instances
+    // showing the same libraries parse each one once and share its preset data
     for (const auto& file : presetFiles)
     {
         // Check if we should exit
@@ -119,7 +118,7 @@ void PresetLoader::loadPresetsInBackground()
             return;
         }
 
-        auto fileNode = converter->convertFileToTree(file);
+        auto fileNode = fileCache->getPresetFile(file);
         if (fileNode.isValid())
         {
             newPresetsTree.appendChild(fileNode, nullptr);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "JsfxFileCache.h"
 #include "ReaperPresetConverter.h"
 #include "PresetCache.h"
 #include <Config.h>
@@ -14,7 +15,7 @@
  *
  * Thread-safe class that:
  * - Loads presets from default locations in a background thread
- * - Parses .rpl files using ReaperPresetConverter
+ * - Parses .rpl files using ReaperPresetConverter, through the process-wide JsfxFileCache
  * - Updates in-memory PresetCache (not persisted to APVTS/project files)
  * - Can be triggered to refresh when needed
  *
@@ -114,8 +115,8 @@ private:
     // Reference to preset cache for storing loaded presets
     PresetCache& presetCache;
 
-    // Converter for parsing .rpl files
-    std::unique_ptr<ReaperPresetConverter> converter;
+    // Parsed .rpl files, shared with the other instances
+    juce::SharedResourcePointer<JsfxFileCache> fileCache;
 
     // Pending JSFX path for next load operation
     juce::String pendingJsfxPath;
@@ -536,7 +536,7 @@ void PresetTreeView::onEnterKeyPressed(juce::TreeViewItem* selectedItem)
     if (auto* presetItem = dynamic_cast<PresetTreeItem*>(selectedItem))
     {
         if (presetItem->getType() == PresetTreeItem::ItemType::Preset)
-            applyPreset(presetItem->getPresetData());
+            applyPreset(presetItem->getPresetData(), presetItem->getPresetName());
     }
 }
 
@@ -580,12 +580,12 @@ void PresetTreeView::collectSelectedPresetItems(juce::Array<PresetTreeItem*>& it
         collectSelectedPresetItems(items, item->getSubItem(i));
 }
 
-void PresetTreeView::applyPreset(const juce::String& base64Data)
+void PresetTreeView::applyPreset(const juce::String& base64Data, const juce::String& presetName)
 {
     if (base64Data.isEmpty())
         return;
 
-    processor.loadPresetFromBase64(base64Data);
+    processor.loadPresetFromBase64(base64Data, presetName);
 }
 
 // ============================================================================
@@ -113,7 +113,7 @@ public:
     juce::Array<PresetTreeItem*> getSelectedPresetItems();
 
     // Apply preset to processor
-    void applyPreset(const juce::String& base64Data);
+    void applyPreset(const juce::String& base64Data, const juce::String& presetName);
 
     // SearchableTreeView overrides
     std::unique_ptr<juce::TreeViewItem> createRootItem() override;
@@ -799,7 +799,7 @@ void PresetWindow::handlePresetTreeItemSelected(juce::TreeViewItem* item)
                 onPresetSelected(bankName, presetName, presetData);
 
             // Also load directly via processor
-            processor.loadPresetFromBase64(presetData);
+            processor.loadPresetFromBase64(presetData, presetName);
         }
     }
 }
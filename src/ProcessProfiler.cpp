@@ -0,0 +1,185 @@
+#include "ProcessProfiler.h"
+
+namespace
+{
+// Single writer: a plain load and store is enough, and cheaper than a locked read-modify-write
+template <typename IntType>
+void addRelaxed(std::atomic<IntType>& counter, IntType amount) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+} // namespace
+
+//==============================================================================
+const char* ProcessProfiler::getStageName(Stage stage) noexcept
+{
+    switch (stage)
+    {
+    case Stage::InputRouting:
+        return "Input routing";
+    case Stage::ParameterSync:
+        return "Parameter sync";
+    case Stage::Transport:
+        return "Transport";
+    case Stage::Jsfx:
+        return "JSFX";
+    case Stage::OutputRouting:
+        return "Output routing";
+    case Stage::Midi:
+        return "MIDI";
+    case Stage::Total:
+        return "Total";
+    }
+
+    return "";
+}
+
+ProcessProfiler::ProcessProfiler()
+{
+    nanosPerTick = 1.0e9 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+}
+
+//==============================================================================
+void ProcessProfiler::copyCounters(Counters& destination) const noexcept
+{
+    // The block count goes first, so the copy never claims more blocks than its histograms hold
+    destination.numBlocks = numBlocks.load(std::memory_order_acquire);
+    destination.deadlineNanos = deadlineNanos.load(std::memory_order_relaxed);
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+    {
+        destination.totalNanos[stage] = totalNanos[stage].load(std::memory_order_relaxed);
+
+        for (size_t bucket = 0; bucket < numBuckets; ++bucket)
+            destination.histograms[stage][bucket] = histograms[stage][bucket].load(std::memory_order_relaxed);
+    }
+}
+
+ProcessProfiler::Statistics ProcessProfiler::getStatistics(const Counters& earlier, const Counters& later)
+{
+    Statistics statistics;
+    statistics.numBlocks = later.numBlocks - earlier.numBlocks;
+    if (statistics.numBlocks == 0)
+        return statistics;
+
+    const double deadlineNanos = static_cast<double>(later.deadlineNanos - earlier.deadlineNanos);
+    statistics.blockDeadlineMicros = deadlineNanos * 0.001 / statistics.numBlocks;
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+    {
+        auto& result = statistics.stages[stage];
+
+        // Counters wrap around; unsigned differences stay right as long as they don't wrap twice in between
+        std::array<juce::uint32, numBuckets> counts;
+        juce::uint64 numSamples = 0;
+        for (size_t bucket = 0; bucket < numBuckets; ++bucket)
+        {
+            counts[bucket] = later.histograms[stage][bucket] - earlier.histograms[stage][bucket];
+            numSamples += counts[bucket];
+        }
+
+        if (numSamples == 0)
+            continue;
+
+        const juce::uint64 medianRank = (numSamples + 1) / 2;
+        const juce::uint64 p99Rank = juce::jmax<juce::uint64>(1, (numSamples * 99 + 99) / 100);
+        juce::uint64 seen = 0;
+
+        for (int bucket = 0; bucket < numBuckets; ++bucket)
+        {
+            const auto count = counts[static_cast<size_t>(bucket)];
+            if (count == 0)
+                continue;
+
+            const double micros = getBucketMidpointNanos(bucket) * 0.001;
+            if (seen < medianRank && seen + count >= medianRank)
+                result.medianMicros = micros;
+            if (seen < p99Rank && seen + count >= p99Rank)
+                result.p99Micros = micros;
+
+            result.maxMicros = micros;
+            seen += count;
+        }
+
+        const double stageNanos = static_cast<double>(later.totalNanos[stage] - earlier.totalNanos[stage]);
+        result.deadlinePercent = deadlineNanos > 0.0 ? 100.0 * stageNanos / deadlineNanos : 0.0;
+    }
+
+    return statistics;
+}
+
+juce::String ProcessProfiler::Statistics::toString() const
+{
+    juce::String text;
+    text << "Blocks: " << static_cast<int>(numBlocks) << ", budget " << juce::String(blockDeadlineMicros, 1)
+         << " us per block\n";
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        const auto& result = stages[static_cast<size_t>(stage)];
+        text << getStageName(static_cast<Stage>(stage))
+             << ": p50 "
+             << juce::String(result.medianMicros, 1)
+             << " us, p99 "
+             << juce::String(result.p99Micros, 1)
+             << " us, max "
+             << juce::String(result.maxMicros, 1)
+             << " us, "
+             << juce::String(result.deadlinePercent, 2)
+             << "% of budget\n";
+    }
+
+    return text;
+}
+
+//==============================================================================
+void ProcessProfiler::beginBlock(int numSamples, double sampleRate) noexcept
+{
+    blockTicks.fill(0);
+    blockStart = juce::Time::getHighResolutionTicks();
+    lastMark = blockStart;
+    blockDeadlineNanos = sampleRate > 0.0 ? static_cast<juce::uint64>(numSamples * 1.0e9 / sampleRate) : 0;
+}
+
+void ProcessProfiler::endBlock() noexcept
+{
+    const auto now = juce::Time::getHighResolutionTicks();
+    blockTicks[static_cast<size_t>(Stage::Total)] = now - blockStart;
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+    {
+        const auto nanos = static_cast<juce::uint64>(juce::jmax<juce::int64>(0, blockTicks[stage]) * nanosPerTick);
+        addRelaxed(histograms[stage][static_cast<size_t>(getBucket(nanos))], juce::uint32(1));
+        addRelaxed(totalNanos[stage], nanos);
+        lastBlockNanos[stage] = nanos;
+    }
+
+    addRelaxed(deadlineNanos, blockDeadlineNanos);
+
+    // Publishes this block's counts to copyCounters()
+    numBlocks.store(numBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+//==============================================================================
+int ProcessProfiler::getBucket(juce::uint64 nanos) noexcept
+{
+    // Four buckets per octave: the highest set bit picks the octave, the two bits below it the quarter
+    const auto clamped = static_cast<juce::uint32>(juce::jmin<juce::uint64>(nanos, 0xffffffffu));
+    if (clamped < 4)
+        return static_cast<int>(clamped);
+
+    const int highestBit = juce::findHighestSetBit(clamped);
+    return highestBit * 4 + static_cast<int>((clamped >> (highestBit - 2)) & 3);
+}
+
+double ProcessProfiler::getBucketMidpointNanos(int bucket) noexcept
+{
+    // Buckets 4 to 7 are never used; below that, the bucket is the value itself
+    if (bucket < 8)
+        return static_cast<double>(bucket);
+
+    auto lowerBound = [](int index)
+    { return static_cast<double>(4 + index % 4) * static_cast<double>(juce::uint64(1) << (index / 4 - 2)); };
+
+    return 0.5 * (lowerBound(bucket) + lowerBound(bucket + 1));
+}
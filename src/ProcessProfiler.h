@@ -0,0 +1,126 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+
+/**
+ * Per-stage timing of processBlock, to tell whether an instance's CPU goes to
+ * the JSFX or to the wrapper around it.
+ *
+ * The audio thread marks the end of each stage with lap(); the time since the
+ * previous mark is added to that stage. A stage may be lapped several times in
+ * one block (e.g. MIDI in and MIDI out). endBlock() files each stage's time for
+ * the block into a histogram with quarter-octave buckets.
+ *
+ * The counters only ever grow and have a single writer, so any thread can copy
+ * them out without locking. Statistics are taken over the difference of two
+ * copies, i.e. over the blocks processed in between.
+ *
+ * Times come from juce::Time::getHighResolutionTicks(), which reads the CPU's
+ * time stamp counter through the OS clock (vDSO, QPC or mach_absolute_time).
+ */
+class ProcessProfiler
+{
+public:
+    enum class Stage
+    {
+        InputRouting,
+        ParameterSync,
+        Transport,
+        Jsfx,
+        OutputRouting,
+        Midi,
+        Total // Whole block, filled in by endBlock()
+    };
+
+    static constexpr int numStages = static_cast<int>(Stage::Total) + 1;
+    static constexpr int numBuckets = 128; // Quarter octaves of nanoseconds, up to about 4 seconds
+
+    static const char* getStageName(Stage stage) noexcept;
+
+    /** Copy of the counters, as taken by copyCounters(). */
+    struct Counters
+    {
+        std::array<std::array<juce::uint32, numBuckets>, numStages> histograms{};
+        std::array<juce::uint64, numStages> totalNanos{};
+        juce::uint64 deadlineNanos = 0; // Sum of the blocks' real-time budgets
+        juce::uint32 numBlocks = 0;
+    };
+
+    struct StageStatistics
+    {
+        double medianMicros = 0.0;    // Histogram values are accurate to a quarter octave
+        double p99Micros = 0.0;
+        double maxMicros = 0.0;
+        double deadlinePercent = 0.0; // Share of the real-time budget, on average
+    };
+
+    struct Statistics
+    {
+        std::array<StageStatistics, numStages> stages{};
+        double blockDeadlineMicros = 0.0; // Average budget per block
+        juce::uint32 numBlocks = 0;
+
+        /** One line per stage, for logging. */
+        juce::String toString() const;
+    };
+
+    ProcessProfiler();
+
+    //==============================================================================
+    /** Any thread: copy the counters out. */
+    void copyCounters(Counters& destination) const noexcept;
+
+    /** Statistics over the blocks processed between two copies. */
+    static Statistics getStatistics(const Counters& earlier, const Counters& later);
+
+    //==============================================================================
+    /** Audio thread: start timing a block of numSamples. */
+    void beginBlock(int numSamples, double sampleRate) noexcept;
+
+    /** Audio thread: add the time since the previous mark to stage. */
+    void lap(Stage stage) noexcept
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+        blockTicks[static_cast<size_t>(stage)] += now - lastMark;
+        lastMark = now;
+    }
+
+    /** Audio thread: file the block's stage times into the histograms. */
+    void endBlock() noexcept;
+
+    /** Audio thread, after endBlock(): the block's time in stage. */
+    juce::uint64 getLastBlockNanos(Stage stage) const noexcept
+    {
+        return lastBlockNanos[static_cast<size_t>(stage)];
+    }
+
+    /** Audio thread, after endBlock(): the block's real-time budget. */
+    juce::uint64 getLastBlockDeadlineNanos() const noexcept
+    {
+        return blockDeadlineNanos;
+    }
+
+private:
+    static int getBucket(juce::uint64 nanos) noexcept;
+    static double getBucketMidpointNanos(int bucket) noexcept;
+
+    double nanosPerTick = 1.0;
+
+    // Written by the audio thread only
+    std::array<std::array<std::atomic<juce::uint32>, numBuckets>, numStages> histograms{};
+    std::array<std::atomic<juce::uint64>, numStages> totalNanos{};
+    std::atomic<juce::uint64> deadlineNanos{0};
+    std::atomic<juce::uint32> numBlocks{0};
+
+    // Audio thread: the block being timed
+    std::array<juce::int64, numStages> blockTicks{};
+    juce::int64 blockStart = 0;
+    juce::int64 lastMark = 0;
+    juce::uint64 blockDeadlineNanos = 0;
+    std::array<juce::uint64, numStages> lastBlockNanos{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessProfiler)
+};
@@ -0,0 +1,241 @@
+#include "ProfilerComponent.h"
+
+#include "RealtimeSanitizer.h"
+
+ProfilerComponent::ProfilerComponent(const ProcessProfiler& profilerToShow, XrunDetector& xrunsToShow)
+    : profiler(profilerToShow)
+    , xruns(xrunsToShow)
+{
+    addAndMakeVisible(copyButton);
+    copyButton.onClick = [this]()
+    {
+        auto text = statistics.toString();
+        if (RealtimeSanitizer::isEnabled())
+            text << "\n" << RealtimeSanitizer::getReport();
+
+        juce::SystemClipboard::copyTextToClipboard(text);
+    };
+
+    addAndMakeVisible(exportButton);
+    exportButton.onClick = [this]() { exportXruns(); };
+
+    addAndMakeVisible(clearButton);
+    clearButton.onClick = [this]()
+    {
+        xruns.clear();
+        xrunList.updateContent();
+        repaint();
+    };
+
+    xrunList.setRowHeight(rowHeight);
+    xrunList.setColour(juce::ListBox::backgroundColourId, juce::Colours::black.withAlpha(0.25f));
+    addAndMakeVisible(xrunList);
+
+    numXrunsShown = xruns.getNumCollected();
+    profiler.copyCounters(previousCounters);
+    startTimer(500);
+}
+
+ProfilerComponent::~ProfilerComponent()
+{
+    stopTimer();
+}
+
+void ProfilerComponent::timerCallback()
+{
+    // Statistics cover the blocks processed since the last refresh
+    profiler.copyCounters(currentCounters);
+    statistics = ProcessProfiler::getStatistics(previousCounters, currentCounters);
+    std::swap(previousCounters, currentCounters);
+
+    // The processor's timer collects the misses; only the list needs refreshing here
+    if (xruns.getNumCollected() != numXrunsShown)
+    {
+        numXrunsShown = xruns.getNumCollected();
+        xrunList.updateContent();
+    }
+
+    repaint();
+}
+
+//==============================================================================
+void ProfilerComponent::paint(juce::Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+    g.setFont(14.0f);
+
+    if (RealtimeSanitizer::isEnabled())
+    {
+        // Call sites are process-wide and never cleared; the full traces go out with Copy
+        const int numCallsites = RealtimeSanitizer::getNumCallsites();
+        g.setColour(numCallsites > 0 ? juce::Colours::orange : juce::Colours::white.withAlpha(0.6f));
+        g.drawText(
+            "Realtime violations: " + juce::String(numCallsites) + " call sites",
+            footerTextArea,
+            juce::Justification::centredLeft
+        );
+    }
+
+    juce::String xrunHeader = "Deadline misses: " + juce::String(static_cast<int>(xruns.getEvents().size()));
+    if (const auto dropped = xruns.getNumDropped())
+        xrunHeader << " (" << static_cast<int>(dropped) << " not logged)";
+
+    g.setColour(juce::Colours::white.withAlpha(0.9f));
+    g.drawText(xrunHeader, xrunHeaderArea, juce::Justification::centredLeft);
+
+    paintStatistics(g, statisticsArea);
+}
+
+void ProfilerComponent::paintStatistics(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
+    auto summary = bounds.removeFromTop(rowHeight);
+    if (statistics.numBlocks == 0)
+    {
+        g.drawText("No blocks processed", summary, juce::Justification::centredLeft);
+        return;
+    }
+
+    g.drawText(
+        juce::String(static_cast<int>(statistics.numBlocks))
+            + " blocks, budget "
+            + juce::String(statistics.blockDeadlineMicros, 1)
+            + " us per block",
+        summary,
+        juce::Justification::centredLeft
+    );
+
+    const int nameWidth = bounds.getWidth() / 3;
+    const int columnWidth = (bounds.getWidth() - nameWidth) / 4;
+
+    auto drawRow = [&](juce::Rectangle<int> row, const juce::String& name, const juce::StringArray& columns)
+    {
+        g.drawText(name, row.removeFromLeft(nameWidth), juce::Justification::centredLeft);
+        for (const auto& column : columns)
+            g.drawText(column, row.removeFromLeft(columnWidth), juce::Justification::centredRight);
+    };
+
+    bounds.removeFromTop(6);
+    g.setColour(juce::Colours::white.withAlpha(0.6f));
+    drawRow(bounds.removeFromTop(rowHeight), "Stage", {"p50 (us)", "p99 (us)", "max (us)", "% budget"});
+
+    for (int stage = 0; stage < ProcessProfiler::numStages; ++stage)
+    {
+        const auto& result = statistics.stages[static_cast<size_t>(stage)];
+
+        // The total is a whole-block figure; set it apart from the stages it's made of
+        const bool isTotal = stage == static_cast<int>(ProcessProfiler::Stage::Total);
+        g.setColour(juce::Colours::white.withAlpha(isTotal ? 1.0f : 0.9f));
+        if (isTotal)
+            bounds.removeFromTop(4);
+
+        drawRow(
+            bounds.removeFromTop(rowHeight),
+            ProcessProfiler::getStageName(static_cast<ProcessProfiler::Stage>(stage)),
+            {juce::String(result.medianMicros, 1),
+             juce::String(result.p99Micros, 1),
+             juce::String(result.maxMicros, 1),
+             juce::String(result.deadlinePercent, 2)}
+        );
+    }
+}
+
+void ProfilerComponent::resized()
+{
+    auto bounds = getLocalBounds().reduced(10);
+
+    auto footer = bounds.removeFromBottom(rowHeight);
+    copyButton.setBounds(footer.removeFromRight(80));
+    footer.removeFromRight(6);
+    exportButton.setBounds(footer.removeFromRight(80));
+    footer.removeFromRight(6);
+    clearButton.setBounds(footer.removeFromRight(80));
+    footer.removeFromRight(6);
+    footerTextArea = footer;
+
+    bounds.removeFromBottom(10);
+    xrunList.setBounds(bounds.removeFromBottom(numXrunRows * rowHeight));
+    xrunHeaderArea = bounds.removeFromBottom(rowHeight);
+
+    bounds.removeFromBottom(10);
+    statisticsArea = bounds;
+}
+
+//==============================================================================
+int ProfilerComponent::getNumRows()
+{
+    return static_cast<int>(xruns.getEvents().size());
+}
+
+void ProfilerComponent::paintListBoxItem(int rowNumber, juce::Graphics& g, int width, int height, bool rowIsSelected)
+{
+    const auto& events = xruns.getEvents();
+    if (rowNumber < 0 || rowNumber >= static_cast<int>(events.size()))
+        return;
+
+    if (rowIsSelected)
+        g.fillAll(juce::Colours::white.withAlpha(0.1f));
+
+    // Newest first
+    const auto& event = events[events.size() - 1 - static_cast<size_t>(rowNumber)];
+
+    juce::String context = "(unknown)";
+    if (event.contextKnown)
+    {
+        context = event.jsfxPath.isEmpty() ? "(no JSFX)" : juce::File(event.jsfxPath).getFileName();
+        if (event.presetName.isNotEmpty())
+            context << " / " << event.presetName;
+    }
+
+    juce::String details;
+    details << juce::String(event.wallMicros, 0)
+            << " / "
+            << juce::String(event.deadlineMicros, 0)
+            << " us, "
+            << event.block.numSamples
+            << " smp, JSFX "
+            << juce::String(event.stageMicros[static_cast<size_t>(ProcessProfiler::Stage::Jsfx)], 0)
+            << " us";
+
+    if (event.block.presetApplied)
+        details << ", preset load";
+    if (event.block.numParameterChanges > 0 || event.block.numRampingParameters > 0)
+        details << ", " << event.block.numParameterChanges << "/" << event.block.numRampingParameters << " params";
+    if (event.block.numMidiEvents > 0)
+        details << ", " << event.block.numMidiEvents << " MIDI";
+
+    auto row = juce::Rectangle<int>(0, 0, width, height).reduced(4, 0);
+
+    g.setFont(13.0f);
+    g.setColour(juce::Colours::white.withAlpha(0.6f));
+    g.drawText(event.time.toString(false, true, true, true), row.removeFromLeft(70), juce::Justification::centredLeft);
+
+    g.setColour(juce::Colours::white.withAlpha(0.9f));
+    g.drawText(details, row.removeFromLeft(row.getWidth() / 2), juce::Justification::centredLeft);
+    g.drawText(context, row, juce::Justification::centredLeft, true);
+}
+
+void ProfilerComponent::exportXruns()
+{
+    auto chooser = std::make_unique<PersistentFileChooser>(
+        "lastXrunExportDirectory",
+        "Export deadline misses as JSON...",
+        "*.json"
+    );
+
+    chooser->launchAsync(
+        [this](const juce::File& file)
+        {
+            if (file == juce::File{})
+                return;
+
+            if (!file.withFileExtension("json").replaceWithText(xruns.toJson()))
+                DBG("ProfilerComponent: could not write " << file.getFullPathName());
+        },
+        juce::FileBrowserComponent::saveMode
+            | juce::FileBrowserComponent::canSelectFiles
+            | juce::FileBrowserComponent::warnAboutOverwriting
+    );
+
+    // Kept alive until the dialog closes
+    fileChooser = std::move(chooser);
+}
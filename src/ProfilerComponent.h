@@ -0,0 +1,66 @@
+#pragma once
+
+#include "PersistentFileChooser.h"
+#include "ProcessProfiler.h"
+#include "XrunDetector.h"
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+//==============================================================================
+/**
+ * Table of the processor's per-stage timings over the last refresh interval:
+ * p50, p99 and max per block, and the share of the real-time budget.
+ * "Copy" puts the same figures on the clipboard as text.
+ *
+ * Below it, the blocks that missed their deadline, newest first, with the
+ * JSFX and preset they ran with. "Export" saves them as JSON.
+ */
+class ProfilerComponent
+    : public juce::Component
+    , private juce::Timer
+    , private juce::ListBoxModel
+{
+public:
+    ProfilerComponent(const ProcessProfiler& profilerToShow, XrunDetector& xrunsToShow);
+    ~ProfilerComponent() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    juce::Rectangle<int> getIdealBounds() const
+    {
+        return {0, 0, 620, 76 + (ProcessProfiler::numStages + 3 + numXrunRows) * rowHeight};
+    }
+
+private:
+    void timerCallback() override;
+
+    int getNumRows() override;
+    void paintListBoxItem(int rowNumber, juce::Graphics& g, int width, int height, bool rowIsSelected) override;
+
+    void paintStatistics(juce::Graphics& g, juce::Rectangle<int> bounds);
+    void exportXruns();
+
+    static constexpr int rowHeight = 22;
+    static constexpr int numXrunRows = 6;
+
+    const ProcessProfiler& profiler;
+    XrunDetector& xruns;
+    ProcessProfiler::Counters previousCounters;
+    ProcessProfiler::Counters currentCounters;
+    ProcessProfiler::Statistics statistics;
+    juce::uint32 numXrunsShown = 0;
+
+    // Laid out by resized(), painted by paint()
+    juce::Rectangle<int> statisticsArea;
+    juce::Rectangle<int> xrunHeaderArea;
+    juce::Rectangle<int> footerTextArea;
+
+    juce::ListBox xrunList{"Deadline misses", this};
+    juce::TextButton copyButton{"Copy"};
+    juce::TextButton exportButton{"Export..."};
+    juce::TextButton clearButton{"Clear"};
+    std::unique_ptr<PersistentFileChooser> fileChooser;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProfilerComponent)
+};
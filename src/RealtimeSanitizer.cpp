@@ -0,0 +1,524 @@
+#include "RealtimeSanitizer.h"
+
+#if !JUCESONIC_REALTIME_SANITIZER
+
+int RealtimeSanitizer::getNumCallsites() noexcept
+{
+    return 0;
+}
+
+juce::String RealtimeSanitizer::getReport()
+{
+    return "Realtime sanitizer not built in (configure with -DJUCESONIC_REALTIME_SANITIZER=ON)\n";
+}
+
+#else
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#endif
+
+// The hooks run inside malloc and inside TLS access of other libraries; initial-exec TLS never allocates
+#if defined(__GNUC__) || defined(__clang__)
+#define JUCESONIC_SANITIZER_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define JUCESONIC_SANITIZER_TLS
+#endif
+
+namespace
+{
+enum class Violation
+{
+    Allocation,
+    Deallocation,
+    Lock
+};
+
+const char* getViolationName(Violation violation) noexcept
+{
+    switch (violation)
+    {
+    case Violation::Allocation:
+        return "allocation";
+    case Violation::Deallocation:
+        return "deallocation";
+    case Violation::Lock:
+        return "lock";
+    }
+
+    return "";
+}
+
+constexpr int maxFrames = 24;
+constexpr int maxCallsites = 512;
+
+// One record per distinct stack; claimed by CAS on key and published by ready
+struct Callsite
+{
+    std::atomic<juce::uint64> key{0}; // 0 while free
+    std::atomic<bool> ready{false};
+    std::atomic<juce::uint32> count{0};
+    Violation violation = Violation::Allocation;
+    int numFrames = 0;
+    void* frames[maxFrames] = {};
+};
+
+std::array<Callsite, maxCallsites> callsites;
+std::atomic<int> numCallsites{0};
+std::atomic<juce::uint32> numDropped{0};
+
+thread_local int realtimeDepth JUCESONIC_SANITIZER_TLS = 0;
+thread_local bool isRecording JUCESONIC_SANITIZER_TLS = false;
+
+int captureStack(void** frames, int capacity) noexcept
+{
+#if JUCE_WINDOWS
+    return static_cast<int>(CaptureStackBackTrace(2, static_cast<DWORD>(capacity), frames, nullptr));
+#else
+    return backtrace(frames, capacity);
+#endif
+}
+
+void record(Violation violation) noexcept
+{
+    // Allocations made while recording (e.g. the unwinder's first use) aren't reported again
+    if (realtimeDepth == 0 || isRecording)
+        return;
+
+    isRecording = true;
+
+    void* frames[maxFrames];
+    const int numFrames = captureStack(frames, maxFrames);
+
+    // FNV-1a over the violation and return addresses; never 0, which marks a free slot
+    juce::uint64 key = 14695981039346656037ull ^ static_cast<juce::uint64>(violation);
+    for (int i = 0; i < numFrames; ++i)
+        key = (key ^ reinterpret_cast<juce::uint64>(frames[i])) * 1099511628211ull;
+    key |= 1;
+
+    bool recorded = false;
+    for (int probe = 0; probe < maxCallsites && !recorded; ++probe)
+    {
+        auto& site = callsites[static_cast<size_t>((key + static_cast<juce::uint64>(probe)) % maxCallsites)];
+        juce::uint64 existing = site.key.load(std::memory_order_acquire);
+
+        if (existing == 0 && site.key.compare_exchange_strong(existing, key, std::memory_order_acq_rel))
+        {
+            site.violation = violation;
+            site.numFrames = numFrames;
+            std::copy(frames, frames + numFrames, site.frames);
+            site.ready.store(true, std::memory_order_release);
+            numCallsites.fetch_add(1, std::memory_order_relaxed);
+            existing = key;
+        }
+
+        if (existing == key)
+        {
+            site.count.fetch_add(1, std::memory_order_relaxed);
+            recorded = true;
+        }
+    }
+
+    if (!recorded)
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+
+    isRecording = false;
+}
+
+//==============================================================================
+// Allocation that isn't recorded: straight to the C library underneath the hooks
+#if defined(__GLIBC__)
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void* __libc_memalign(size_t, size_t);
+extern "C" void __libc_free(void*);
+#endif
+
+void* allocateUnrecorded(size_t size) noexcept
+{
+#if defined(__GLIBC__)
+    return __libc_malloc(size);
+#else
+    return std::malloc(size);
+#endif
+}
+
+void* allocateAlignedUnrecorded(size_t size, size_t alignment) noexcept
+{
+#if defined(__GLIBC__)
+    return __libc_memalign(alignment, size);
+#elif JUCE_WINDOWS
+    return _aligned_malloc(size, alignment);
+#else
+    void* memory = nullptr;
+    return posix_memalign(&memory, juce::jmax(alignment, sizeof(void*)), size) == 0 ? memory : nullptr;
+#endif
+}
+
+void freeUnrecorded(void* memory) noexcept
+{
+#if defined(__GLIBC__)
+    __libc_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void freeAlignedUnrecorded(void* memory) noexcept
+{
+#if JUCE_WINDOWS
+    _aligned_free(memory);
+#else
+    freeUnrecorded(memory);
+#endif
+}
+
+void* allocate(size_t size)
+{
+    record(Violation::Allocation);
+    if (void* memory = allocateUnrecorded(size == 0 ? 1 : size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* allocateAligned(size_t size, std::align_val_t alignment)
+{
+    record(Violation::Allocation);
+    if (void* memory = allocateAlignedUnrecorded(size == 0 ? 1 : size, static_cast<size_t>(alignment)))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void deallocate(void* memory) noexcept
+{
+    if (memory == nullptr)
+        return;
+
+    record(Violation::Deallocation);
+    freeUnrecorded(memory);
+}
+
+void deallocateAligned(void* memory) noexcept
+{
+    if (memory == nullptr)
+        return;
+
+    record(Violation::Deallocation);
+    freeAlignedUnrecorded(memory);
+}
+
+//==============================================================================
+// Written to stderr at exit, after every plugin instance is gone
+struct ExitReporter
+{
+    ExitReporter()
+    {
+#if !JUCE_WINDOWS
+        // The unwinder allocates on its first use; get that over with outside any realtime region
+        void* frames[1];
+        backtrace(frames, 1);
+#endif
+    }
+
+    ~ExitReporter()
+    {
+        if (RealtimeSanitizer::getNumCallsites() > 0)
+            std::fputs(RealtimeSanitizer::getReport().toRawUTF8(), stderr);
+    }
+};
+
+ExitReporter exitReporter;
+} // namespace
+
+//==============================================================================
+RealtimeSanitizer::ScopedRealtimeRegion::ScopedRealtimeRegion() noexcept
+{
+    ++realtimeDepth;
+}
+
+RealtimeSanitizer::ScopedRealtimeRegion::~ScopedRealtimeRegion() noexcept
+{
+    --realtimeDepth;
+}
+
+int RealtimeSanitizer::getNumCallsites() noexcept
+{
+    return numCallsites.load(std::memory_order_relaxed);
+}
+
+juce::String RealtimeSanitizer::getReport()
+{
+    // Symbolising allocates and locks; keep it out of the records even if called from a realtime region
+    const bool wasRecording = isRecording;
+    isRecording = true;
+
+    juce::String report;
+    report << "Realtime sanitizer: " << getNumCallsites() << " call sites";
+    if (const auto dropped = numDropped.load(std::memory_order_relaxed))
+        report << " (" << static_cast<int>(dropped) << " events dropped, table full)";
+    report << "\n";
+
+    for (auto& site : callsites)
+    {
+        if (!site.ready.load(std::memory_order_acquire))
+            continue;
+
+        report << "\n["
+               << getViolationName(site.violation)
+               << "] "
+               << static_cast<int>(site.count.load(std::memory_order_relaxed))
+               << "x\n";
+
+#if JUCE_WINDOWS
+        for (int frame = 0; frame < site.numFrames; ++frame)
+            report << "  #" << frame << " 0x" << juce::String::toHexString((juce::pointer_sized_int)site.frames[frame])
+                   << "\n";
+#else
+        if (char** symbols = backtrace_symbols(site.frames, site.numFrames))
+        {
+            for (int frame = 0; frame < site.numFrames; ++frame)
+                report << "  #" << frame << " " << symbols[frame] << "\n";
+
+            std::free(symbols);
+        }
+#endif
+    }
+
+    isRecording = wasRecording;
+    return report;
+}
+
+//==============================================================================
+// Replacements of the global operator new/delete
+void* operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    record(Violation::Allocation);
+    return allocateUnrecorded(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    record(Violation::Allocation);
+    return allocateUnrecorded(size == 0 ? 1 : size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    record(Violation::Allocation);
+    return allocateAlignedUnrecorded(size == 0 ? 1 : size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    record(Violation::Allocation);
+    return allocateAlignedUnrecorded(size == 0 ? 1 : size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+    deallocate(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    deallocate(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    deallocate(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    deallocate(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    deallocate(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    deallocate(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    deallocateAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+    deallocateAligned(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+    deallocateAligned(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept
+{
+    deallocateAligned(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    deallocateAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    deallocateAligned(memory);
+}
+
+//==============================================================================
+// C library allocation (glibc exposes the real functions under __libc_ names)
+#if defined(__GLIBC__)
+extern "C"
+{
+void* malloc(size_t size)
+{
+    record(Violation::Allocation);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    record(Violation::Allocation);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* memory, size_t size)
+{
+    record(Violation::Allocation);
+    return __libc_realloc(memory, size);
+}
+
+void free(void* memory)
+{
+    if (memory != nullptr)
+        record(Violation::Deallocation);
+
+    __libc_free(memory);
+}
+}
+#endif
+
+//==============================================================================
+// pthread waits: the real functions are looked up with RTLD_NEXT on first use. No static-local
+// guard here, since initialising one may itself lock a mutex.
+#if !JUCE_WINDOWS
+namespace
+{
+template <typename FunctionType>
+FunctionType findNext(std::atomic<void*>& slot, const char* name, const char* version = nullptr) noexcept
+{
+    void* function = slot.load(std::memory_order_acquire);
+    if (function == nullptr)
+    {
+#if defined(__GLIBC__)
+        if (version != nullptr)
+            function = dlvsym(RTLD_NEXT, name, version);
+#else
+        juce::ignoreUnused(version);
+#endif
+        if (function == nullptr)
+            function = dlsym(RTLD_NEXT, name);
+
+        slot.store(function, std::memory_order_release);
+    }
+
+    return reinterpret_cast<FunctionType>(function);
+}
+
+// dlsym() returns the oldest version of a symbol. Where glibc still carries the pre-2.3.2 condition
+// variables (x86, x86-64 and others), that is the compat implementation with a different
+// pthread_cond_t layout, which would break every wait in the process. Ports that came later have
+// one version only, so dlvsym() finds nothing and the plain lookup is right.
+constexpr const char* conditionVersion = "GLIBC_2.3.2";
+
+std::atomic<void*> nextMutexLock{nullptr};
+std::atomic<void*> nextReadLock{nullptr};
+std::atomic<void*> nextWriteLock{nullptr};
+std::atomic<void*> nextConditionWait{nullptr};
+std::atomic<void*> nextConditionTimedWait{nullptr};
+} // namespace
+
+extern "C"
+{
+int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    record(Violation::Lock);
+    return findNext<int (*)(pthread_mutex_t*)>(nextMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock)
+{
+    record(Violation::Lock);
+    return findNext<int (*)(pthread_rwlock_t*)>(nextReadLock, "pthread_rwlock_rdlock")(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock)
+{
+    record(Violation::Lock);
+    return findNext<int (*)(pthread_rwlock_t*)>(nextWriteLock, "pthread_rwlock_wrlock")(lock);
+}
+
+int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+{
+    record(Violation::Lock);
+    using Function = int (*)(pthread_cond_t*, pthread_mutex_t*);
+    return findNext<Function>(nextConditionWait, "pthread_cond_wait", conditionVersion)(condition, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* timeout)
+{
+    record(Violation::Lock);
+    using Function = int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+    auto* next = findNext<Function>(nextConditionTimedWait, "pthread_cond_timedwait", conditionVersion);
+    return next(condition, mutex, timeout);
+}
+}
+#endif
+
+#endif // JUCESONIC_REALTIME_SANITIZER
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Config.h>
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Debug/profiling build mode that records allocations and locks on threads
+ * doing realtime work, to keep the audio path clean as features are added.
+ *
+ * Configure with -DJUCESONIC_REALTIME_SANITIZER=ON. The build then replaces the
+ * global operator new/delete and, where the platform allows it, interposes:
+ * - malloc, calloc, realloc and free (glibc)
+ * - pthread mutex, rwlock and condition-variable waits, which every JUCE lock
+ *   (CriticalSection, ReadWriteLock, WaitableEvent) and std::mutex end up in
+ *   (Linux and macOS, for code linked into the plugin)
+ *
+ * While a thread is inside a ScopedRealtimeRegion (processBlock, realtime pool
+ * tasks), each such call captures a stack trace. Identical traces share one
+ * record with a count, so a per-block allocation shows up once with the number
+ * of blocks it happened in. Records live in a fixed table in static storage.
+ *
+ * getReport() symbolises the records. The report is written to stderr when the
+ * process exits, and the editor's CPU profiler window shows it too.
+ *
+ * Without the option, ScopedRealtimeRegion compiles to nothing.
+ */
+class RealtimeSanitizer
+{
+public:
+    static constexpr bool isEnabled() noexcept
+    {
+        return JUCESONIC_REALTIME_SANITIZER != 0;
+    }
+
+    /** Marks the current thread as doing realtime work while in scope. Nestable. */
+    class ScopedRealtimeRegion
+    {
+    public:
+#if JUCESONIC_REALTIME_SANITIZER
+        ScopedRealtimeRegion() noexcept;
+        ~ScopedRealtimeRegion() noexcept;
+#else
+        ScopedRealtimeRegion() noexcept {} // User-provided, so an unused region doesn't warn
+#endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeRegion)
+    };
+
+    /** Distinct call sites recorded so far, across the whole process. */
+    static int getNumCallsites() noexcept;
+
+    /** Every record with its count and symbolised stack trace (message thread). */
+    static juce::String getReport();
+};
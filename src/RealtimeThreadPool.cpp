@@ -0,0 +1,153 @@
+#include "RealtimeThreadPool.h"
+#include "RealtimeSanitizer.h"
+
+#include <thread>
+
+//==============================================================================
+class RealtimeThreadPool::Worker : public juce::Thread
+{
+public:
+    Worker(RealtimeThreadPool& ownerPool, int index)
+        : juce::Thread("JSFX Realtime Worker " + juce::String(index))
+        , owner(ownerPool)
+    {
+        startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(8));
+    }
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wakeUp.signal();
+        stopThread(2000);
+    }
+
+    void wakeIfSleeping() noexcept
+    {
+        if (sleeping.load(std::memory_order_seq_cst))
+            wakeUp.signal();
+    }
+
+    void run() override
+    {
+        juce::uint32 seenSerial = 0;
+
+        while (!threadShouldExit())
+        {
+            const auto serial = static_cast<juce::uint32>(owner.jobState.load(std::memory_order_acquire) >> 32);
+            if (serial != seenSerial)
+            {
+                seenSerial = serial;
+
+                const RealtimeSanitizer::ScopedRealtimeRegion realtimeRegion;
+                owner.runTasks(serial);
+                idleSpins = 0;
+                continue;
+            }
+
+            // Stay responsive for the next block for a little while, then sleep until woken
+            if (++idleSpins < spinsBeforeSleep)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            sleeping.store(true, std::memory_order_seq_cst);
+
+            // Re-check after announcing the sleep, so a job published meanwhile isn't missed
+            if (static_cast<juce::uint32>(owner.jobState.load(std::memory_order_seq_cst) >> 32) == seenSerial)
+                wakeUp.wait(100);
+
+            sleeping.store(false, std::memory_order_release);
+            idleSpins = 0;
+        }
+    }
+
+private:
+    static constexpr int spinsBeforeSleep = 2000;
+
+    RealtimeThreadPool& owner;
+    juce::WaitableEvent wakeUp;
+    std::atomic<bool> sleeping{false};
+    int idleSpins = 0;
+};
+
+//==============================================================================
+RealtimeThreadPool::RealtimeThreadPool()
+{
+    // Leave one core to the calling audio thread
+    const int numWorkers = juce::jlimit(0, 15, juce::SystemStats::getNumCpus() - 1);
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<Worker>(*this, i));
+}
+
+RealtimeThreadPool::~RealtimeThreadPool()
+{
+    workers.clear();
+}
+
+void RealtimeThreadPool::run(int numTasks, TaskFunction function, void* context) noexcept
+{
+    jassert(numTasks <= maxTasksPerJob);
+
+    // Nothing to share, or another audio thread is using the pool: do it all here
+    if (numTasks <= 1 || workers.empty() || busy.exchange(true, std::memory_order_acquire))
+    {
+        for (int i = 0; i < numTasks; ++i)
+            function(context, i);
+        return;
+    }
+
+    jobFunction = function;
+    jobContext = context;
+    tasksRemaining.store(numTasks, std::memory_order_relaxed);
+
+    // Publishing the new serial releases the job fields above to the workers
+    const auto serial = ++lastSerial;
+    jobState.store(packJob(serial, 0, numTasks), std::memory_order_seq_cst);
+
+    const int numHelpers = juce::jmin(numTasks - 1, getNumWorkers());
+    for (int i = 0; i < numHelpers; ++i)
+        workers[static_cast<size_t>(i)]->wakeIfSleeping();
+
+    runTasks(serial);
+
+    // Tasks claimed by workers may still be running; they're short, so wait on the spot
+    while (tasksRemaining.load(std::memory_order_acquire) > 0)
+        spinPause();
+
+    busy.store(false, std::memory_order_release);
+}
+
+int RealtimeThreadPool::claimTask(juce::uint32 jobSerial) noexcept
+{
+    auto state = jobState.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto serial = static_cast<juce::uint32>(state >> 32);
+        const int nextTask = static_cast<int>((state >> 16) & 0xffff);
+        const int numTasks = static_cast<int>(state & 0xffff);
+
+        if (serial != jobSerial || nextTask >= numTasks)
+            return -1;
+
+        if (jobState.compare_exchange_weak(
+                state,
+                packJob(serial, nextTask + 1, numTasks),
+                std::memory_order_acq_rel,
+                std::memory_order_acquire
+            ))
+            return nextTask;
+    }
+}
+
+void RealtimeThreadPool::runTasks(juce::uint32 jobSerial) noexcept
+{
+    // A successful claim keeps the job (and its fields) alive until this task is counted as done
+    for (int task = claimTask(jobSerial); task >= 0; task = claimTask(jobSerial))
+    {
+        jobFunction(jobContext, task);
+        tasksRemaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
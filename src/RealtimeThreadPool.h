@@ -0,0 +1,93 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#if JUCE_INTEL
+    #include <immintrin.h>
+#elif JUCE_ARM && JUCE_MSVC
+    #include <intrin.h>
+#endif
+
+/**
+ * Process-wide pool of realtime-priority threads that help the audio thread
+ * process independent work in parallel within one processBlock.
+ *
+ * parallelFor() publishes a job of numTasks tasks. The calling audio thread
+ * works on the job too and returns once every task has finished. Dispatch is
+ * lock-free and allocation-free. Workers spin briefly after each job and then
+ * sleep, so they're only woken up through an event when they have gone idle.
+ * The audio thread never yields to the scheduler: while it waits for tasks
+ * other threads claimed, it busy-waits with spinPause().
+ *
+ * Shared by every plugin instance in the process via
+ * juce::SharedResourcePointer<RealtimeThreadPool>. Only one job runs at a time.
+ * A caller that finds the pool busy (another plugin's audio thread got there
+ * first) runs its tasks serially, so results never depend on scheduling.
+ */
+class RealtimeThreadPool
+{
+public:
+    using TaskFunction = void (*)(void* context, int taskIndex);
+
+    RealtimeThreadPool();
+    ~RealtimeThreadPool();
+
+    /** Worker threads, not counting the calling thread. */
+    int getNumWorkers() const noexcept
+    {
+        return static_cast<int>(workers.size());
+    }
+
+    /** Audio thread: call fn(taskIndex) for every task index, in parallel where possible. */
+    template <typename Fn>
+    void parallelFor(int numTasks, Fn& fn) noexcept
+    {
+        run(numTasks, [](void* context, int taskIndex) { (*static_cast<Fn*>(context))(taskIndex); }, &fn);
+    }
+
+    void run(int numTasks, TaskFunction function, void* context) noexcept;
+
+    static constexpr int maxTasksPerJob = 0xffff;
+
+    /** One iteration of a short busy-wait: a CPU hint rather than a trip to the scheduler. */
+    static void spinPause() noexcept
+    {
+#if JUCE_INTEL
+        _mm_pause();
+#elif JUCE_ARM && JUCE_MSVC
+        __yield();
+#elif JUCE_ARM
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+private:
+    class Worker;
+
+    // Claims the next task of the given job; -1 once the job has no unclaimed tasks left
+    int claimTask(juce::uint32 jobSerial) noexcept;
+    void runTasks(juce::uint32 jobSerial) noexcept;
+
+    static juce::uint64 packJob(juce::uint32 serial, int nextTask, int numTasks) noexcept
+    {
+        return (juce::uint64(serial) << 32) | (juce::uint64(nextTask) << 16) | juce::uint64(numTasks);
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Serial, next unclaimed task and task count in one word, so a claim can't
+    // mix up two jobs. The job fields below only change once every task is done.
+    std::atomic<juce::uint64> jobState{0};
+    TaskFunction jobFunction = nullptr;
+    void* jobContext = nullptr;
+    std::atomic<int> tasksRemaining{0};
+
+    std::atomic<bool> busy{false};
+    juce::uint32 lastSerial = 0; // Owned by whoever holds `busy`
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeThreadPool)
+};
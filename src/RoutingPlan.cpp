@@ -0,0 +1,144 @@
+#include "RoutingPlan.h"
+
+namespace
+{
+// Returns the channel count if the list is exactly {0->0, 1->1, ...} at unit gain, otherwise -1
+int getIdentityChannelCount(const RoutingPlan::ConnectionList& list)
+{
+    int expected = 0;
+    for (const auto& c : list)
+    {
+        if (c.source != expected || c.destination != expected || c.gain != 1.0f)
+            return -1;
+        ++expected;
+    }
+    return expected;
+}
+} // namespace
+
+void RoutingPlan::compile(const RoutingConfig& config)
+{
+    // Input routing: [JUCE input][JSFX input]
+    compileMatrix(config.inputRouting, config.numJuceInputs, config.numJsfxInputs, input);
+
+    // Sidechain routing: [JUCE sidechain][JSFX sidechain]
+    compileMatrix(config.sidechainRouting, config.numJuceSidechains, config.numJsfxSidechains, sidechain);
+
+    // Output routing: [JSFX output][JUCE output]
+    compileMatrix(config.outputRouting, config.numJsfxOutputs, config.numJuceOutputs, output);
+
+    identityInputChannels = (sidechain.numConnections == 0) ? getIdentityChannelCount(input) : -1;
+    identityOutputChannels = getIdentityChannelCount(output);
+}
+
+void RoutingPlan::compileMatrix(
+    const RoutingConfig::Matrix& matrix,
+    int numSources,
+    int numDestinations,
+    ConnectionList& list
+)
+{
+    list.clear();
+
+    const int rows = juce::jmin(numSources, PluginConstants::MaxChannels);
+    const int cols = juce::jmin(numDestinations, PluginConstants::MaxChannels);
+
+    for (int source = 0; source < rows; ++source)
+        for (int destination = 0; destination < cols; ++destination)
+            if (matrix[source][destination])
+                list.add(source, destination, 1.0f);
+}
+
+template <typename SampleType>
+void RoutingPlan::applyToInterleaved(
+    const ConnectionList& list,
+    const SampleType* const* sources,
+    int numSources,
+    double* interleaved,
+    int numJsfxChannels,
+    int numSamples
+)
+{
+    for (const auto& c : list)
+    {
+        if (c.source >= numSources || c.destination >= numJsfxChannels)
+            continue;
+
+        const SampleType* src = sources[c.source];
+        double* dst = interleaved + c.destination;
+        const double gain = c.gain;
+
+        // Unit gain is by far the common case - keep the inner loop free of the multiply
+        if (gain == 1.0)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+                dst[sample * numJsfxChannels] += src[sample];
+        }
+        else
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+                dst[sample * numJsfxChannels] += gain * src[sample];
+        }
+    }
+}
+
+template <typename SampleType>
+void RoutingPlan::applyFromInterleaved(
+    const ConnectionList& list,
+    const double* interleaved,
+    int numJsfxChannels,
+    SampleType* const* destinations,
+    int numDestinations,
+    int numSamples
+)
+{
+    for (const auto& c : list)
+    {
+        if (c.source >= numJsfxChannels || c.destination >= numDestinations)
+            continue;
+
+        const double* src = interleaved + c.source;
+        SampleType* dst = destinations[c.destination];
+        const double gain = c.gain;
+
+        if (gain == 1.0)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+                dst[sample] += static_cast<SampleType>(src[sample * numJsfxChannels]);
+        }
+        else
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+                dst[sample] += static_cast<SampleType>(gain * src[sample * numJsfxChannels]);
+        }
+    }
+}
+
+void RoutingPlan::mixInterleaved(
+    const ConnectionList& list,
+    const double* source,
+    int numSourceChannels,
+    double* destination,
+    int numDestinationChannels,
+    int numSamples
+)
+{
+    for (const auto& c : list)
+    {
+        if (c.source >= numSourceChannels || c.destination >= numDestinationChannels)
+            continue;
+
+        const double* src = source + c.source;
+        double* dst = destination + c.destination;
+        const double gain = c.gain;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            dst[sample * numDestinationChannels] += gain * src[sample * numSourceChannels];
+    }
+}
+
+// Explicit instantiations for the float and double processBlock paths
+template void RoutingPlan::applyToInterleaved(const ConnectionList&, const float* const*, int, double*, int, int);
+template void RoutingPlan::applyToInterleaved(const ConnectionList&, const double* const*, int, double*, int, int);
+template void RoutingPlan::applyFromInterleaved(const ConnectionList&, const double*, int, float* const*, int, int);
+template void RoutingPlan::applyFromInterleaved(const ConnectionList&, const double*, int, double* const*, int, int);
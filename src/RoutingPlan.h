@@ -0,0 +1,170 @@
+#pragma once
+
+#include <Config.h>
+
+#include <array>
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+// Lock-free routing configuration for realtime-safe communication
+struct RoutingConfig
+{
+    // Source channels -> destination channels (rows = sources, cols = destinations)
+    using Matrix = std::array<std::array<bool, PluginConstants::MaxChannels>, PluginConstants::MaxChannels>;
+
+    // Routing matrices stored as flat arrays
+    // Input: JUCE input channels -> JSFX channels (rows = JUCE, cols = JSFX)
+    Matrix inputRouting{};
+
+    // Sidechain: JUCE sidechain channels -> JSFX channels (rows = JUCE SC, cols = JSFX)
+    Matrix sidechainRouting{};
+
+    // Output: JSFX channels -> JUCE output channels (rows = JSFX, cols = JUCE)
+    Matrix outputRouting{};
+
+    int numJuceInputs = 0;
+    int numJuceSidechains = 0;
+    int numJuceOutputs = 0;
+    int numJsfxInputs = 0;
+    int numJsfxSidechains = 0;
+    int numJsfxOutputs = 0;
+
+    // Initialize with 1:1 diagonal routing
+    void setDiagonal()
+    {
+        // Clear all
+        for (auto& row : inputRouting)
+            row.fill(false);
+        for (auto& row : sidechainRouting)
+            row.fill(false);
+        for (auto& row : outputRouting)
+            row.fill(false);
+
+        // Set diagonals
+        for (int i = 0; i < juce::jmin(numJuceInputs, numJsfxInputs); ++i)
+            inputRouting[i][i] = true;
+        for (int i = 0; i < juce::jmin(numJuceSidechains, numJsfxSidechains); ++i)
+            sidechainRouting[i][i] = true;
+        for (int i = 0; i < juce::jmin(numJsfxOutputs, numJuceOutputs); ++i)
+            outputRouting[i][i] = true;
+    }
+};
+
+//==============================================================================
+/**
+ * Sparse, precompiled form of a RoutingConfig.
+ *
+ * The boolean matrices are flattened on the message thread into lists of
+ * (source, destination, gain) connections, so the audio thread only walks the
+ * connections that are actually set. Routing cost therefore scales with the
+ * number of active connections instead of channels².
+ *
+ * Storage is fixed-size so a plan can live in the same triple buffer as its
+ * RoutingConfig without any allocation on either thread.
+ */
+struct RoutingPlan
+{
+    struct Connection
+    {
+        int source = 0;
+        int destination = 0;
+        float gain = 1.0f;
+    };
+
+    struct ConnectionList
+    {
+        static constexpr int MaxConnections = PluginConstants::MaxChannels * PluginConstants::MaxChannels;
+
+        std::array<Connection, MaxConnections> connections{};
+        int numConnections = 0;
+
+        void clear()
+        {
+            numConnections = 0;
+        }
+
+        void add(int source, int destination, float gain)
+        {
+            if (numConnections < MaxConnections)
+                connections[static_cast<size_t>(numConnections++)] = {source, destination, gain};
+        }
+
+        const Connection* begin() const
+        {
+            return connections.data();
+        }
+
+        const Connection* end() const
+        {
+            return connections.data() + numConnections;
+        }
+    };
+
+    ConnectionList input;     // JUCE main inputs -> JSFX channels
+    ConnectionList sidechain; // JUCE sidechain inputs -> JSFX channels
+    ConnectionList output;    // JSFX channels -> JUCE outputs
+
+    // Number of leading channels routed 1:1 at unit gain when the whole matrix is
+    // a plain diagonal (the default), or -1 if any other connection is present.
+    // Lets processBlock use straight interleave/deinterleave instead of clear-then-accumulate.
+    int identityInputChannels = -1;
+    int identityOutputChannels = -1;
+
+    /**
+     * Rebuild the connection lists from a routing matrix (message thread only).
+     */
+    void compile(const RoutingConfig& config);
+
+    /**
+     * Rebuild one connection list from a matrix, for the first numSources rows
+     * and numDestinations columns (message thread only).
+     */
+    static void compileMatrix(
+        const RoutingConfig::Matrix& matrix,
+        int numSources,
+        int numDestinations,
+        ConnectionList& list
+    );
+
+    /**
+     * Accumulate planar JUCE channels (float or double) into the interleaved JSFX buffer.
+     * The destination must be cleared by the caller. Connections referring to
+     * channels beyond numSources / numJsfxChannels are skipped.
+     */
+    template <typename SampleType>
+    static void applyToInterleaved(
+        const ConnectionList& list,
+        const SampleType* const* sources,
+        int numSources,
+        double* interleaved,
+        int numJsfxChannels,
+        int numSamples
+    );
+
+    /**
+     * Accumulate interleaved JSFX channels into planar JUCE outputs.
+     * The destination channels must be cleared by the caller.
+     */
+    template <typename SampleType>
+    static void applyFromInterleaved(
+        const ConnectionList& list,
+        const double* interleaved,
+        int numJsfxChannels,
+        SampleType* const* destinations,
+        int numDestinations,
+        int numSamples
+    );
+
+    /**
+     * Accumulate one interleaved buffer into another (JSFX graph edges).
+     * The destination must be cleared by the caller.
+     */
+    static void mixInterleaved(
+        const ConnectionList& list,
+        const double* source,
+        int numSourceChannels,
+        double* destination,
+        int numDestinationChannels,
+        int numSamples
+    );
+};
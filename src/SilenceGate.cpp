@@ -0,0 +1,105 @@
+#include "SilenceGate.h"
+
+#include <Config.h>
+
+namespace
+{
+const double silenceThreshold = juce::Decibels::decibelsToGain(PluginConstants::SilenceThresholdDb);
+} // namespace
+
+SilenceGate::SilenceGate()
+{
+    prepare(sampleRate);
+}
+
+void SilenceGate::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    holdSamples = juce::roundToInt(PluginConstants::SilenceHoldMs * 0.001 * sampleRate);
+    reset();
+}
+
+void SilenceGate::setTailSeconds(double seconds) noexcept
+{
+    tailSeconds.store(seconds < 0.0 ? -1.0 : seconds, std::memory_order_relaxed);
+}
+
+double SilenceGate::getReportedTailSeconds() const noexcept
+{
+    const double userTail = getTailSeconds();
+    if (userTail >= 0.0)
+        return userTail;
+
+    // Nothing measured yet (or sleeping is off): a host cutting the tail short would truncate echoes
+    const double measuredTail = measuredTailSeconds.load(std::memory_order_relaxed);
+    return measuredTail >= 0.0 ? measuredTail : PluginConstants::UnmeasuredTailSeconds;
+}
+
+void SilenceGate::reset() noexcept
+{
+    silentInputSamples = 0;
+    silentOutputSamples = 0;
+    sleeping = false;
+    measuredTailSeconds.store(-1.0, std::memory_order_relaxed);
+}
+
+bool SilenceGate::shouldSkip(bool inputIsSilent) noexcept
+{
+    if (!inputIsSilent || !isEnabled())
+    {
+        // Signal is back: wake up and start counting the next tail from scratch
+        sleeping = false;
+        silentInputSamples = 0;
+        silentOutputSamples = 0;
+        return false;
+    }
+
+    return sleeping;
+}
+
+void SilenceGate::wake() noexcept
+{
+    sleeping = false;
+    silentInputSamples = 0;
+    silentOutputSamples = 0;
+}
+
+void SilenceGate::blockProcessed(bool inputWasSilent, bool outputWasSilent, int numSamples, int latencySamples) noexcept
+{
+    silentInputSamples = inputWasSilent ? silentInputSamples + numSamples : 0;
+    silentOutputSamples = outputWasSilent ? silentOutputSamples + numSamples : 0;
+
+    if (!inputWasSilent || !isEnabled())
+        return;
+
+    const double userTail = getTailSeconds();
+    if (userTail >= 0.0)
+    {
+        // Fixed tail: sleep once the input has been silent for the tail plus the JSFX's latency
+        const auto tailSamples = static_cast<juce::int64>(userTail * sampleRate) + latencySamples;
+        sleeping = silentInputSamples >= tailSamples;
+        return;
+    }
+
+    // Detected tail: everything that was in flight at the start of the input silence must be out,
+    // and the output must have stayed silent long enough not to be a gap between echoes
+    if (silentInputSamples > latencySamples && silentOutputSamples >= holdSamples + latencySamples)
+    {
+        sleeping = true;
+
+        // Input went silent silentInputSamples ago; the output has been silent for silentOutputSamples
+        const double tail = static_cast<double>(juce::jmax<juce::int64>(0, silentInputSamples - silentOutputSamples))
+                          / sampleRate;
+        if (tail > measuredTailSeconds.load(std::memory_order_relaxed))
+            measuredTailSeconds.store(tail, std::memory_order_relaxed);
+    }
+}
+
+bool SilenceGate::isSilent(const double* data, int numValues) noexcept
+{
+    if (numValues <= 0)
+        return true;
+
+    const auto range = juce::FloatVectorOperations::findMinAndMax(data, numValues);
+    return range.getStart() >= -silenceThreshold && range.getEnd() <= silenceThreshold;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+
+/**
+ * Decides when the JSFX can be put to sleep because nothing would come out of it.
+ *
+ * The processor reports each block: whether the routed input was silent, and
+ * after processing, whether the output was. Once the input has been silent for
+ * longer than the effect's tail, shouldSkip() returns true and the JSFX call is
+ * skipped until the input carries signal again, or until wake() reports some
+ * other change the JSFX reacts to. Sleeping is off until setEnabled(true).
+ *
+ * The tail is either set by the user, or found automatically: the output must
+ * have stayed silent for PluginConstants::SilenceHoldMs (so gaps between echoes of
+ * a long delay don't count as the end of the tail). The measured time from input
+ * silence to output silence is reported to the host as the tail length; until
+ * there is one, PluginConstants::UnmeasuredTailSeconds is.
+ *
+ * prepare() and the setters run on the message thread; everything else on the
+ * audio thread.
+ */
+class SilenceGate
+{
+public:
+    SilenceGate();
+
+    void prepare(double sampleRate);
+
+    /** Tail length in seconds after which the JSFX sleeps; a negative value detects it from the output. */
+    void setTailSeconds(double seconds) noexcept;
+
+    double getTailSeconds() const noexcept
+    {
+        return tailSeconds.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool shouldSleepOnSilence) noexcept
+    {
+        enabled.store(shouldSleepOnSilence, std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const noexcept
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /** Tail to report to the host: the user's, the longest one measured so far, or a conservative default. */
+    double getReportedTailSeconds() const noexcept;
+
+    //==============================================================================
+    /** Start over, including the measured tail, e.g. when a different JSFX instance takes over. */
+    void reset() noexcept;
+
+    /** Before processing: true if the block can be skipped (the output is silence). */
+    bool shouldSkip(bool inputIsSilent) noexcept;
+
+    /** Before shouldSkip(): parameters, the preset or the transport changed, so run the JSFX again. */
+    void wake() noexcept;
+
+    /** After processing a block that wasn't skipped. latencySamples is the JSFX's current latency. */
+    void blockProcessed(bool inputWasSilent, bool outputWasSilent, int numSamples, int latencySamples) noexcept;
+
+    bool isSleeping() const noexcept
+    {
+        return sleeping;
+    }
+
+    /** Vectorised peak check: true if no value exceeds the silence threshold. */
+    static bool isSilent(const double* data, int numValues) noexcept;
+
+private:
+    std::atomic<double> tailSeconds{-1.0};
+    std::atomic<bool> enabled{false};
+    std::atomic<double> measuredTailSeconds{-1.0}; // Audio thread -> host queries; negative until measured
+    double sampleRate = 44100.0;
+    int holdSamples = 0;
+
+    // Audio thread
+    juce::int64 silentInputSamples = 0;
+    juce::int64 silentOutputSamples = 0;
+    bool sleeping = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SilenceGate)
+};
@@ -0,0 +1,124 @@
+#include "XrunDetector.h"
+
+//==============================================================================
+void XrunDetector::setContext(const juce::String& jsfxPath, const juce::String& presetName)
+{
+    const auto number = currentContext.load(std::memory_order_relaxed) + 1;
+    contexts[number % numContexts] = {jsfxPath, presetName};
+    currentContext.store(number, std::memory_order_release);
+}
+
+int XrunDetector::collect()
+{
+    const auto newestContext = currentContext.load(std::memory_order_acquire);
+    int numAdded = 0;
+
+    const auto scope = fifo.read(fifo.getNumReady());
+    scope.forEach(
+        [this, newestContext, &numAdded](int index)
+        {
+            const auto& record = records[static_cast<size_t>(index)];
+
+            Event event;
+            event.time = juce::Time(record.timeMillis);
+            event.block = record.block;
+            event.deadlineMicros = static_cast<double>(record.deadlineNanos) * 0.001;
+
+            for (size_t stage = 0; stage < event.stageMicros.size(); ++stage)
+                event.stageMicros[stage] = static_cast<double>(record.stageNanos[stage]) * 0.001;
+
+            event.wallMicros = event.stageMicros[static_cast<size_t>(ProcessProfiler::Stage::Total)];
+
+            // The table slot has been reused if numContexts contexts were published since
+            event.contextKnown = newestContext - record.context < static_cast<juce::uint32>(numContexts);
+            if (event.contextKnown)
+            {
+                const auto& context = contexts[record.context % numContexts];
+                event.jsfxPath = context.jsfxPath;
+                event.presetName = context.presetName;
+            }
+
+            events.push_back(std::move(event));
+            if (events.size() > static_cast<size_t>(maxEvents))
+                events.pop_front();
+
+            ++numAdded;
+        }
+    );
+
+    numCollected += static_cast<juce::uint32>(numAdded);
+    return numAdded;
+}
+
+void XrunDetector::clear()
+{
+    events.clear();
+}
+
+juce::String XrunDetector::toJson() const
+{
+    juce::Array<juce::var> list;
+
+    for (const auto& event : events)
+    {
+        auto* stages = new juce::DynamicObject();
+        for (int stage = 0; stage < ProcessProfiler::numStages; ++stage)
+            stages->setProperty(
+                ProcessProfiler::getStageName(static_cast<ProcessProfiler::Stage>(stage)),
+                event.stageMicros[static_cast<size_t>(stage)]
+            );
+
+        auto* object = new juce::DynamicObject();
+        object->setProperty("time", event.time.toISO8601(true));
+        object->setProperty("wallMicros", event.wallMicros);
+        object->setProperty("deadlineMicros", event.deadlineMicros);
+        object->setProperty("blockSize", event.block.numSamples);
+        object->setProperty("sampleRate", event.block.sampleRate);
+        object->setProperty("jsfxPath", event.contextKnown ? juce::var(event.jsfxPath) : juce::var());
+        object->setProperty("preset", event.contextKnown ? juce::var(event.presetName) : juce::var());
+        object->setProperty("presetApplied", event.block.presetApplied);
+        object->setProperty("parameterChanges", event.block.numParameterChanges);
+        object->setProperty("rampingParameters", event.block.numRampingParameters);
+        object->setProperty("midiEvents", event.block.numMidiEvents);
+        object->setProperty("stageMicros", juce::var(stages));
+
+        list.add(juce::var(object));
+    }
+
+    return juce::JSON::toString(juce::var(list));
+}
+
+//==============================================================================
+void XrunDetector::checkBlock(const ProcessProfiler& profiler, const BlockInfo& block) noexcept
+{
+    const auto deadlineNanos = profiler.getLastBlockDeadlineNanos();
+    const auto wallNanos = profiler.getLastBlockNanos(ProcessProfiler::Stage::Total);
+
+    if (deadlineNanos == 0 || wallNanos <= deadlineNanos)
+        return;
+
+    const auto scope = fifo.write(1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+    {
+        // Single writer: a plain load and store is enough
+        numDropped.store(numDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    scope.forEach(
+        [&](int index)
+        {
+            auto& record = records[static_cast<size_t>(index)];
+            record.timeMillis = juce::Time::currentTimeMillis();
+            record.block = block;
+            record.deadlineNanos = deadlineNanos;
+            record.context = currentContext.load(std::memory_order_acquire);
+
+            for (int stage = 0; stage < ProcessProfiler::numStages; ++stage)
+            {
+                const auto nanos = profiler.getLastBlockNanos(static_cast<ProcessProfiler::Stage>(stage));
+                record.stageNanos[static_cast<size_t>(stage)] = nanos;
+            }
+        }
+    );
+}
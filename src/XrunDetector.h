@@ -0,0 +1,122 @@
+#pragma once
+
+#include "ProcessProfiler.h"
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+#include <deque>
+
+/**
+ * Log of blocks that overran their real-time budget, with what was going on at
+ * the time, so intermittent dropouts can be traced to an effect or preset change.
+ *
+ * After ProcessProfiler::endBlock(), the audio thread compares the block's wall
+ * time with numSamples / sampleRate. A miss goes into a lock-free FIFO together
+ * with the stage timings and block details; nothing is allocated.
+ *
+ * The JSFX path and preset name aren't copied on the audio thread. The message
+ * thread numbers each context it publishes with setContext(), and the audio
+ * thread records only the number. collect() (message thread, timer) drains the
+ * FIFO, resolves the numbers against the recent contexts and keeps the last
+ * maxEvents events.
+ */
+class XrunDetector
+{
+public:
+    /** Details of the block being checked, gathered by the audio thread. */
+    struct BlockInfo
+    {
+        int numSamples = 0;
+        double sampleRate = 0.0;
+        int numMidiEvents = 0;        // In and out
+        int numParameterChanges = 0;  // Moved on either side during the block
+        int numRampingParameters = 0; // Still smoothing towards a new value
+        bool presetApplied = false;   // A preset was loaded at the start of the block
+    };
+
+    struct Event
+    {
+        juce::Time time;
+        BlockInfo block;
+        double wallMicros = 0.0;
+        double deadlineMicros = 0.0;
+        std::array<double, ProcessProfiler::numStages> stageMicros{};
+        juce::String jsfxPath;     // Empty when no JSFX was loaded
+        juce::String presetName;   // Empty when no preset was loaded since the JSFX
+        bool contextKnown = true;  // False if too many contexts were published since to tell which
+    };
+
+    static constexpr int maxEvents = 256;
+
+    XrunDetector() = default;
+
+    //==============================================================================
+    /** Message thread: the JSFX and preset that blocks run with from now on. */
+    void setContext(const juce::String& jsfxPath, const juce::String& presetName);
+
+    /** Message thread (timer): move new misses into the history. Returns the number added. */
+    int collect();
+
+    /** Message thread: the last maxEvents misses, oldest first. */
+    const std::deque<Event>& getEvents() const noexcept
+    {
+        return events;
+    }
+
+    /** Message thread: misses collected since construction, including ones dropped from the history. */
+    juce::uint32 getNumCollected() const noexcept
+    {
+        return numCollected;
+    }
+
+    /** Any thread: misses lost because the FIFO was full. */
+    juce::uint32 getNumDropped() const noexcept
+    {
+        return numDropped.load(std::memory_order_relaxed);
+    }
+
+    /** Message thread: forget the history. */
+    void clear();
+
+    /** Message thread: the history as a JSON array, one object per miss. */
+    juce::String toJson() const;
+
+    //==============================================================================
+    /** Audio thread, after profiler.endBlock(): log the block if it missed its deadline. Realtime safe. */
+    void checkBlock(const ProcessProfiler& profiler, const BlockInfo& block) noexcept;
+
+private:
+    // Audio thread -> message thread
+    struct Record
+    {
+        juce::int64 timeMillis = 0;
+        BlockInfo block;
+        std::array<juce::uint64, ProcessProfiler::numStages> stageNanos{};
+        juce::uint64 deadlineNanos = 0;
+        juce::uint32 context = 0;
+    };
+
+    struct Context
+    {
+        juce::String jsfxPath;
+        juce::String presetName;
+    };
+
+    static constexpr int fifoSize = 64;
+    static constexpr int numContexts = 64;
+
+    juce::AbstractFifo fifo{fifoSize};
+    std::array<Record, fifoSize> records{};
+    std::atomic<juce::uint32> numDropped{0}; // Written by the audio thread only
+
+    // Number of the newest context; the table holds the last numContexts (message thread)
+    std::atomic<juce::uint32> currentContext{0};
+    std::array<Context, numContexts> contexts;
+
+    std::deque<Event> events; // Message thread
+    juce::uint32 numCollected = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(XrunDetector)
+};
@@ -0,0 +1,313 @@
+#include "BatchRenderer.h"
+
+#include <atomic>
+#include <memory>
+#include <ostream>
+
+namespace
+{
+juce::Array<int> parseBlockSizes(const juce::var& value)
+{
+    // Out-of-range sizes are rejected by OfflineRenderer::prepare(), per job
+    juce::Array<int> blockSizes;
+    if (auto* array = value.getArray())
+    {
+        for (const auto& element : *array)
+            blockSizes.add(static_cast<int>(element));
+    }
+    else
+    {
+        for (const auto& token : juce::StringArray::fromTokens(value.toString(), ",", ""))
+            blockSizes.add(token.trim().getIntValue());
+    }
+
+    return blockSizes;
+}
+
+juce::Array<juce::File> parseFiles(const juce::var& value, const juce::File& baseDirectory)
+{
+    juce::StringArray paths;
+    if (auto* array = value.getArray())
+    {
+        for (const auto& element : *array)
+            paths.add(element.toString());
+    }
+    else
+    {
+        paths.addTokens(value.toString(), ",", "");
+    }
+
+    juce::Array<juce::File> files;
+    for (const auto& path : paths)
+        files.add(baseDirectory.getChildFile(path.trim()));
+
+    return files;
+}
+
+juce::Result applyFields(const juce::var& fields, const juce::File& baseDirectory, BatchRenderer::Job& job)
+{
+    auto* object = fields.getDynamicObject();
+    if (!object)
+        return juce::Result::fail("Jobs and defaults must be JSON objects");
+
+    auto& settings = job.settings;
+    for (const auto& property : object->getProperties())
+    {
+        const auto key = property.name.toString();
+        const auto& value = property.value;
+
+        if (key == "name")
+            job.name = value.toString();
+        else if (key == "input")
+            job.input = baseDirectory.getChildFile(value.toString());
+        else if (key == "output")
+            job.output = baseDirectory.getChildFile(value.toString());
+        else if (key == "jsfx")
+            settings.jsfxFile = baseDirectory.getChildFile(value.toString());
+        else if (key == "preset")
+            settings.presetFile = baseDirectory.getChildFile(value.toString());
+        else if (key == "presetName")
+            settings.presetName = value.toString();
+        else if (key == "routing")
+            settings.routing = value.toString();
+        else if (key == "blockSize")
+            settings.blockSizes = parseBlockSizes(value);
+        else if (key == "accumulate")
+            settings.accumulatorBlockSize = static_cast<int>(value);
+        else if (key == "oversample")
+            settings.oversamplingFactor = static_cast<int>(value);
+        else if (key == "linearPhase")
+            settings.oversamplingLinearPhase = static_cast<bool>(value);
+        else if (key == "split")
+        {
+            if (auto result = OfflineRenderer::parseSplit(value.toString(), settings); result.failed())
+                return result;
+        }
+        else if (key == "branches")
+            settings.branchFiles = parseFiles(value, baseDirectory);
+        else if (key == "dry")
+            settings.branchesIncludeDry = static_cast<bool>(value);
+        else if (key == "chain")
+            settings.chainFiles = parseFiles(value, baseDirectory);
+        else if (key == "pipelineChain")
+            settings.pipelineChain = static_cast<bool>(value);
+        else if (key == "double")
+            settings.doublePrecision = static_cast<bool>(value);
+        else if (key == "tail")
+            settings.tailSeconds = juce::jmax(0.0, static_cast<double>(value));
+        else if (key == "bits")
+            settings.bitsPerSample = static_cast<int>(value);
+        else if (key == "latencyCompensation")
+            settings.compensateLatency = static_cast<bool>(value);
+        else
+            return juce::Result::fail("Unknown field " + key.quoted());
+    }
+
+    return juce::Result::ok();
+}
+
+enum class JobStatus
+{
+    queued,
+    running,
+    finished
+};
+
+struct JobState
+{
+    std::atomic<JobStatus> status{JobStatus::queued};
+    std::atomic<double> progress{0.0};
+    BatchRenderer::JobReport report; // Written by the worker before status becomes finished
+    bool reported = false;           // Calling thread only
+};
+} // namespace
+
+//==============================================================================
+juce::Result BatchRenderer::loadManifest(const juce::File& manifest, std::vector<Job>& jobs)
+{
+    juce::var root;
+    if (auto result = juce::JSON::parse(manifest.loadFileAsString(), root); result.failed())
+        return juce::Result::fail(manifest.getFileName() + ": " + result.getErrorMessage());
+
+    const auto baseDirectory = manifest.getParentDirectory();
+
+    Job defaults;
+    juce::var jobList = root;
+    if (root.isObject())
+    {
+        if (root.hasProperty("defaults"))
+            if (auto result = applyFields(root["defaults"], baseDirectory, defaults); result.failed())
+                return juce::Result::fail("defaults: " + result.getErrorMessage());
+
+        jobList = root["jobs"];
+    }
+
+    auto* jobArray = jobList.getArray();
+    if (!jobArray || jobArray->isEmpty())
+        return juce::Result::fail(manifest.getFileName() + " has no jobs");
+
+    jobs.clear();
+    for (int index = 0; index < jobArray->size(); ++index)
+    {
+        Job job = defaults;
+        const auto where = "Job " + juce::String(index + 1) + ": ";
+
+        if (auto result = applyFields(jobArray->getReference(index), baseDirectory, job); result.failed())
+            return juce::Result::fail(where + result.getErrorMessage());
+
+        if (job.input == juce::File{} || job.output == juce::File{} || job.settings.jsfxFile == juce::File{})
+            return juce::Result::fail(where + "needs an input, an output and a JSFX");
+
+        // Two workers writing one file would leave neither result
+        for (const auto& other : jobs)
+            if (other.output == job.output || other.input == job.output)
+                return juce::Result::fail(where + job.output.getFullPathName() + " is used by another job");
+
+        if (job.name.isEmpty())
+            job.name = job.input.getFileName();
+
+        jobs.push_back(std::move(job));
+    }
+
+    return juce::Result::ok();
+}
+
+int BatchRenderer::getDefaultNumThreads()
+{
+    return juce::jmax(1, juce::SystemStats::getNumPhysicalCpus());
+}
+
+//==============================================================================
+std::vector<BatchRenderer::JobReport> BatchRenderer::run(
+    const std::vector<Job>& jobs,
+    int numThreads,
+    std::ostream& log
+)
+{
+    const auto numJobs = jobs.size();
+    std::vector<std::unique_ptr<JobState>> states;
+    for (size_t index = 0; index < numJobs; ++index)
+        states.push_back(std::make_unique<JobState>());
+
+    const auto batchStart = juce::Time::getMillisecondCounterHiRes();
+
+    juce::ThreadPool pool(juce::ThreadPoolOptions{}
+                              .withThreadName("Render Worker")
+                              .withNumberOfThreads(juce::jmax(1, numThreads)));
+
+    for (size_t index = 0; index < numJobs; ++index)
+    {
+        pool.addJob(
+            [&job = jobs[index], &state = *states[index]]()
+            {
+                state.status.store(JobStatus::running);
+                const auto start = juce::Time::getMillisecondCounterHiRes();
+
+                const auto outputDirectory = job.output.getParentDirectory();
+                if (!outputDirectory.createDirectory())
+                {
+                    state.report.result = juce::Result::fail("Could not create " + outputDirectory.getFullPathName());
+                }
+                else
+                {
+                    // Streams the file in chunks through a processor of its own
+                    OfflineRenderer renderer(job.settings);
+                    renderer.onProgress = [&state](double progress)
+                    { state.progress.store(progress, std::memory_order_relaxed); };
+
+                    state.report.result = renderer.renderFile(job.input, job.output, state.report.statistics);
+                }
+
+                state.report.wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+                state.status.store(JobStatus::finished, std::memory_order_release);
+            }
+        );
+    }
+
+    log << "Rendering " << numJobs << " files on " << pool.getNumThreads() << " threads" << std::endl;
+
+    size_t numFinished = 0;
+    auto lastProgressTime = batchStart;
+
+    while (numFinished < numJobs)
+    {
+        juce::Thread::sleep(100);
+
+        for (size_t index = 0; index < numJobs; ++index)
+        {
+            auto& state = *states[index];
+            if (state.reported || state.status.load(std::memory_order_acquire) != JobStatus::finished)
+                continue;
+
+            state.reported = true;
+            ++numFinished;
+
+            const auto& report = state.report;
+            log << "[" << numFinished << "/" << numJobs << "] " << jobs[index].name;
+
+            if (report.result.failed())
+            {
+                log << " FAILED: " << report.result.getErrorMessage() << std::endl;
+                continue;
+            }
+
+            log << " -> "
+                << jobs[index].output.getFileName()
+                << ": "
+                << juce::String(report.wallSeconds, 2)
+                << " s ("
+                << juce::String(report.statistics.processSeconds, 2)
+                << " s processing, "
+                << juce::String(report.statistics.getRealtimeFactor(), 1)
+                << "x real time)"
+                << std::endl;
+        }
+
+        // Running jobs and how far along they are, about once a second
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        if (numFinished < numJobs && now - lastProgressTime >= 1000.0)
+        {
+            lastProgressTime = now;
+
+            juce::StringArray running;
+            for (size_t index = 0; index < numJobs; ++index)
+            {
+                if (states[index]->status.load() != JobStatus::running)
+                    continue;
+
+                const auto progress = states[index]->progress.load(std::memory_order_relaxed);
+                running.add(jobs[index].name + " " + juce::String(juce::roundToInt(progress * 100.0)) + "%");
+            }
+
+            log << "  " << numFinished << "/" << numJobs << " done; " << running.joinIntoString(", ") << std::endl;
+        }
+    }
+
+    std::vector<JobReport> reports;
+    int numFailed = 0;
+    double audioSeconds = 0.0;
+    for (size_t index = 0; index < numJobs; ++index)
+    {
+        const auto& report = states[index]->report;
+        reports.push_back(report);
+
+        if (report.result.failed())
+            ++numFailed;
+        else if (report.statistics.sampleRate > 0.0)
+            audioSeconds += static_cast<double>(report.statistics.numSamples) / report.statistics.sampleRate;
+    }
+
+    const auto batchSeconds = (juce::Time::getMillisecondCounterHiRes() - batchStart) / 1000.0;
+    log << "Rendered "
+        << (static_cast<int>(numJobs) - numFailed)
+        << " of "
+        << numJobs
+        << " files in "
+        << juce::String(batchSeconds, 2)
+        << " s, "
+        << juce::String(batchSeconds > 0.0 ? audioSeconds / batchSeconds : 0.0, 1)
+        << "x real time overall"
+        << std::endl;
+
+    return reports;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "OfflineRenderer.h"
+
+#include <iosfwd>
+#include <vector>
+
+/**
+ * Renders a list of files on a pool of threads, each job through its own
+ * OfflineRenderer: one processor and JSFX instance per job, not per worker.
+ * A JSFX has no way to return to its freshly initialised state short of
+ * compiling it again, so a reused instance would carry one file's tails and
+ * envelopes into the next. Processor setup is serialised across workers (see
+ * OfflineRenderer), so it costs more the shorter the files are.
+ *
+ * Jobs come from a JSON manifest:
+ *
+ *     {
+ *       "defaults": { "jsfx": "effects/comp.jsfx", "blockSize": 512 },
+ *       "jobs": [
+ *         { "input": "stems/drums.wav", "output": "out/drums.flac", "preset": "comp.rpl" },
+ *         { "input": "stems/bass.wav", "output": "out/bass.flac", "routing": "0110,,1001", "tail": 2 }
+ *       ]
+ *     }
+ *
+ * Every job takes the defaults, then its own fields. Fields: name, input, output,
+ * jsfx, preset, presetName, routing, blockSize (a number, an array or "64,128"),
+ * accumulate, oversample, linearPhase, split, branches and chain (an array of
+ * paths or "a.jsfx,b.jsfx"), dry, pipelineChain, double, tail, bits,
+ * latencyCompensation. Relative paths are relative to the
+ * manifest. A bare array of jobs works too.
+ */
+class BatchRenderer
+{
+public:
+    struct Job
+    {
+        juce::String name; // For the report; the input's file name unless the manifest sets one
+        juce::File input;
+        juce::File output;
+        OfflineRenderer::Settings settings;
+    };
+
+    struct JobReport
+    {
+        juce::Result result = juce::Result::ok();
+        OfflineRenderer::Statistics statistics;
+        double wallSeconds = 0.0; // Including processor setup and file I/O
+    };
+
+    /** Read the jobs from a manifest, checking each has a JSFX, an input and an output of its own. */
+    static juce::Result loadManifest(const juce::File& manifest, std::vector<Job>& jobs);
+
+    /**
+     * Run the jobs on numThreads threads, writing progress and a line per finished
+     * job to log. Blocks until all are done; returns one report per job, in order.
+     */
+    static std::vector<JobReport> run(const std::vector<Job>& jobs, int numThreads, std::ostream& log);
+
+    /** One thread per physical core. */
+    static int getDefaultNumThreads();
+};
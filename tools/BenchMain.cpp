@@ -0,0 +1,263 @@
+/*
+  juceSonic_Bench: time the processor's processBlock over a sweep of block sizes,
+  channel counts, routings and parameter and MIDI traffic, for a JSFX that does
+  nothing (the wrapper's baseline) and the bundled effects. Results are JSON, to compare
+  between releases.
+
+  juceSonic_Bench [--output results.json] [options]
+*/
+
+#include "ProcessBenchmark.h"
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+namespace
+{
+const char* const usage = "Usage: juceSonic_Bench [options]\n"
+                          "\n"
+                          "  --output <file.json>        Write the results here (default: standard output)\n"
+                          "  --effect <file[,file...]>   Also time these JSFX\n"
+                          "  --full                      Every combination instead of one axis at a time\n"
+                          "  --seconds <s>               Timed wall time per case (default 0.25)\n"
+                          "  --double                    Process in double precision\n";
+
+const int blockSizes[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+const int channelCounts[] = {1, 2, 4, 8, 16, 32, 64};
+const int routingChannelCounts[] = {2, 16, 64};
+const int parameterChangeRates[] = {0, 1, 4, 16, 64};
+const int midiEventRates[] = {0, 1, 16, 128};
+const ProcessBenchmark::Routing routings[] = {
+    ProcessBenchmark::Routing::diagonal,
+    ProcessBenchmark::Routing::dense,
+    ProcessBenchmark::Routing::sparse
+};
+
+// Slider and sample section, but no code: the wrapper's baseline. Without a JSFX the processor
+// just clears the buffer, so that wouldn't time the wrapper at all.
+const char* const nullEffect = "desc:Null effect (juceSonic_Bench)\n"
+                               "slider1:0<0,1,0.001>Unused\n"
+                               "@sample\n";
+
+struct Effect
+{
+    juce::String name;
+    juce::File file;
+};
+
+std::vector<ProcessBenchmark::Case> makeCases(const std::vector<Effect>& effects, bool full, bool doublePrecision)
+{
+    std::vector<ProcessBenchmark::Case> cases;
+    std::set<juce::String> seen;
+
+    auto add = [&](const ProcessBenchmark::Case& benchmarkCase)
+    {
+        // The axes cross at the default case; time it once
+        const auto key = benchmarkCase.effectName
+                       + "/" + juce::String(benchmarkCase.blockSize)
+                       + "/" + juce::String(benchmarkCase.numChannels)
+                       + "/" + ProcessBenchmark::getRoutingName(benchmarkCase.routing)
+                       + "/" + juce::String(benchmarkCase.parameterChangesPerBlock)
+                       + "/" + juce::String(benchmarkCase.midiEventsPerBlock);
+
+        if (seen.insert(key).second)
+            cases.push_back(benchmarkCase);
+    };
+
+    for (const auto& effect : effects)
+    {
+        ProcessBenchmark::Case base;
+        base.effectName = effect.name;
+        base.jsfxFile = effect.file;
+        base.doublePrecision = doublePrecision;
+
+        if (full)
+        {
+            for (const int blockSize : blockSizes)
+                for (const int numChannels : channelCounts)
+                    for (const auto routing : routings)
+                        for (const int parameterChanges : parameterChangeRates)
+                            for (const int midiEvents : midiEventRates)
+                            {
+                                auto benchmarkCase = base;
+                                benchmarkCase.blockSize = blockSize;
+                                benchmarkCase.numChannels = numChannels;
+                                benchmarkCase.routing = routing;
+                                benchmarkCase.parameterChangesPerBlock = parameterChanges;
+                                benchmarkCase.midiEventsPerBlock = midiEvents;
+                                add(benchmarkCase);
+                            }
+
+            continue;
+        }
+
+        // One axis at a time around 512 samples, stereo, diagonal, no traffic
+        for (const int blockSize : blockSizes)
+        {
+            auto benchmarkCase = base;
+            benchmarkCase.blockSize = blockSize;
+            add(benchmarkCase);
+        }
+
+        for (const int numChannels : channelCounts)
+        {
+            auto benchmarkCase = base;
+            benchmarkCase.numChannels = numChannels;
+            add(benchmarkCase);
+        }
+
+        // Routing only matters with channels to route
+        for (const int numChannels : routingChannelCounts)
+            for (const auto routing : routings)
+            {
+                auto benchmarkCase = base;
+                benchmarkCase.numChannels = numChannels;
+                benchmarkCase.routing = routing;
+                add(benchmarkCase);
+            }
+
+        for (const int parameterChanges : parameterChangeRates)
+        {
+            auto benchmarkCase = base;
+            benchmarkCase.parameterChangesPerBlock = parameterChanges;
+            add(benchmarkCase);
+        }
+
+        for (const int midiEvents : midiEventRates)
+        {
+            auto benchmarkCase = base;
+            benchmarkCase.midiEventsPerBlock = midiEvents;
+            add(benchmarkCase);
+        }
+    }
+
+    return cases;
+}
+
+juce::var makeEnvironment(const ProcessBenchmark::Options& options)
+{
+    auto* environment = new juce::DynamicObject();
+    environment->setProperty("version", JUCESONIC_VERSION_STRING);
+    environment->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    environment->setProperty("cpu", juce::SystemStats::getCpuModel());
+    environment->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    environment->setProperty("os", juce::SystemStats::getOperatingSystemName());
+#if JUCE_DEBUG
+    environment->setProperty("build", "Debug");
+#else
+    environment->setProperty("build", "Release");
+#endif
+    environment->setProperty("sampleRate", options.sampleRate);
+    environment->setProperty("secondsPerCase", options.secondsPerCase);
+
+    return juce::var(environment);
+}
+
+void bench(const juce::ArgumentList& args)
+{
+    ProcessBenchmark::Options options;
+    if (args.containsOption("--seconds"))
+        options.secondsPerCase = juce::jmax(0.0, args.getValueForOption("--seconds").getDoubleValue());
+
+    juce::TemporaryFile nullEffectFile(".jsfx");
+    if (!nullEffectFile.getFile().replaceWithText(nullEffect))
+        juce::ConsoleApplication::fail("Could not write " + nullEffectFile.getFile().getFullPathName());
+
+    std::vector<Effect> effects{
+        {"null", nullEffectFile.getFile()},
+    };
+
+    const juce::File bundledEffects(JUCESONIC_BUNDLED_EFFECTS_DIR);
+    for (const auto* name : {"volume"})
+    {
+        const auto file = bundledEffects.getChildFile(name);
+        if (file.existsAsFile())
+            effects.push_back({name, file});
+        else
+            std::cerr << "Skipping " << file.getFullPathName() << ": not found" << std::endl;
+    }
+
+    if (args.containsOption("--effect"))
+    {
+        for (const auto& path : juce::StringArray::fromTokens(args.getValueForOption("--effect"), ",", ""))
+        {
+            const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(path.trim());
+            if (!file.existsAsFile())
+                juce::ConsoleApplication::fail("JSFX not found: " + file.getFullPathName());
+
+            effects.push_back({file.getFileName(), file});
+        }
+    }
+
+    const auto cases = makeCases(effects, args.containsOption("--full"), args.containsOption("--double"));
+
+    juce::Array<juce::var> results;
+    int numFailed = 0;
+
+    for (size_t index = 0; index < cases.size(); ++index)
+    {
+        const auto& benchmarkCase = cases[index];
+        std::cerr << "[" << (index + 1) << "/" << cases.size() << "] "
+                  << benchmarkCase.effectName
+                  << ", " << benchmarkCase.blockSize << " samples"
+                  << ", " << benchmarkCase.numChannels << " ch"
+                  << ", " << ProcessBenchmark::getRoutingName(benchmarkCase.routing)
+                  << ", " << benchmarkCase.parameterChangesPerBlock << " param changes"
+                  << ", " << benchmarkCase.midiEventsPerBlock << " MIDI events: ";
+
+        ProcessBenchmark::Measurement measurement;
+        if (auto result = ProcessBenchmark::run(benchmarkCase, options, measurement); result.failed())
+        {
+            // Recorded rather than fatal: a layout one build doesn't support shouldn't lose the rest
+            std::cerr << "FAILED: " << result.getErrorMessage() << std::endl;
+
+            auto failed = ProcessBenchmark::toJson(benchmarkCase, {});
+            failed.getDynamicObject()->setProperty("error", result.getErrorMessage());
+            results.add(failed);
+            ++numFailed;
+            continue;
+        }
+
+        std::cerr << juce::String(measurement.nsPerSample, 2)
+                  << " ns/sample (wrapper "
+                  << juce::String(measurement.getWrapperNsPerSample(), 2)
+                  << ")" << std::endl;
+
+        results.add(ProcessBenchmark::toJson(benchmarkCase, measurement));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("environment", makeEnvironment(options));
+    root->setProperty("results", results);
+    const auto json = juce::JSON::toString(juce::var(root));
+
+    if (args.containsOption("--output"))
+    {
+        const auto output = args.getFileForOption("--output");
+        if (!output.replaceWithText(json))
+            juce::ConsoleApplication::fail("Could not write " + output.getFullPathName());
+
+        std::cerr << "Wrote " << output.getFullPathName() << std::endl;
+    }
+    else
+    {
+        std::cout << json << std::endl;
+    }
+
+    if (numFailed > 0)
+        juce::ConsoleApplication::fail(juce::String(numFailed) + " cases failed");
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // Initialises JUCE; this thread plays host, message thread and audio thread in turn
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", usage, false);
+    app.addDefaultCommand({"", "", "Time processBlock over a sweep of cases", usage, bench});
+
+    return app.findAndRunCommand(argc, argv);
+}
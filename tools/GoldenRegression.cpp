@@ -0,0 +1,400 @@
+#include "GoldenRegression.h"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace
+{
+constexpr int numAutomatedParameters = 4;
+constexpr int numMultichannelChannels = 6;
+
+// Three seconds exercising the level, frequency and silence paths
+void makeInput(juce::AudioBuffer<float>& input, int numChannels)
+{
+    const auto rate = GoldenRegression::sampleRate;
+    const int sectionLength = static_cast<int>(rate / 2);
+    input.setSize(numChannels, sectionLength * 6);
+    input.clear();
+
+    juce::Random random(23);
+    std::vector<double> phase(static_cast<size_t>(numChannels));
+
+    for (int sample = 0; sample < input.getNumSamples(); ++sample)
+    {
+        const int section = sample / sectionLength;
+        const double position = static_cast<double>(sample % sectionLength) / sectionLength;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float value = 0.0f;
+
+            if (section < 2)
+            {
+                // Exponential sweep over a second, the right channel a fifth above the left and
+                // further channels each a smaller interval, so a swapped channel shows
+                const double t = (section + position) / 2.0;
+                const double ratio = channel == 0 ? 1.0 : 1.0 + 0.5 / channel;
+                const double frequency = 20.0 * std::pow(1000.0, t) * ratio;
+                auto& channelPhase = phase[static_cast<size_t>(channel)];
+                channelPhase += juce::MathConstants<double>::twoPi * frequency / rate;
+                value = 0.5f * static_cast<float>(std::sin(channelPhase));
+            }
+            else if (section < 4)
+            {
+                // Noise in 100 ms bursts
+                const bool on = (sample / static_cast<int>(rate / 10)) % 2 == 0;
+                value = on ? 0.25f * (random.nextFloat() * 2.0f - 1.0f) : 0.0f;
+            }
+            else if (section == 4)
+            {
+                // An impulse, then silence for tails and denormals
+                value = sample % sectionLength == 0 ? 1.0f : 0.0f;
+            }
+            else
+            {
+                // Clipped sine beyond full scale
+                const double sine = 1.5 * std::sin(juce::MathConstants<double>::twoPi * 110.0 * sample / rate);
+                value = static_cast<float>(juce::jlimit(-1.2, 1.2, sine));
+            }
+
+            input.setSample(channel, sample, value);
+        }
+    }
+}
+
+// Input channel n feeds JSFX pin n + 1 (the last wraps to 0) and channel 0 also feeds pin 0, so
+// both a permutation and a sum; outputs stay diagonal. Encoded as Settings::routing, for the pin
+// counts prepareToPlay() sets up: one per channel, no sidechain.
+juce::String makeCrossedRouting(int numChannels)
+{
+    juce::String input;
+    juce::String output;
+    for (int source = 0; source < numChannels; ++source)
+    {
+        for (int destination = 0; destination < numChannels; ++destination)
+        {
+            const bool routed = destination == (source + 1) % numChannels || (source == 0 && destination == 0);
+            input << (routed ? "1" : "0");
+            output << (source == destination ? "1" : "0");
+        }
+    }
+
+    return input + ",," + output;
+}
+
+juce::Result render(
+    const GoldenRegression::Case& regressionCase,
+    const juce::AudioBuffer<float>& input,
+    juce::AudioBuffer<float>& output,
+    double& processSeconds
+)
+{
+    OfflineRenderer::Settings settings;
+    settings.jsfxFile = regressionCase.jsfxFile;
+    settings.blockSizes = regressionCase.blockSizes;
+    settings.doublePrecision = regressionCase.doublePrecision;
+    settings.routing = regressionCase.routing;
+
+    OfflineRenderer renderer(settings);
+    if (auto result = renderer.prepare(input.getNumChannels(), GoldenRegression::sampleRate); result.failed())
+        return result;
+
+    juce::Array<juce::RangedAudioParameter*> parameters;
+    if (regressionCase.automateParameters)
+    {
+        const int numParameters = juce::jmin(numAutomatedParameters, renderer.getProcessor().getNumActiveParameters());
+        for (int index = 0; index < numParameters; ++index)
+            parameters.add(renderer.getProcessor().getAPVTS().getParameter("param" + juce::String(index)));
+    }
+
+    output.makeCopyOf(input);
+
+    const int numSamples = output.getNumSamples();
+    juce::int64 processTicks = 0;
+    int blockIndex = 0;
+
+    for (int position = 0; position < numSamples; ++blockIndex)
+    {
+        const int blockSize = juce::jmin(renderer.getNextBlockSize(), numSamples - position);
+
+        // Each parameter moves along its own slow sine, a step per block
+        for (int index = 0; index < parameters.size(); ++index)
+            if (auto* parameter = parameters[index])
+                parameter->setValueNotifyingHost(
+                    0.5f + 0.5f * std::sin(0.05f * static_cast<float>(blockIndex) + static_cast<float>(index))
+                );
+
+        juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), output.getNumChannels(), position, blockSize);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        renderer.processBlock(block);
+        processTicks += juce::Time::getHighResolutionTicks() - start;
+
+        position += blockSize;
+    }
+
+    processSeconds = juce::Time::highResolutionTicksToSeconds(processTicks);
+    return juce::Result::ok();
+}
+
+// Largest difference between two renders, and where it is
+float compare(
+    const juce::AudioBuffer<float>& actual,
+    const juce::AudioBuffer<float>& expected,
+    juce::int64& worstSample,
+    int& worstChannel
+)
+{
+    float maxDifference = 0.0f;
+    for (int channel = 0; channel < actual.getNumChannels(); ++channel)
+    {
+        const auto* a = actual.getReadPointer(channel);
+        const auto* b = expected.getReadPointer(channel);
+
+        for (int sample = 0; sample < actual.getNumSamples(); ++sample)
+        {
+            // NaN compares false, so count it (and infinities) as the largest difference there is
+            float difference = std::abs(a[sample] - b[sample]);
+            if (!std::isfinite(difference))
+                difference = std::numeric_limits<float>::max();
+
+            if (difference > maxDifference)
+            {
+                maxDifference = difference;
+                worstSample = sample;
+                worstChannel = channel;
+            }
+        }
+    }
+
+    return maxDifference;
+}
+
+juce::Result readGolden(const juce::File& file, juce::AudioBuffer<float>& golden)
+{
+    if (!file.existsAsFile())
+        return juce::Result::fail("No golden at " + file.getFullPathName() + " (run with --update to record one)");
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatReader> reader(wav.createReaderFor(file.createInputStream().release(), true));
+    if (!reader)
+        return juce::Result::fail("Could not read " + file.getFullPathName());
+
+    golden.setSize(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+    reader->read(&golden, 0, golden.getNumSamples(), 0, true, true);
+    return juce::Result::ok();
+}
+
+juce::Result writeGolden(const juce::File& file, const juce::AudioBuffer<float>& output)
+{
+    if (!file.getParentDirectory().createDirectory())
+        return juce::Result::fail("Could not create " + file.getParentDirectory().getFullPathName());
+
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    if (!stream->openedOk())
+        return juce::Result::fail("Could not write " + file.getFullPathName());
+
+    // 32 bits is IEEE float in WAV, so the golden holds exactly what was rendered
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(
+        stream.get(),
+        GoldenRegression::sampleRate,
+        static_cast<unsigned int>(output.getNumChannels()),
+        32,
+        {},
+        0
+    ));
+
+    if (!writer)
+        return juce::Result::fail("Could not create a WAV writer");
+
+    stream.release(); // Owned by the writer
+
+    if (!writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples()))
+        return juce::Result::fail("Write error on " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
+} // namespace
+
+//==============================================================================
+std::vector<GoldenRegression::Case> GoldenRegression::makeCases(const juce::Array<juce::File>& effects)
+{
+    std::vector<Case> cases;
+    for (const auto& effect : effects)
+    {
+        Case base;
+        base.effectName = effect.getFileNameWithoutExtension();
+        base.jsfxFile = effect;
+        base.blockSizes = {512};
+
+        auto fixed = base;
+        fixed.name = "float-512";
+        cases.push_back(fixed);
+
+        // Odd sizes, a single sample, and blocks longer than the smoothing sub-blocks
+        auto varying = base;
+        varying.name = "float-varying";
+        varying.blockSizes = {37, 1, 256, 1000, 64};
+        cases.push_back(varying);
+
+        auto doublePrecision = base;
+        doublePrecision.name = "double-512";
+        doublePrecision.doublePrecision = true;
+        cases.push_back(doublePrecision);
+
+        auto automated = base;
+        automated.name = "automation-varying";
+        automated.blockSizes = varying.blockSizes;
+        automated.automateParameters = true;
+        cases.push_back(automated);
+
+        auto routed = base;
+        routed.name = "routed-512";
+        routed.routing = makeCrossedRouting(routed.numChannels);
+        cases.push_back(routed);
+
+        // More pins than the stereo cases, crossed, in odd block sizes
+        auto multichannel = base;
+        multichannel.name = "multichannel-routed-varying";
+        multichannel.numChannels = numMultichannelChannels;
+        multichannel.blockSizes = varying.blockSizes;
+        multichannel.routing = makeCrossedRouting(multichannel.numChannels);
+        cases.push_back(multichannel);
+    }
+
+    return cases;
+}
+
+//==============================================================================
+std::vector<GoldenRegression::Outcome> GoldenRegression::run(
+    const std::vector<Case>& cases,
+    const Options& options,
+    std::ostream& log
+)
+{
+    // Rebuilt when a case's channel count differs from the last one's
+    juce::AudioBuffer<float> input;
+
+    juce::var timings;
+    if (options.timingsFile.existsAsFile())
+        timings = juce::JSON::parse(options.timingsFile);
+    if (!timings.isObject())
+        timings = juce::var(new juce::DynamicObject());
+
+    std::vector<Outcome> outcomes;
+    juce::AudioBuffer<float> output;
+    juce::AudioBuffer<float> repeat;
+    juce::AudioBuffer<float> golden;
+
+    for (const auto& regressionCase : cases)
+    {
+        Outcome outcome;
+        const auto id = regressionCase.getId();
+        const auto goldenFile = options.goldenDirectory.getChildFile(id + ".wav");
+
+        if (input.getNumChannels() != regressionCase.numChannels)
+            makeInput(input, regressionCase.numChannels);
+
+        outcome.result = render(regressionCase, input, output, outcome.processSeconds);
+
+        // The same input must always give the same output, or no golden can hold
+        for (int index = 1; index < options.numRenders && outcome.result.wasOk(); ++index)
+        {
+            double seconds = 0.0;
+            outcome.result = render(regressionCase, input, repeat, seconds);
+            outcome.processSeconds = juce::jmin(outcome.processSeconds, seconds);
+
+            juce::int64 sample = 0;
+            int channel = 0;
+            if (outcome.result.wasOk() && compare(repeat, output, sample, channel) > 0.0f)
+                outcome.result = juce::Result::fail(
+                    "Renders differ from each other at sample " + juce::String(sample) + ", channel "
+                    + juce::String(channel)
+                );
+        }
+
+        if (outcome.result.wasOk() && options.update)
+        {
+            outcome.result = writeGolden(goldenFile, output);
+            timings.getDynamicObject()->setProperty(id, outcome.processSeconds);
+            outcome.updated = outcome.result.wasOk();
+        }
+        else if (outcome.result.wasOk())
+        {
+            outcome.result = readGolden(goldenFile, golden);
+
+            if (outcome.result.wasOk()
+                && (golden.getNumChannels() != output.getNumChannels()
+                    || golden.getNumSamples() != output.getNumSamples()))
+                outcome.result = juce::Result::fail(
+                    "Output is " + juce::String(output.getNumChannels()) + " x "
+                    + juce::String(output.getNumSamples()) + ", the golden "
+                    + juce::String(golden.getNumChannels()) + " x " + juce::String(golden.getNumSamples())
+                );
+
+            if (outcome.result.wasOk())
+            {
+                outcome.maxDifference = compare(output, golden, outcome.worstSample, outcome.worstChannel);
+                if (outcome.maxDifference > options.tolerance)
+                    outcome.result = juce::Result::fail(
+                        "Output drifted by " + juce::String(outcome.maxDifference) + " at sample "
+                        + juce::String(outcome.worstSample) + ", channel " + juce::String(outcome.worstChannel)
+                    );
+            }
+
+            outcome.baselineSeconds = static_cast<double>(timings.getProperty(id, 0.0));
+            const auto limit = outcome.baselineSeconds * (1.0 + options.maxSlowdown);
+            if (outcome.result.wasOk() && outcome.baselineSeconds > 0.0 && outcome.processSeconds > limit)
+                outcome.result = juce::Result::fail(
+                    "Throughput dropped: " + juce::String(outcome.processSeconds * 1000.0, 2) + " ms against "
+                    + juce::String(outcome.baselineSeconds * 1000.0, 2) + " ms"
+                );
+        }
+
+        log << id << ": " << (outcome.result.wasOk() ? (outcome.updated ? "recorded" : "ok") : "FAILED");
+        if (outcome.result.failed())
+            log << " (" << outcome.result.getErrorMessage() << ")";
+
+        log << ", " << juce::String(outcome.processSeconds * 1000.0, 2) << " ms";
+        if (outcome.baselineSeconds > 0.0)
+            log << " (baseline " << juce::String(outcome.baselineSeconds * 1000.0, 2) << " ms)";
+
+        log << std::endl;
+        outcomes.push_back(outcome);
+    }
+
+    if (options.update && options.timingsFile != juce::File{})
+        if (!options.timingsFile.replaceWithText(juce::JSON::toString(timings)))
+            log << "Could not write " << options.timingsFile.getFullPathName() << std::endl;
+
+    return outcomes;
+}
+
+juce::var GoldenRegression::toJson(const std::vector<Case>& cases, const std::vector<Outcome>& outcomes)
+{
+    juce::Array<juce::var> results;
+    for (size_t index = 0; index < cases.size() && index < outcomes.size(); ++index)
+    {
+        const auto& outcome = outcomes[index];
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("case", cases[index].getId());
+        result->setProperty("passed", outcome.result.wasOk());
+        if (outcome.result.failed())
+            result->setProperty("error", outcome.result.getErrorMessage());
+
+        result->setProperty("maxDifference", outcome.maxDifference);
+        result->setProperty("processSeconds", outcome.processSeconds);
+        if (outcome.baselineSeconds > 0.0)
+            result->setProperty("baselineSeconds", outcome.baselineSeconds);
+
+        results.add(juce::var(result));
+    }
+
+    return results;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "OfflineRenderer.h"
+
+#include <iosfwd>
+#include <vector>
+
+/**
+ * Renders a corpus of JSFX through the processor and compares the results with
+ * stored golden files, for juceSonic_Regress. Guards the routing, sample
+ * conversion and parameter paths against changes in output or throughput.
+ *
+ * Every effect runs the same synthetic input (a sine sweep, noise bursts, an
+ * impulse into silence and clipped full scale) in a few cases: fixed and
+ * varying block sizes, double precision, automated parameters, and a crossed
+ * routing in stereo and with more channels. Goldens are 32-bit float WAVs,
+ * one per case, under goldenDirectory/<effect>/. A case fails when any sample
+ * differs from its golden by more than the tolerance.
+ *
+ * Each case is rendered several times. The renders must agree with each other,
+ * and the fastest one's processing time is compared with the baseline in the
+ * timings file, which is kept apart from the goldens because it only holds for
+ * the machine that recorded it. With update set, the goldens and timings are
+ * rewritten instead of checked.
+ */
+class GoldenRegression
+{
+public:
+    struct Case
+    {
+        juce::String effectName;
+        juce::File jsfxFile;
+        juce::String name;
+        juce::Array<int> blockSizes;
+        bool doublePrecision = false;
+        bool automateParameters = false; // Sweep the first parameters, a step per block
+        int numChannels = 2;             // Of the input, the output and the JSFX
+        juce::String routing;            // Settings::routing; empty for the diagonal
+
+        /** effect/case, as used for the golden's path and in the timings. */
+        juce::String getId() const
+        {
+            return effectName + "/" + name;
+        }
+    };
+
+    struct Options
+    {
+        juce::File goldenDirectory;
+        juce::File timingsFile;        // Optional
+        bool update = false;
+        float tolerance = 1.0e-5f;     // Largest allowed difference per sample, about -100 dBFS
+        double maxSlowdown = 0.25;     // Fraction over the baseline time that fails a case
+        int numRenders = 3;            // Per case; the fastest is timed
+    };
+
+    struct Outcome
+    {
+        juce::Result result = juce::Result::ok();
+        float maxDifference = 0.0f; // From the golden
+        juce::int64 worstSample = 0;
+        int worstChannel = 0;
+        double processSeconds = 0.0;  // Fastest render
+        double baselineSeconds = 0.0; // 0 without a baseline
+        bool updated = false;
+    };
+
+    static constexpr double sampleRate = 48000.0;
+
+    /** The cases for each JSFX file, in order. */
+    static std::vector<Case> makeCases(const juce::Array<juce::File>& effects);
+
+    /** Run all cases, a line each to log. Returns one outcome per case. */
+    static std::vector<Outcome> run(const std::vector<Case>& cases, const Options& options, std::ostream& log);
+
+    /** Cases and outcomes as a JSON report. */
+    static juce::var toJson(const std::vector<Case>& cases, const std::vector<Outcome>& outcomes);
+};
@@ -0,0 +1,384 @@
+#include "OfflineRenderer.h"
+
+#include "ReaperPresetConverter.h"
+
+#include <cstring>
+
+namespace
+{
+// Processors are built and torn down on whichever thread renders. JSFX instances are
+// already serialised by JsfxWorkerPool, but the rest of the setup (parameters, value
+// trees, timers) expects the message thread, which isn't running a loop to lock here
+juce::CriticalSection& getProcessorLifetimeLock()
+{
+    static juce::CriticalSection lock;
+    return lock;
+}
+
+RoutingConfig::Matrix makeDiagonalMatrix()
+{
+    RoutingConfig::Matrix diagonal{};
+    for (int channel = 0; channel < PluginConstants::MaxChannels; ++channel)
+        diagonal[channel][channel] = true;
+
+    return diagonal;
+}
+} // namespace
+
+OfflineRenderer::OfflineRenderer(const Settings& settingsToUse)
+    : settings(settingsToUse)
+{
+    formatManager.registerBasicFormats();
+
+    if (settings.blockSizes.isEmpty())
+        settings.blockSizes.add(512);
+
+    for (const int blockSize : settings.blockSizes)
+        maxBlockSize = juce::jmax(maxBlockSize, blockSize);
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    const juce::ScopedLock lock(getProcessorLifetimeLock());
+
+    if (processor)
+        processor->releaseResources();
+
+    processor.reset();
+}
+
+//==============================================================================
+juce::Result OfflineRenderer::prepare(int numChannels, double sampleRate)
+{
+    const bool hasJsfx = settings.jsfxFile != juce::File{};
+    if (hasJsfx && !settings.jsfxFile.existsAsFile())
+        return juce::Result::fail("JSFX not found: " + settings.jsfxFile.getFullPathName());
+
+    for (const auto& stageFile : settings.chainFiles)
+        if (!stageFile.existsAsFile())
+            return juce::Result::fail("Chain stage not found: " + stageFile.getFullPathName());
+
+    for (const auto& branchFile : settings.branchFiles)
+        if (!branchFile.existsAsFile())
+            return juce::Result::fail("Branch not found: " + branchFile.getFullPathName());
+
+    if (numChannels < 1 || numChannels > PluginConstants::MaxChannels)
+        return juce::Result::fail("Unsupported channel count: " + juce::String(numChannels));
+
+    for (const int blockSize : settings.blockSizes)
+        if (blockSize < 1)
+            return juce::Result::fail("Block sizes must be positive");
+
+    if (settings.oversamplingFactor != 1 && !JsfxOversampler::isValidFactor(settings.oversamplingFactor))
+        return juce::Result::fail("Oversampling must be 1, 2, 4 or 8: " + juce::String(settings.oversamplingFactor));
+
+    // Decode the preset before doing any work, so a typo fails fast
+    juce::String presetName;
+    juce::String presetData;
+    if (settings.presetFile != juce::File{})
+    {
+        if (auto result = findPreset(settings, presetName, presetData); result.failed())
+            return result;
+    }
+
+    const juce::ScopedLock lock(getProcessorLifetimeLock());
+
+    if (processor)
+        processor->releaseResources();
+
+    processor = std::make_unique<AudioPluginAudioProcessor>();
+
+    // Main input and output follow the file; no sidechain
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    auto layout = processor->getBusesLayout();
+    layout.inputBuses.getReference(0) = channelSet;
+    layout.outputBuses.getReference(0) = channelSet;
+    for (int bus = 1; bus < layout.inputBuses.size(); ++bus)
+        layout.inputBuses.getReference(bus) = juce::AudioChannelSet::disabled();
+
+    if (!processor->setBusesLayout(layout))
+        return juce::Result::fail("The processor doesn't support " + juce::String(numChannels) + " channels");
+
+    processor->setProcessingPrecision(
+        settings.doublePrecision ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision
+    );
+    processor->setNonRealtime(true);
+    processor->setBlockAccumulatorSize(settings.accumulatorBlockSize);
+    processor->setOversampling(settings.oversamplingFactor, settings.oversamplingLinearPhase);
+    processor->setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+    processor->prepareToPlay(sampleRate, maxBlockSize);
+
+    if (settings.doublePrecision)
+        doubleBuffer.setSize(numChannels, maxBlockSize);
+
+    if (hasJsfx && !processor->loadJSFX(settings.jsfxFile))
+        return juce::Result::fail("Could not compile " + settings.jsfxFile.getFullPathName());
+
+    // Branches as the editor adds them: each fed by the graph input and summed into its output
+    const auto diagonal = makeDiagonalMatrix();
+    for (const auto& branchFile : settings.branchFiles)
+    {
+        const int node = processor->addGraphNode(branchFile);
+        if (node < 0)
+            return juce::Result::fail("Could not add branch " + branchFile.getFullPathName());
+
+        processor->connectGraphNodes(JsfxGraph::graphIO, node, diagonal);
+        processor->connectGraphNodes(node, JsfxGraph::graphIO, diagonal);
+    }
+
+    if (settings.branchesIncludeDry && !settings.branchFiles.isEmpty())
+        processor->connectGraphNodes(JsfxGraph::graphIO, JsfxGraph::graphIO, diagonal);
+
+    for (const auto& stageFile : settings.chainFiles)
+        if (!processor->addChainStage(stageFile))
+            return juce::Result::fail("Could not add chain stage " + stageFile.getFullPathName());
+
+    if (settings.pipelineChain)
+        processor->setChainPipelined(true);
+
+    // Built right away: an offline processor doesn't wait for the message loop
+    if (settings.splitMode != SplitMode::Off)
+        processor->setSplitMode(settings.splitMode, settings.splitGroups);
+
+    if (settings.routing.isNotEmpty())
+    {
+        if (juce::StringArray::fromTokens(settings.routing, ",", "").size() != 3)
+            return juce::Result::fail("Routing must be three comma-separated bit rows: input,sidechain,output");
+
+        processor->restoreRoutingFromString(settings.routing);
+    }
+
+    // Queued for the first block, like a preset picked in the editor while audio runs
+    if (presetData.isNotEmpty() && !processor->loadPresetFromBase64(presetData, presetName))
+        return juce::Result::fail("Could not load preset " + presetName);
+
+    // One block of silence applies the preset and settles the latency, which renderFile() compensates;
+    // a host's first blocks do the same. Nothing runs the processor's timer, so collect here.
+    juce::AudioBuffer<float> warmUp(numChannels, maxBlockSize);
+    warmUp.clear();
+    processBlock(warmUp);
+    processor->collectAudioThreadResults();
+
+    nextBlockSizeIndex = 0;
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::parseSplit(const juce::String& text, Settings& settings)
+{
+    const auto mode = text.trim().toLowerCase();
+    settings.splitGroups = {};
+
+    if (mode.isEmpty() || mode == "off")
+        settings.splitMode = SplitMode::Off;
+    else if (mode == "mono")
+        settings.splitMode = SplitMode::Mono;
+    else if (mode == "stereo")
+        settings.splitMode = SplitMode::Stereo;
+    else if (mode.containsOnly("0123456789, "))
+    {
+        settings.splitMode = SplitMode::Custom;
+        settings.splitGroups = mode;
+    }
+    else
+        return juce::Result::fail("Split must be off, mono, stereo or channel counts per copy: " + text);
+
+    return juce::Result::ok();
+}
+
+void OfflineRenderer::processBlock(juce::AudioBuffer<float>& buffer)
+{
+    midi.clear();
+    processBlock(buffer, midi);
+}
+
+void OfflineRenderer::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    if (!settings.doublePrecision)
+    {
+        processor->processBlock(buffer, midiMessages);
+        return;
+    }
+
+    // Sized in prepare(), so the copies don't allocate
+    doubleBuffer.makeCopyOf(buffer, true);
+    processor->processBlock(doubleBuffer, midiMessages);
+    buffer.makeCopyOf(doubleBuffer, true);
+}
+
+int OfflineRenderer::getNextBlockSize() noexcept
+{
+    const int blockSize = settings.blockSizes[nextBlockSizeIndex];
+    nextBlockSizeIndex = (nextBlockSizeIndex + 1) % settings.blockSizes.size();
+    return blockSize;
+}
+
+//==============================================================================
+juce::Result OfflineRenderer::renderFile(const juce::File& input, const juce::File& output, Statistics& statistics)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+    if (!reader)
+        return juce::Result::fail("Could not read " + input.getFullPathName());
+
+    auto* format = formatManager.findFormatForFileExtension(output.getFileExtension());
+    if (!format)
+        return juce::Result::fail("No audio format for " + output.getFileName());
+
+    const int numChannels = static_cast<int>(reader->numChannels);
+    if (auto result = prepare(numChannels, reader->sampleRate); result.failed())
+        return result;
+
+    // The input's bit depth if the output format has it, else the deepest it offers
+    auto bitDepths = format->getPossibleBitDepths();
+    int bitsPerSample = settings.bitsPerSample > 0 ? settings.bitsPerSample : static_cast<int>(reader->bitsPerSample);
+    if (!bitDepths.contains(bitsPerSample))
+    {
+        if (settings.bitsPerSample > 0)
+        {
+            const auto message = format->getFormatName() + " can't write " + juce::String(bitsPerSample) + " bits";
+            return juce::Result::fail(message);
+        }
+
+        bitsPerSample = bitDepths.isEmpty() ? 16 : bitDepths[bitDepths.size() - 1];
+    }
+
+    output.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(output);
+    if (!stream->openedOk())
+        return juce::Result::fail("Could not write " + output.getFullPathName());
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(
+        stream.get(),
+        reader->sampleRate,
+        static_cast<unsigned int>(numChannels),
+        bitsPerSample,
+        {},
+        0
+    ));
+
+    if (!writer)
+        return juce::Result::fail("Could not create a " + format->getFormatName() + " writer");
+
+    stream.release(); // Owned by the writer
+
+    const int latency = settings.compensateLatency ? processor->getLatencySamples() : 0;
+    const auto inputLength = reader->lengthInSamples;
+    const auto outputLength = inputLength + static_cast<juce::int64>(settings.tailSeconds * reader->sampleRate);
+
+    statistics = {};
+    statistics.sampleRate = reader->sampleRate;
+    statistics.latencySamples = latency;
+
+    // Files are read and written a chunk at a time and the blocks processed in place
+    // inside it; a block that doesn't fit in what's left moves to the next chunk
+    const int chunkSize = juce::jmax(maxBlockSize, chunkSamples);
+    juce::AudioBuffer<float> chunk(numChannels, chunkSize);
+    juce::int64 readPosition = 0;
+    juce::int64 samplesToSkip = latency;
+    juce::int64 processTicks = 0;
+
+    // Input past its end (latency and tail) is silence
+    auto readInput = [&](int startSample, int numSamples)
+    {
+        chunk.clear(startSample, numSamples);
+        if (readPosition < inputLength)
+        {
+            const int numToRead = static_cast<int>(juce::jmin<juce::int64>(numSamples, inputLength - readPosition));
+            reader->read(&chunk, startSample, numToRead, readPosition, true, true);
+        }
+
+        readPosition += numSamples;
+    };
+
+    auto writeOutput = [&](int numSamples)
+    {
+        const int skipped = static_cast<int>(juce::jmin<juce::int64>(samplesToSkip, numSamples));
+        samplesToSkip -= skipped;
+
+        const auto numToWrite = juce::jmin<juce::int64>(numSamples - skipped, outputLength - statistics.numSamples);
+        if (numToWrite > 0 && !writer->writeFromAudioSampleBuffer(chunk, skipped, static_cast<int>(numToWrite)))
+            return false;
+
+        statistics.numSamples += numToWrite;
+        if (onProgress && outputLength > 0)
+            onProgress(static_cast<double>(statistics.numSamples) / static_cast<double>(outputLength));
+
+        return true;
+    };
+
+    readInput(0, chunkSize);
+
+    const auto samplesToProcess = latency + outputLength;
+    juce::int64 samplesProcessed = 0;
+    int chunkPosition = 0;
+
+    while (samplesProcessed < samplesToProcess)
+    {
+        const int blockSize = getNextBlockSize();
+
+        if (chunkPosition + blockSize > chunkSize)
+        {
+            if (!writeOutput(chunkPosition))
+                return juce::Result::fail("Write error on " + output.getFullPathName());
+
+            // Presets from MIDI program changes are freed here, as the timer would
+            processor->collectAudioThreadResults();
+
+            // Keep the read-ahead that wasn't processed yet and refill behind it
+            const int numLeft = chunkSize - chunkPosition;
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* data = chunk.getWritePointer(channel);
+                std::memmove(data, data + chunkPosition, static_cast<size_t>(numLeft) * sizeof(float));
+            }
+
+            readInput(numLeft, chunkPosition);
+            chunkPosition = 0;
+        }
+
+        // Refers to the chunk's channels; no allocation up to 32 of them
+        juce::AudioBuffer<float> block(chunk.getArrayOfWritePointers(), numChannels, chunkPosition, blockSize);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processBlock(block);
+        processTicks += juce::Time::getHighResolutionTicks() - start;
+
+        chunkPosition += blockSize;
+        samplesProcessed += blockSize;
+    }
+
+    if (!writeOutput(chunkPosition))
+        return juce::Result::fail("Write error on " + output.getFullPathName());
+
+    statistics.processSeconds = juce::Time::highResolutionTicksToSeconds(processTicks);
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::findPreset(const Settings& settings, juce::String& presetName, juce::String& presetData)
+{
+    if (!settings.presetFile.existsAsFile())
+        return juce::Result::fail("Preset file not found: " + settings.presetFile.getFullPathName());
+
+    if (settings.presetName.isNotEmpty())
+    {
+        presetName = settings.presetName;
+        presetData = ReaperPresetConverter::findPresetByName(settings.presetFile, presetName);
+    }
+    else
+    {
+        // PresetFile > PresetBank > Preset
+        ReaperPresetConverter converter;
+        const auto preset = converter.convertFileToTree(settings.presetFile).getChild(0).getChild(0);
+        presetName = preset.getProperty("name").toString();
+        presetData = preset.getProperty("data").toString();
+    }
+
+    if (presetData.isEmpty())
+        return juce::Result::fail(
+            "No preset "
+            + (presetName.isNotEmpty() ? presetName.quoted() : juce::String())
+            + " in "
+            + settings.presetFile.getFileName()
+        );
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "PluginProcessor.h"
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <functional>
+#include <memory>
+
+/**
+ * Runs AudioPluginAudioProcessor without a host or an audio device, as fast as
+ * the machine allows. Shared by the command-line tools.
+ *
+ * prepare() sets the bus layout for the channel count, prepares the processor
+ * for offline use, and loads the JSFX, branches, chain, routing and preset. Everything runs on
+ * the calling thread. JUCE must be initialised (a ScopedJuceInitialiser_GUI in
+ * main), but the message loop needn't run: the processor's timer never fires,
+ * so the renderer collects what the timer would (latency, finished presets)
+ * itself. prepare() ends with one silent block, so the preset is applied and
+ * the latency known before rendering.
+ *
+ * Several renderers may run at once on different threads, each with its own
+ * processor and JSFX instance. Creating and destroying processors is serialised
+ * across all of them; processing isn't.
+ *
+ * processBlock() runs one block. renderFile() streams a whole file through in
+ * the configured block sizes, reading and writing chunkSamples at a time.
+ */
+class OfflineRenderer
+{
+public:
+    struct Settings
+    {
+        juce::File jsfxFile;              // None: only branches and chain, or silence without them
+        juce::File presetFile;            // .rpl, optional
+        juce::String presetName;          // Empty: the first preset in presetFile
+        juce::String routing;             // I/O matrix as saved in the plugin state, optional
+        juce::Array<int> blockSizes{512}; // Cycled through, to mimic hosts with varying block sizes
+        bool doublePrecision = false;
+        bool compensateLatency = true;        // Drop the reported latency from the start of the output
+        double tailSeconds = 0.0;             // Extra output after the input ends
+        int bitsPerSample = 0;                // Output bit depth, 0 for the input's
+        int accumulatorBlockSize = 0;         // Fixed JSFX block size, as the editor's re-blocking; 0 for off
+        int oversamplingFactor = 1;           // 1, 2, 4 or 8 times the file's rate for the main JSFX
+        bool oversamplingLinearPhase = false; // FIR rather than IIR oversampling filters
+        SplitMode splitMode = SplitMode::Off; // Linked copies of the JSFX, each on a slice of the channels
+        juce::String splitGroups;             // Channel counts per copy for SplitMode::Custom
+        juce::Array<juce::File> chainFiles;   // JSFX run after the main one, in order
+        bool pipelineChain = false;           // Chain stages on their own cores, a block behind each other
+        juce::Array<juce::File> branchFiles;  // JSFX run in parallel after the main one, outputs summed
+        bool branchesIncludeDry = false;      // Add the branches' input to their sum
+    };
+
+    struct Statistics
+    {
+        juce::int64 numSamples = 0; // Written to the output
+        double sampleRate = 0.0;
+        int latencySamples = 0;
+        double processSeconds = 0.0; // Inside processBlock only
+
+        /** Audio duration over time spent processing; above 1 is faster than real time. */
+        double getRealtimeFactor() const noexcept
+        {
+            return processSeconds > 0.0 ? static_cast<double>(numSamples) / sampleRate / processSeconds : 0.0;
+        }
+    };
+
+    /** Samples read and written at a time by renderFile(), unless a block is longer. */
+    static constexpr int chunkSamples = 1 << 16;
+
+    explicit OfflineRenderer(const Settings& settingsToUse);
+    ~OfflineRenderer();
+
+    /** Create and prepare the processor, then load the JSFX, routing and preset. */
+    juce::Result prepare(int numChannels, double sampleRate);
+
+    /** Process one block in place (at most getMaxBlockSize() samples), without MIDI. */
+    void processBlock(juce::AudioBuffer<float>& buffer);
+
+    /** Process one block in place with MIDI in and out, as a host would. */
+    void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+
+    /** The next block size from the settings' cycle. */
+    int getNextBlockSize() noexcept;
+
+    int getMaxBlockSize() const noexcept
+    {
+        return maxBlockSize;
+    }
+
+    AudioPluginAudioProcessor& getProcessor() noexcept
+    {
+        return *processor;
+    }
+
+    /** Stream input through the processor into output; the format follows output's extension. */
+    juce::Result renderFile(const juce::File& input, const juce::File& output, Statistics& statistics);
+
+    /** Called by renderFile() after each chunk written, with the fraction of the output done. */
+    std::function<void(double progress)> onProgress;
+
+    /** Reads "mono", "stereo", "off" or channel counts per copy ("2,2,4") into the split settings. */
+    static juce::Result parseSplit(const juce::String& text, Settings& settings);
+
+    /** Encoded preset data for settings.presetFile and settings.presetName. */
+    static juce::Result findPreset(const Settings& settings, juce::String& presetName, juce::String& presetData);
+
+private:
+    Settings settings;
+    int maxBlockSize = 0;
+    int nextBlockSizeIndex = 0;
+
+    juce::AudioFormatManager formatManager;
+    std::unique_ptr<AudioPluginAudioProcessor> processor;
+    juce::AudioBuffer<double> doubleBuffer; // Double precision processing of float file data
+    juce::MidiBuffer midi;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderer)
+};
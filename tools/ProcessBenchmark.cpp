@@ -0,0 +1,216 @@
+#include "ProcessBenchmark.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+RoutingConfig makeRouting(ProcessBenchmark::Routing routing, int numChannels)
+{
+    // Channel counts as prepareToPlay() sets them up, without a sidechain
+    RoutingConfig config;
+    config.numJuceInputs = numChannels;
+    config.numJuceOutputs = numChannels;
+    config.numJsfxInputs = numChannels;
+    config.numJsfxOutputs = numChannels;
+    config.setDiagonal();
+
+    if (routing == ProcessBenchmark::Routing::dense)
+    {
+        for (int source = 0; source < numChannels; ++source)
+        {
+            for (int destination = 0; destination < numChannels; ++destination)
+            {
+                config.inputRouting[source][destination] = true;
+                config.outputRouting[source][destination] = true;
+            }
+        }
+    }
+    else if (routing == ProcessBenchmark::Routing::sparse)
+    {
+        // Scattered crosspoints rather than a pattern a fast path could pick up
+        juce::Random random(numChannels);
+        for (int source = 0; source < numChannels; ++source)
+        {
+            for (int destination = 0; destination < numChannels; ++destination)
+            {
+                config.inputRouting[source][destination] = random.nextInt(8) == 0;
+                config.outputRouting[source][destination] = random.nextInt(8) == 0;
+            }
+        }
+    }
+
+    return config;
+}
+
+void fillMidi(juce::MidiBuffer& midi, int numEvents, int blockSize)
+{
+    for (int event = 0; event < numEvents; ++event)
+    {
+        const int note = 48 + (event / 2) % 24;
+        const int samplePosition = static_cast<int>(static_cast<juce::int64>(event) * blockSize / numEvents);
+        const auto message = event % 2 == 0 ? juce::MidiMessage::noteOn(1, note, static_cast<juce::uint8>(100))
+                                            : juce::MidiMessage::noteOff(1, note);
+        midi.addEvent(message, samplePosition);
+    }
+}
+
+double ticksToNanos(juce::int64 ticks)
+{
+    return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9;
+}
+} // namespace
+
+//==============================================================================
+const char* ProcessBenchmark::getRoutingName(Routing routing) noexcept
+{
+    switch (routing)
+    {
+    case Routing::diagonal:
+        return "diagonal";
+    case Routing::dense:
+        return "dense";
+    case Routing::sparse:
+        return "sparse";
+    }
+
+    return "";
+}
+
+double ProcessBenchmark::Measurement::getWrapperNsPerSample() const noexcept
+{
+    const auto total = stageNsPerSample[static_cast<size_t>(ProcessProfiler::Stage::Total)];
+    const auto jsfx = stageNsPerSample[static_cast<size_t>(ProcessProfiler::Stage::Jsfx)];
+    return juce::jmax(0.0, total - jsfx);
+}
+
+//==============================================================================
+juce::Result ProcessBenchmark::run(const Case& benchmarkCase, const Options& options, Measurement& measurement)
+{
+    const int blockSize = benchmarkCase.blockSize;
+    const int numChannels = benchmarkCase.numChannels;
+
+    OfflineRenderer::Settings settings;
+    settings.jsfxFile = benchmarkCase.jsfxFile;
+    settings.blockSizes = {blockSize};
+    settings.doublePrecision = benchmarkCase.doublePrecision;
+
+    OfflineRenderer renderer(settings);
+    if (auto result = renderer.prepare(numChannels, options.sampleRate); result.failed())
+        return result;
+
+    auto& processor = renderer.getProcessor();
+    processor.updateRoutingConfig(makeRouting(benchmarkCase.routing, numChannels));
+
+    // Host-side inputs, prepared once and copied in before each block
+    juce::AudioBuffer<float> source(numChannels, blockSize);
+    juce::Random random(1);
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int sample = 0; sample < blockSize; ++sample)
+            source.setSample(channel, sample, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+
+    juce::MidiBuffer midiSource;
+    fillMidi(midiSource, benchmarkCase.midiEventsPerBlock, blockSize);
+
+    std::vector<juce::RangedAudioParameter*> parameters;
+    const int numParameters = juce::jmax(1, processor.getNumActiveParameters());
+    for (int index = 0; index < numParameters; ++index)
+        if (auto* parameter = processor.getAPVTS().getParameter("param" + juce::String(index)))
+            parameters.push_back(parameter);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    midi.ensureSize(4096 + static_cast<size_t>(midiSource.data.size()) * 4); // Room for MIDI out too
+    int nextParameter = 0;
+
+    auto processOneBlock = [&]()
+    {
+        buffer.makeCopyOf(source, true);
+        midi.clear();
+        midi.addEvents(midiSource, 0, -1, 0);
+
+        for (int change = 0; change < benchmarkCase.parameterChangesPerBlock && !parameters.empty(); ++change)
+        {
+            auto* parameter = parameters[static_cast<size_t>(nextParameter)];
+            nextParameter = (nextParameter + 1) % static_cast<int>(parameters.size());
+            parameter->setValueNotifyingHost(random.nextFloat());
+        }
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        renderer.processBlock(buffer, midi);
+        return juce::Time::getHighResolutionTicks() - start;
+    };
+
+    const int numWarmupBlocks = juce::roundToInt(options.warmupSeconds * options.sampleRate / blockSize);
+    for (int block = 0; block < juce::jmax(8, numWarmupBlocks); ++block)
+        processOneBlock();
+
+    ProcessProfiler::Counters before;
+    ProcessProfiler::Counters after;
+    processor.getProfiler().copyCounters(before);
+
+    std::vector<juce::int64> blockTicks;
+    blockTicks.reserve(static_cast<size_t>(juce::jmax(options.minBlocks, 1024)));
+
+    const auto loopStart = juce::Time::getHighResolutionTicks();
+    const auto loopTicks = juce::Time::secondsToHighResolutionTicks(options.secondsPerCase);
+
+    while (static_cast<int>(blockTicks.size()) < options.minBlocks
+           || juce::Time::getHighResolutionTicks() - loopStart < loopTicks)
+        blockTicks.push_back(processOneBlock());
+
+    processor.getProfiler().copyCounters(after);
+
+    measurement = {};
+    measurement.numBlocks = static_cast<juce::int64>(blockTicks.size());
+
+    const auto numSamples = static_cast<double>(measurement.numBlocks) * blockSize;
+    juce::int64 totalTicks = 0;
+    for (const auto ticks : blockTicks)
+        totalTicks += ticks;
+
+    measurement.nsPerSample = ticksToNanos(totalTicks) / numSamples;
+
+    std::sort(blockTicks.begin(), blockTicks.end());
+    const auto percentile = [&](double fraction)
+    {
+        const auto index = juce::jmin(blockTicks.size() - 1, static_cast<size_t>(fraction * blockTicks.size()));
+        return ticksToNanos(blockTicks[index]) / blockSize;
+    };
+
+    measurement.medianNsPerSample = percentile(0.5);
+    measurement.p99NsPerSample = percentile(0.99);
+
+    for (size_t stage = 0; stage < measurement.stageNsPerSample.size(); ++stage)
+        measurement.stageNsPerSample[stage] =
+            static_cast<double>(after.totalNanos[stage] - before.totalNanos[stage]) / numSamples;
+
+    return juce::Result::ok();
+}
+
+juce::var ProcessBenchmark::toJson(const Case& benchmarkCase, const Measurement& measurement)
+{
+    auto* stages = new juce::DynamicObject();
+    for (int stage = 0; stage < ProcessProfiler::numStages; ++stage)
+        stages->setProperty(
+            ProcessProfiler::getStageName(static_cast<ProcessProfiler::Stage>(stage)),
+            measurement.stageNsPerSample[static_cast<size_t>(stage)]
+        );
+
+    auto* result = new juce::DynamicObject();
+    result->setProperty("effect", benchmarkCase.effectName);
+    result->setProperty("blockSize", benchmarkCase.blockSize);
+    result->setProperty("channels", benchmarkCase.numChannels);
+    result->setProperty("routing", getRoutingName(benchmarkCase.routing));
+    result->setProperty("parameterChangesPerBlock", benchmarkCase.parameterChangesPerBlock);
+    result->setProperty("midiEventsPerBlock", benchmarkCase.midiEventsPerBlock);
+    result->setProperty("doublePrecision", benchmarkCase.doublePrecision);
+    result->setProperty("blocks", measurement.numBlocks);
+    result->setProperty("nsPerSample", measurement.nsPerSample);
+    result->setProperty("medianNsPerSample", measurement.medianNsPerSample);
+    result->setProperty("p99NsPerSample", measurement.p99NsPerSample);
+    result->setProperty("wrapperNsPerSample", measurement.getWrapperNsPerSample());
+    result->setProperty("stageNsPerSample", juce::var(stages));
+
+    return juce::var(result);
+}
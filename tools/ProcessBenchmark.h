@@ -0,0 +1,71 @@
+#pragma once
+
+#include "OfflineRenderer.h"
+#include "ProcessProfiler.h"
+
+#include <array>
+
+/**
+ * Times AudioPluginAudioProcessor::processBlock on synthetic input, one case
+ * (effect, block size, channel count, routing, parameter and MIDI traffic) at a
+ * time, for juceSonic_Bench.
+ *
+ * Each case gets a fresh processor through OfflineRenderer. Noise is copied in,
+ * parameters are moved and MIDI is queued before every block, outside the timed
+ * call, as a host would. After a short warm-up, blocks run until both minBlocks
+ * and secondsPerCase are reached.
+ *
+ * Times are per sample frame (one sample on every channel). The processor's own
+ * ProcessProfiler splits them into stages, so the wrapper's share can be told
+ * apart from the JSFX's without a second run.
+ */
+class ProcessBenchmark
+{
+public:
+    enum class Routing
+    {
+        diagonal, // Channel n to channel n, the default
+        dense,    // Every channel to every channel, both ways
+        sparse    // About one crosspoint in eight, fixed seed
+    };
+
+    static const char* getRoutingName(Routing routing) noexcept;
+
+    struct Case
+    {
+        juce::String effectName; // For the results
+        juce::File jsfxFile;     // Required: without a JSFX the processor only clears the buffer
+        int blockSize = 512;
+        int numChannels = 2;
+        Routing routing = Routing::diagonal;
+        int parameterChangesPerBlock = 0; // Spread over the JSFX's parameters
+        int midiEventsPerBlock = 0;       // Note ons and offs, evenly spaced
+        bool doublePrecision = false;
+    };
+
+    struct Options
+    {
+        double sampleRate = 48000.0;
+        double secondsPerCase = 0.25; // Wall time spent in the timed loop
+        int minBlocks = 64;
+        double warmupSeconds = 0.05;  // Of audio, before timing starts
+    };
+
+    struct Measurement
+    {
+        juce::int64 numBlocks = 0;
+        double nsPerSample = 0.0; // Mean over all timed blocks
+        double medianNsPerSample = 0.0;
+        double p99NsPerSample = 0.0;
+        std::array<double, ProcessProfiler::numStages> stageNsPerSample{}; // Means, from the processor's profiler
+
+        /** Everything but the JSFX stage, from the profiler. */
+        double getWrapperNsPerSample() const noexcept;
+    };
+
+    /** Prepare a processor for the case and time it. */
+    static juce::Result run(const Case& benchmarkCase, const Options& options, Measurement& measurement);
+
+    /** The case and its measurement as one JSON object. */
+    static juce::var toJson(const Case& benchmarkCase, const Measurement& measurement);
+};
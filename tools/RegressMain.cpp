@@ -0,0 +1,110 @@
+/*
+  juceSonic_Regress: render the bundled JSFX (and any others given) through the
+  processor and compare with stored golden files and timings. Exits non-zero on
+  drift or a throughput drop, so CI can gate on it.
+
+  juceSonic_Regress --golden <dir> [--timings <file.json>] [--update] [options]
+*/
+
+#include "GoldenRegression.h"
+
+#include <iostream>
+
+namespace
+{
+const char* const usage = "Usage: juceSonic_Regress --golden <dir> [options]\n"
+                          "\n"
+                          "  --jsfx <path[,path...]>     Also render these JSFX files, or the JSFX in these folders\n"
+                          "  --only-given                Skip the bundled effects\n"
+                          "  --timings <file.json>       Per-case baseline times for this machine\n"
+                          "  --update                    Record goldens and timings instead of checking them\n"
+                          "  --tolerance <x>             Largest allowed difference per sample (default 1e-5)\n"
+                          "  --max-slowdown <percent>    Slower than the baseline by more fails (default 25)\n"
+                          "  --renders <n>               Renders per case; the fastest is timed (default 3)\n"
+                          "  --report <file.json>        Write the results as JSON\n";
+
+bool isJsfxFile(const juce::File& file)
+{
+    // Effects are extensionless or .jsfx; presets, imports and images sit alongside them
+    return !file.getFileName().startsWithChar('.')
+        && (file.getFileExtension().isEmpty() || file.hasFileExtension("jsfx"));
+}
+
+void addEffects(const juce::File& location, juce::Array<juce::File>& effects)
+{
+    if (location.isDirectory())
+    {
+        for (const auto& entry : juce::RangedDirectoryIterator(location, true, "*", juce::File::findFiles))
+            if (isJsfxFile(entry.getFile()))
+                effects.addIfNotAlreadyThere(entry.getFile());
+    }
+    else if (location.existsAsFile())
+    {
+        effects.addIfNotAlreadyThere(location);
+    }
+    else
+    {
+        juce::ConsoleApplication::fail("JSFX not found: " + location.getFullPathName());
+    }
+}
+
+void regress(const juce::ArgumentList& args)
+{
+    GoldenRegression::Options options;
+    options.goldenDirectory = args.getFileForOption("--golden");
+    options.update = args.containsOption("--update");
+
+    if (args.containsOption("--timings"))
+        options.timingsFile = args.getFileForOption("--timings");
+    if (args.containsOption("--tolerance"))
+        options.tolerance = juce::jmax(0.0f, args.getValueForOption("--tolerance").getFloatValue());
+    if (args.containsOption("--max-slowdown"))
+        options.maxSlowdown = juce::jmax(0.0, args.getValueForOption("--max-slowdown").getDoubleValue() / 100.0);
+    if (args.containsOption("--renders"))
+        options.numRenders = juce::jmax(1, args.getValueForOption("--renders").getIntValue());
+
+    juce::Array<juce::File> effects;
+    if (!args.containsOption("--only-given"))
+        addEffects(juce::File(JUCESONIC_BUNDLED_EFFECTS_DIR), effects);
+
+    if (args.containsOption("--jsfx"))
+        for (const auto& path : juce::StringArray::fromTokens(args.getValueForOption("--jsfx"), ",", ""))
+            addEffects(juce::File::getCurrentWorkingDirectory().getChildFile(path.trim()), effects);
+
+    if (effects.isEmpty())
+        juce::ConsoleApplication::fail("No JSFX to render");
+
+    const auto cases = GoldenRegression::makeCases(effects);
+    const auto outcomes = GoldenRegression::run(cases, options, std::cout);
+
+    if (args.containsOption("--report"))
+    {
+        const auto report = args.getFileForOption("--report");
+        if (!report.replaceWithText(juce::JSON::toString(GoldenRegression::toJson(cases, outcomes))))
+            juce::ConsoleApplication::fail("Could not write " + report.getFullPathName());
+    }
+
+    int numFailed = 0;
+    for (const auto& outcome : outcomes)
+        if (outcome.result.failed())
+            ++numFailed;
+
+    std::cout << (cases.size() - static_cast<size_t>(numFailed)) << " of " << cases.size() << " cases passed"
+              << std::endl;
+
+    if (numFailed > 0)
+        juce::ConsoleApplication::fail(juce::String(numFailed) + " cases failed");
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // Initialises JUCE; this thread is both message and audio thread
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", usage, false);
+    app.addDefaultCommand({"", "", "Check renders against golden files and timings", usage, regress});
+
+    return app.findAndRunCommand(argc, argv);
+}
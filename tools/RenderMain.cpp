@@ -0,0 +1,151 @@
+/*
+  juceSonic_Render: run a JSFX over an audio file through the plugin's processor,
+  without a host, as fast as the machine allows.
+
+  juceSonic_Render --jsfx effect.jsfx --input in.wav --output out.flac [options]
+  juceSonic_Render --batch manifest.json [--threads n]
+*/
+
+#include "BatchRenderer.h"
+#include "OfflineRenderer.h"
+
+#include <iostream>
+
+namespace
+{
+const char* const usage = "Usage: juceSonic_Render --jsfx <file> --input <file> --output <file> [options]\n"
+                          "\n"
+                          "  --preset <file.rpl>         REAPER preset library to load a preset from\n"
+                          "  --preset-name <name>        Preset in the library (default: the first one)\n"
+                          "  --routing <in,sc,out>       I/O matrix bit rows, as saved in the plugin state\n"
+                          "  --block-size <n[,n...]>     Block size, or a list cycled through (default 512)\n"
+                          "  --accumulate <n>            Run the JSFX in fixed blocks of n samples\n"
+                          "  --oversample <n>            Run the JSFX at 2, 4 or 8 times the file's rate\n"
+                          "  --linear-phase              Linear phase oversampling filters\n"
+                          "  --split <mono|stereo|n,n..> Linked copies of the JSFX, each on its own channels\n"
+                          "  --branches <file[,file...]> JSFX run in parallel after the main one, summed\n"
+                          "  --dry                       Mix the dry signal into the branches' sum\n"
+                          "  --chain <file[,file...]>    Further JSFX run after the main one, in order\n"
+                          "  --pipeline-chain            Run the chain stages in parallel, a block apart\n"
+                          "  --double                    Process in double precision\n"
+                          "  --tail <seconds>            Keep rendering for this long after the input ends\n"
+                          "  --bits <n>                  Output bit depth (default: the input's)\n"
+                          "  --no-latency-compensation   Keep the JSFX's reported latency at the start\n"
+                          "\n"
+                          "       juceSonic_Render --batch <manifest.json> [--threads <n>]\n"
+                          "\n"
+                          "  Renders every job in a JSON manifest, in parallel. Each job takes the\n"
+                          "  fields input, output, jsfx, preset, presetName, routing, blockSize,\n"
+                          "  accumulate, oversample, linearPhase, split, branches, dry, chain,\n"
+                          "  pipelineChain, double, tail, bits and latencyCompensation; \"defaults\"\n"
+                          "  sets them for all.\n"
+                          "  --threads <n>               Worker threads (default: one per physical core)\n";
+
+juce::Array<int> parseBlockSizes(const juce::String& text)
+{
+    juce::Array<int> blockSizes;
+    for (const auto& token : juce::StringArray::fromTokens(text, ",", ""))
+        blockSizes.add(token.trim().getIntValue());
+
+    for (const int blockSize : blockSizes)
+        if (blockSize < 1)
+            juce::ConsoleApplication::fail("Invalid block size list: " + text);
+
+    return blockSizes;
+}
+
+void render(const juce::ArgumentList& args)
+{
+    OfflineRenderer::Settings settings;
+    settings.jsfxFile = args.getExistingFileForOption("--jsfx");
+    settings.routing = args.getValueForOption("--routing");
+    settings.doublePrecision = args.containsOption("--double");
+    settings.compensateLatency = !args.containsOption("--no-latency-compensation");
+    settings.tailSeconds = juce::jmax(0.0, args.getValueForOption("--tail").getDoubleValue());
+    settings.bitsPerSample = args.getValueForOption("--bits").getIntValue();
+    settings.accumulatorBlockSize = args.getValueForOption("--accumulate").getIntValue();
+    settings.oversamplingLinearPhase = args.containsOption("--linear-phase");
+
+    if (args.containsOption("--oversample"))
+        settings.oversamplingFactor = args.getValueForOption("--oversample").getIntValue();
+
+    if (args.containsOption("--preset"))
+    {
+        settings.presetFile = args.getExistingFileForOption("--preset");
+        settings.presetName = args.getValueForOption("--preset-name");
+    }
+
+    if (auto result = OfflineRenderer::parseSplit(args.getValueForOption("--split"), settings); result.failed())
+        juce::ConsoleApplication::fail(result.getErrorMessage());
+
+    const auto workingDirectory = juce::File::getCurrentWorkingDirectory();
+    for (const auto& path : juce::StringArray::fromTokens(args.getValueForOption("--branches"), ",", ""))
+        settings.branchFiles.add(workingDirectory.getChildFile(path.trim()));
+
+    settings.branchesIncludeDry = args.containsOption("--dry");
+
+    for (const auto& path : juce::StringArray::fromTokens(args.getValueForOption("--chain"), ",", ""))
+        settings.chainFiles.add(workingDirectory.getChildFile(path.trim()));
+
+    settings.pipelineChain = args.containsOption("--pipeline-chain");
+
+    if (args.containsOption("--block-size"))
+        settings.blockSizes = parseBlockSizes(args.getValueForOption("--block-size"));
+
+    const auto input = args.getExistingFileForOption("--input");
+    const auto output = args.getFileForOption("--output");
+
+    OfflineRenderer renderer(settings);
+    OfflineRenderer::Statistics statistics;
+
+    if (auto result = renderer.renderFile(input, output, statistics); result.failed())
+        juce::ConsoleApplication::fail(result.getErrorMessage());
+
+    std::cout << "Wrote "
+              << output.getFullPathName()
+              << ": "
+              << statistics.numSamples
+              << " samples at "
+              << statistics.sampleRate
+              << " Hz, latency "
+              << statistics.latencySamples
+              << " samples, "
+              << juce::String(statistics.getRealtimeFactor(), 1)
+              << "x real time"
+              << std::endl;
+}
+
+void renderBatch(const juce::ArgumentList& args)
+{
+    std::vector<BatchRenderer::Job> jobs;
+    if (auto result = BatchRenderer::loadManifest(args.getExistingFileForOption("--batch"), jobs); result.failed())
+        juce::ConsoleApplication::fail(result.getErrorMessage());
+
+    int numThreads = BatchRenderer::getDefaultNumThreads();
+    if (args.containsOption("--threads"))
+    {
+        numThreads = args.getValueForOption("--threads").getIntValue();
+        if (numThreads < 1)
+            juce::ConsoleApplication::fail("Invalid thread count: " + args.getValueForOption("--threads"));
+    }
+
+    for (const auto& report : BatchRenderer::run(jobs, numThreads, std::cout))
+        if (report.result.failed())
+            juce::ConsoleApplication::fail("Some jobs failed");
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // Initialises JUCE; batch workers build their processors without a running message loop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", usage, false);
+    app.addCommand(
+        {"--batch", "--batch <manifest.json>", "Render the jobs in a manifest in parallel", usage, renderBatch}
+    );
+    app.addDefaultCommand({"", "", "Render a file through a JSFX", usage, render});
+
+    return app.findAndRunCommand(argc, argv);
+}